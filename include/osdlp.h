@@ -25,5 +25,19 @@
 #include "osdlp_crc.h"
 #include "osdlp_tm.h"
 #include "osdlp_spp.h"
+#include "osdlp_registry.h"
+#include "osdlp_cltu.h"
+#include "osdlp_randomizer.h"
+#include "osdlp_sent_ring.h"
+#include "osdlp_frame_pool.h"
+#include "osdlp_timer_wheel.h"
+#include "osdlp_trace.h"
+#include "osdlp_ops.h"
+#include "osdlp_spsc_ring.h"
+#include "osdlp_mpmc_queue.h"
+#include "osdlp_arena.h"
+#include "osdlp_rx_pipeline.h"
+#include "osdlp_ws_deque.h"
+#include "osdlp_reorder.h"
 
 #endif /* INCLUDE_OSDLP_H_ */
@@ -0,0 +1,235 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_ARENA_H_
+#define INCLUDE_OSDLP_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "osdlp_types.h"
+
+#define SLAB_CACHE_SIZE         16
+
+/**
+ * Region of memory from which all the buffers of the link stack are carved.
+ * The region is provided once by the application, e.g. as a static array or
+ * a hugepage backed mapping, so that the buffers share few TLB entries and
+ * nothing is allocated from the heap afterwards. Allocations are never
+ * returned to the arena individually; fixed size buffers that come and go
+ * are served by slabs carved from it.
+ */
+struct osdlp_arena {
+	uint8_t     *base;
+	size_t      size;
+	size_t      used;
+};
+
+/**
+ * Free list of fixed size objects carved from an arena.
+ * Free objects are linked through their first word. The free list is
+ * protected by a spinlock, which threads avoid on most calls by going
+ * through their own osdlp_slab_cache.
+ */
+struct osdlp_slab {
+	uint8_t     *base;
+	void        *free;          /* First free object*/
+	uint32_t    obj_size;
+	uint32_t    nobjs;
+	uint32_t    available;      /* Number of free objects*/
+	uint8_t     lock;
+};
+
+/**
+ * Per-thread cache of free objects of a slab. Objects are moved from and to
+ * the slab in batches of half the cache, so that the slab lock is only taken
+ * once every SLAB_CACHE_SIZE / 2 calls.
+ */
+struct osdlp_slab_cache {
+	struct osdlp_slab   *slab;
+	void                *objs[SLAB_CACHE_SIZE];
+	uint16_t            count;
+};
+
+typedef enum {
+	OSDLP_CLASS_TC_FRAME = 0,
+	OSDLP_CLASS_TM_FRAME,
+	OSDLP_CLASS_SDU,
+	OSDLP_CLASS_NUM
+} osdlp_frame_class_t;
+
+/**
+ * Slabs of the buffer sizes used by a link stack: the maximum TC frame, the
+ * TM frame and the maximum SDU
+ */
+struct osdlp_frame_slabs {
+	struct osdlp_slab   cls[OSDLP_CLASS_NUM];
+};
+
+/**
+ * Initializes an arena
+ * @param arena the arena
+ * @param region the memory of the arena
+ * @param size the size of the region
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_arena_init(struct osdlp_arena *arena, void *region, size_t size);
+
+/**
+ * Carves a block out of an arena
+ * @param arena the arena
+ * @param size the size of the block
+ * @param align the alignment of the block. Must be a power of 2
+ *
+ * @return the block, NULL if the arena is exhausted
+ */
+void *
+osdlp_arena_alloc(struct osdlp_arena *arena, size_t size, size_t align);
+
+/**
+ * Returns all the blocks to the arena at once. Any slab carved from it
+ * must not be used afterwards
+ */
+void
+osdlp_arena_reset(struct osdlp_arena *arena);
+
+/**
+ * Returns the number of octets in use, including alignment padding
+ */
+size_t
+osdlp_arena_used(const struct osdlp_arena *arena);
+
+/**
+ * Carves a slab out of an arena
+ * @param slab the slab
+ * @param arena the arena
+ * @param obj_size the size of each object
+ * @param nobjs the number of objects
+ *
+ * @return 0 on success, negative value if the arena is exhausted
+ */
+int
+osdlp_slab_init(struct osdlp_slab *slab, struct osdlp_arena *arena,
+                uint32_t obj_size, uint32_t nobjs);
+
+/**
+ * Initializes a slab on memory provided by the caller instead of an arena.
+ * The objects are not realigned, so obj_size should be a multiple of the
+ * alignment the objects need.
+ * @param slab the slab
+ * @param region the memory of the objects. Must hold nobjs * obj_size octets
+ * @param obj_size the size of each object. Must be at least sizeof(void *)
+ * @param nobjs the number of objects
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_slab_init_region(struct osdlp_slab *slab, void *region,
+                       uint32_t obj_size, uint32_t nobjs);
+
+/**
+ * Allocates an object
+ * @param slab the slab
+ *
+ * @return the object, NULL if the slab is exhausted
+ */
+void *
+osdlp_slab_alloc(struct osdlp_slab *slab);
+
+/**
+ * Returns an object to its slab
+ */
+void
+osdlp_slab_free(struct osdlp_slab *slab, void *obj);
+
+/**
+ * Returns true if the object belongs to the slab
+ */
+bool
+osdlp_slab_owns(const struct osdlp_slab *slab, const void *obj);
+
+/**
+ * Initializes the cache of a thread
+ */
+void
+osdlp_slab_cache_init(struct osdlp_slab_cache *cache,
+                      struct osdlp_slab *slab);
+
+/**
+ * Allocates an object through the cache of a thread
+ *
+ * @return the object, NULL if the slab is exhausted
+ */
+void *
+osdlp_slab_cache_alloc(struct osdlp_slab_cache *cache);
+
+/**
+ * Frees an object through the cache of a thread
+ */
+void
+osdlp_slab_cache_free(struct osdlp_slab_cache *cache, void *obj);
+
+/**
+ * Returns all the cached objects to the slab, e.g. before the thread exits
+ */
+void
+osdlp_slab_cache_drain(struct osdlp_slab_cache *cache);
+
+/**
+ * Carves the slabs of the frame classes out of an arena
+ * @param slabs the slabs
+ * @param arena the arena
+ * @param tc_frame_len the maximum TC frame length
+ * @param tm_frame_len the TM frame length
+ * @param sdu_len the maximum SDU length
+ * @param nframes the number of buffers of each class
+ *
+ * @return 0 on success, negative value if the arena is exhausted
+ */
+int
+osdlp_frame_slabs_init(struct osdlp_frame_slabs *slabs,
+                       struct osdlp_arena *arena, uint16_t tc_frame_len,
+                       uint16_t tm_frame_len, uint32_t sdu_len,
+                       uint32_t nframes);
+
+/**
+ * Allocates a buffer of a frame class
+ *
+ * @return the buffer, NULL if the class is exhausted
+ */
+static inline void *
+osdlp_frame_slabs_alloc(struct osdlp_frame_slabs *slabs,
+                        osdlp_frame_class_t cls)
+{
+	return osdlp_slab_alloc(&slabs->cls[cls]);
+}
+
+/**
+ * Returns a buffer to its frame class
+ */
+static inline void
+osdlp_frame_slabs_free(struct osdlp_frame_slabs *slabs,
+                       osdlp_frame_class_t cls, void *buf)
+{
+	osdlp_slab_free(&slabs->cls[cls], buf);
+}
+
+#endif /* INCLUDE_OSDLP_ARENA_H_ */
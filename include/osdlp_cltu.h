@@ -0,0 +1,93 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_CLTU_H_
+#define INCLUDE_OSDLP_CLTU_H_
+
+#include <stdint.h>
+
+#define CLTU_START_SEQ_LEN          2
+#define CLTU_TAIL_SEQ_LEN           8
+#define CLTU_INFO_LEN               7
+#define CLTU_BLOCK_LEN              8
+#define CLTU_FILL_BYTE              0x55
+
+typedef enum {
+	CLTU_OK                 = 0,
+	CLTU_LEN_ERR            = 1,
+	CLTU_NO_START_SEQ       = 2,
+	CLTU_UNCORRECTABLE      = 3
+} cltu_result_t;
+
+/**
+ * Returns the length of the CLTU that carries a frame
+ * @param length the length of the frame
+ */
+uint32_t
+osdlp_cltu_len(uint32_t length);
+
+/**
+ * Encodes a TC transfer frame into a CLTU. The frame is split into
+ * BCH(63,56) code blocks, the last one padded with fill octets, and
+ * delimited by the start and the tail sequence.
+ * @param cltu_out the buffer that will hold the CLTU
+ * @param max_len the size of cltu_out
+ * @param frame the frame to encode
+ * @param length the length of the frame
+ *
+ * @return the length of the CLTU, or the negative value of cltu_result_t
+ */
+int
+osdlp_cltu_encode(uint8_t *cltu_out, uint32_t max_len, const uint8_t *frame,
+                  uint32_t length);
+
+/**
+ * Decodes a CLTU. The input is searched for the start sequence and code
+ * blocks are decoded until an uncorrectable block, normally the tail
+ * sequence, or the end of the input is reached. Single bit errors in a code
+ * block are corrected.
+ * @param frame_out the buffer that will hold the decoded octets. Trailing
+ * fill octets are not removed
+ * @param max_len the size of frame_out
+ * @param cltu the received octets
+ * @param length the number of received octets
+ * @param corrected pointer to the number of corrected code blocks. Can be NULL
+ *
+ * @return the number of decoded octets, or the negative value of
+ * cltu_result_t
+ */
+int
+osdlp_cltu_decode(uint8_t *frame_out, uint32_t max_len, const uint8_t *cltu,
+                  uint32_t length, uint32_t *corrected);
+
+/**
+ * Decodes a CLTU and performs TC receive with COP on the frame it carries
+ * @param cltu the received octets
+ * @param length the number of received octets
+ * @param util a buffer to hold the decoded frame
+ * @param util_len the size of util
+ *
+ * @return the negative value of tc_rx_result_t for error, 0 for success.
+ * CLTUs that cannot be decoded are reported as TC_RX_FRAME_VAL_ERR
+ */
+int
+osdlp_cltu_receive(const uint8_t *cltu, uint32_t length, uint8_t *util,
+                   uint32_t util_len);
+
+#endif /* INCLUDE_OSDLP_CLTU_H_ */
@@ -65,6 +65,18 @@ struct queue_item {
 	tc_bypass_t type;       /* Type_A or Type_B*/
 };
 
+/**
+ * Item of the wait queue. It describes a Type-AD frame data field waiting
+ * to be transmitted. The data are not copied, so they must remain valid
+ * until the frame is transmitted or the wait queue is purged.
+ */
+struct tc_wait_desc {
+	uint8_t     *data;      /* Frame data*/
+	uint16_t    data_len;   /* Length of the frame data*/
+	uint8_t     map_id;     /* MAP ID of the segment header*/
+	uint8_t     seq_flag;   /* Sequence flag of the segment header*/
+};
+
 struct farm_vars {
 	uint8_t     state;
 	uint8_t     lockout;
@@ -149,6 +161,19 @@ osdlp_purge_wait_queue(struct tc_transfer_frame *tc_tf);
 notification_t
 osdlp_look_for_fdu(struct tc_transfer_frame *tc_tf);
 
+/**
+ * Retransmits all the Type-AD frames marked for retransmission in a single
+ * pass, oldest first, instead of one per osdlp_look_for_fdu() call. The
+ * FOP-1 runs it right after osdlp_initiate_ad_retransmission(). While it
+ * runs, osdlp_ad_accept() is ignored, so no new frame is sent between the
+ * retransmitted ones.
+ * @param tc_tf the TC config struct
+ *
+ * @return the number of retransmitted frames, negative value on error
+ */
+int
+osdlp_retransmit_ad_frames(struct tc_transfer_frame *tc_tf);
+
 int
 osdlp_transmit_type_ad(struct tc_transfer_frame *tc_tf);
 
@@ -173,6 +198,30 @@ osdlp_look_for_directive(struct tc_transfer_frame *tc_tf);
 notification_t
 osdlp_handle_clcw(struct tc_transfer_frame *tc_tf, uint8_t *ocf_buffer);
 
+/**
+ * Checks if a CLCW is identical to the last one passed to
+ * osdlp_handle_clcw_once() and the FOP-1 state, V(S), NN(R) and
+ * transmission count have not changed since
+ * @param tc_tf the TC config struct
+ * @param ocf_buffer the CLCW
+ */
+bool
+osdlp_clcw_duplicate(const struct tc_transfer_frame *tc_tf,
+                     const uint8_t *ocf_buffer);
+
+/**
+ * Same as osdlp_handle_clcw(), but a CLCW for which osdlp_clcw_duplicate()
+ * holds is ignored.
+ * @param tc_tf the TC config struct
+ * @param ocf_buffer the CLCW
+ * @param handled set to whether the CLCW was passed to the FOP-1. May be NULL
+ *
+ * @return the notification of the FOP-1, IGNORE for a duplicate CLCW
+ */
+notification_t
+osdlp_handle_clcw_once(struct tc_transfer_frame *tc_tf, uint8_t *ocf_buffer,
+                       bool *handled);
+
 notification_t
 osdlp_handle_timer_expired(struct tc_transfer_frame *tc_tf);
 
@@ -243,7 +292,7 @@ osdlp_bd_reject(struct tc_transfer_frame *tc_tf);
 
 /**
  * Enqueues an item on the wait queue
- * @param the buffer to enqueue
+ * @param the struct tc_wait_desc to enqueue
  * @param the vcid
  * @return 0 or positive value for success, negative value otherwise
  */
@@ -253,7 +302,7 @@ osdlp_tc_wait_queue_enqueue(void *, uint16_t);
 
 /**
  * Dequeues an item from the wait queue
- * @param the buffer to hold the item
+ * @param the struct tc_wait_desc to hold the item
  * @param the vcid
  * @return 0 or positive value for success, negative value otherwise
  */
@@ -344,7 +393,7 @@ osdlp_tc_rx_queue_full(uint16_t);
  */
 __attribute__((weak))
 bool
-osdlp_tc_tx_queue_full();
+osdlp_tc_tx_queue_full(uint16_t);
 
 /**
  * Enqueues an item on the tx queue.
@@ -0,0 +1,107 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_FRAME_POOL_H_
+#define INCLUDE_OSDLP_FRAME_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_arena.h"
+#include "osdlp_tc.h"
+
+/**
+ * Fixed size pool of reference counted frame buffers.
+ * When a pool is attached to a virtual channel, every frame packed by the
+ * COP-1 gets its own buffer. The same buffer is shared by the TX queue and
+ * the sent queue and is returned to the pool when both have released it.
+ * The free frames are kept by a slab of TC frames, so the storage may be
+ * carved from an arena.
+ */
+struct tc_frame_pool {
+	struct osdlp_slab   slab;       /* Free frames*/
+	uint8_t             *refcnt;    /* nframes reference counters*/
+	uint16_t            frame_len;  /* Size of each frame buffer*/
+	uint16_t            nframes;
+};
+
+/**
+ * Initializes a frame pool
+ * @param pool the pool
+ * @param storage memory for the frames. Must hold nframes * frame_len octets
+ * @param refcnt memory for the reference counters. Must hold nframes octets
+ * @param nframes the number of frames
+ * @param frame_len the size of each frame. Must be at least sizeof(void *)
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_frame_pool_init(struct tc_frame_pool *pool, uint8_t *storage,
+                      uint8_t *refcnt, uint16_t nframes, uint16_t frame_len);
+
+/**
+ * Allocates a frame with a reference count of 1
+ * @param pool the pool
+ *
+ * @return the frame, NULL if the pool is exhausted
+ */
+uint8_t *
+osdlp_frame_pool_alloc(struct tc_frame_pool *pool);
+
+/**
+ * Returns true if the frame belongs to the pool
+ */
+bool
+osdlp_frame_pool_owns(struct tc_frame_pool *pool, const uint8_t *frame);
+
+/**
+ * Takes a reference to a frame of the pool
+ */
+void
+osdlp_frame_pool_ref(struct tc_frame_pool *pool, uint8_t *frame);
+
+/**
+ * Drops a reference to a frame of the pool. The frame is returned to the
+ * pool when its last reference is dropped
+ */
+void
+osdlp_frame_pool_unref(struct tc_frame_pool *pool, uint8_t *frame);
+
+/**
+ * Attaches a frame pool to a virtual channel. Passing NULL makes the COP-1
+ * pack frames in the util buffer again.
+ * While a pool is attached, every frame passed to osdlp_tc_tx_queue_enqueue()
+ * must be released with osdlp_tc_tx_done() once it has been transmitted or
+ * dropped by the lower layers.
+ * @param tc_tf the TC config struct
+ * @param pool the pool
+ */
+void
+osdlp_frame_pool_attach(struct tc_transfer_frame *tc_tf,
+                        struct tc_frame_pool *pool);
+
+/**
+ * Notifies the library that the lower layers are done with a frame that was
+ * passed to osdlp_tc_tx_queue_enqueue()
+ * @param tc_tf the TC config struct
+ * @param fdu the frame
+ */
+void
+osdlp_tc_tx_done(struct tc_transfer_frame *tc_tf, uint8_t *fdu);
+
+#endif /* INCLUDE_OSDLP_FRAME_POOL_H_ */
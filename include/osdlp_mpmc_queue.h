@@ -0,0 +1,130 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_MPMC_QUEUE_H_
+#define INCLUDE_OSDLP_MPMC_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_types.h"
+
+#define MPMC_QUEUE_MAX_VCS      OSDLP_MAX_VCS
+
+/* Header of a cell: sequence, frame length and VCID*/
+#define MPMC_QUEUE_CELL_HDR     12
+
+/* Octets occupied by a cell of slot_len octets, including its header*/
+#define MPMC_QUEUE_STRIDE(slot_len)                                     \
+	((((uint32_t)(slot_len) + 3) & ~(uint32_t)3) + MPMC_QUEUE_CELL_HDR)
+
+struct tc_transfer_frame;
+
+/**
+ * Bounded lock-free multiple producer multiple consumer queue of frames.
+ * Each cell carries a sequence number telling whether it is free for the
+ * producer of a given position or full for the consumer of that position,
+ * so producers and consumers only contend on their own position counter.
+ * The number of frames of each virtual channel is accounted separately,
+ * so that a virtual channel can be limited to a share of the queue.
+ */
+struct osdlp_mpmc_queue {
+	uint32_t    enqueue_pos __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    dequeue_pos __attribute__((aligned(OSDLP_CACHE_LINE)));
+	/* Constant after initialization*/
+	uint8_t     *storage __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    mask;           /* ncells - 1*/
+	uint32_t    stride;         /* MPMC_QUEUE_STRIDE(slot_len)*/
+	uint32_t    slot_len;       /* Maximum frame length*/
+	uint32_t    vc_limit;       /* Maximum frames per VC, 0 for none*/
+	uint32_t    vc_count[MPMC_QUEUE_MAX_VCS]
+	__attribute__((aligned(OSDLP_CACHE_LINE)));
+};
+
+/**
+ * Initializes a queue
+ * @param q the queue
+ * @param storage the frame storage. Must hold
+ * ncells * MPMC_QUEUE_STRIDE(slot_len) octets and be 4-byte aligned
+ * @param ncells the number of cells. Must be a power of 2, at least 2
+ * @param slot_len the maximum frame length
+ * @param vc_limit the maximum number of queued frames of a single virtual
+ * channel. 0 lets a virtual channel use the whole queue
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_mpmc_queue_init(struct osdlp_mpmc_queue *q, uint8_t *storage,
+                      uint32_t ncells, uint32_t slot_len, uint32_t vc_limit);
+
+/**
+ * Copies a frame into the queue. Safe to call from any thread
+ * @param q the queue
+ * @param frame the frame
+ * @param length the length of the frame
+ * @param vcid the virtual channel of the frame
+ *
+ * @return 0 on success, negative value if the queue or the share of the
+ * virtual channel is full, or the frame does not fit in a cell
+ */
+int
+osdlp_mpmc_queue_enqueue(struct osdlp_mpmc_queue *q, const uint8_t *frame,
+                         uint32_t length, uint16_t vcid);
+
+/**
+ * Copies the oldest frame out of the queue. Safe to call from any thread
+ * @param q the queue
+ * @param frame buffer of at least slot_len octets
+ * @param length pointer to store the length of the frame
+ * @param vcid pointer to store the virtual channel of the frame. May be NULL
+ *
+ * @return 0 on success, negative value if the queue is empty
+ */
+int
+osdlp_mpmc_queue_dequeue(struct osdlp_mpmc_queue *q, uint8_t *frame,
+                         uint32_t *length, uint16_t *vcid);
+
+/**
+ * Returns true if a frame of the virtual channel would not be accepted.
+ * Advisory when other threads use the queue concurrently
+ * @param q the queue
+ * @param vcid the virtual channel
+ */
+bool
+osdlp_mpmc_queue_full(struct osdlp_mpmc_queue *q, uint16_t vcid);
+
+/**
+ * Returns the number of queued frames of a virtual channel
+ */
+uint32_t
+osdlp_mpmc_queue_count(struct osdlp_mpmc_queue *q, uint16_t vcid);
+
+/**
+ * Makes a virtual channel pass its frames to a shared queue instead of the
+ * osdlp_tc_tx_queue_* hooks. Several virtual channels, each driven by its
+ * own thread, may share the same queue. Passing NULL restores the hooks.
+ * @param tc_tf the TC config struct
+ * @param q the queue. Its cells must hold a whole frame
+ *
+ * @return 0 on success, negative value if the cells are too short
+ */
+int
+osdlp_mpmc_queue_attach(struct tc_transfer_frame *tc_tf,
+                        struct osdlp_mpmc_queue *q);
+
+#endif /* INCLUDE_OSDLP_MPMC_QUEUE_H_ */
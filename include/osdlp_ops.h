@@ -0,0 +1,109 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_OPS_H_
+#define INCLUDE_OSDLP_OPS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "osdlp_types.h"
+
+/**
+ * Queue and timer operations of a TC or TM context.
+ * Every operation takes the user pointer of the context as its first
+ * argument, followed by the arguments of the corresponding osdlp_* hook.
+ * A context uses the default table, which calls the global hooks, unless
+ * another table is set. This way a process can run several independent
+ * link stacks, each with its own queues and timers.
+ * osdlp_tc_get_rx_config() and osdlp_tm_get_rx_config() remain global,
+ * as they are called before the context is known. Use a registry to
+ * receive with several contexts.
+ */
+
+struct queue_item;
+struct tc_transfer_frame;
+struct tm_transfer_frame;
+
+struct osdlp_tc_ops {
+	int (*wait_queue_enqueue)(void *user, void *item, uint16_t vcid);
+	int (*wait_queue_dequeue)(void *user, void *item, uint16_t vcid);
+	bool (*wait_queue_empty)(void *user, uint16_t vcid);
+	int (*wait_queue_clear)(void *user, uint16_t vcid);
+	int (*sent_queue_enqueue)(void *user, struct queue_item *item,
+	                          uint16_t vcid);
+	int (*sent_queue_dequeue)(void *user, struct queue_item *item,
+	                          uint16_t vcid);
+	bool (*sent_queue_empty)(void *user, uint16_t vcid);
+	int (*sent_queue_clear)(void *user, uint16_t vcid);
+	int (*sent_queue_head)(void *user, struct queue_item *item,
+	                       uint16_t vcid);
+	int (*mark_ad_as_rt)(void *user, uint16_t vcid);
+	int (*mark_bc_as_rt)(void *user, uint16_t vcid);
+	int (*reset_rt_frame)(void *user, struct queue_item *item,
+	                      uint16_t vcid);
+	int (*get_first_ad_rt_frame)(void *user, struct queue_item *item,
+	                             uint16_t vcid);
+	bool (*tx_queue_full)(void *user, uint16_t vcid);
+	int (*tx_queue_enqueue)(void *user, uint8_t *buffer, uint16_t vcid);
+	int (*cancel_lower_ops)(void *user, uint16_t vcid);
+	int (*timer_start)(void *user, uint16_t vcid);
+	int (*timer_cancel)(void *user, uint16_t vcid);
+	bool (*rx_queue_full)(void *user, uint16_t vcid);
+	int (*rx_queue_enqueue)(void *user, uint8_t *buffer, uint32_t length,
+	                        uint16_t vcid);
+	int (*rx_queue_enqueue_now)(void *user, uint8_t *buffer,
+	                            uint32_t length, uint16_t vcid);
+};
+
+struct osdlp_tm_ops {
+	bool (*tx_queue_empty)(void *user, uint8_t vcid);
+	int (*tx_queue_back)(void *user, uint8_t **pkt, uint8_t vcid);
+	void (*tx_commit_back)(void *user, uint8_t vcid);
+	int (*tx_queue_enqueue)(void *user, uint8_t *pkt, uint8_t vcid);
+	int (*rx_queue_enqueue)(void *user, uint8_t *pkt, uint8_t vcid);
+	int (*get_packet_len)(void *user, osdlp_sdu_len_t *length,
+	                      uint8_t *pkt, osdlp_sdu_len_t mem_len);
+};
+
+/* Operations that call the global osdlp_* hooks */
+extern const struct osdlp_tc_ops osdlp_tc_default_ops;
+extern const struct osdlp_tm_ops osdlp_tm_default_ops;
+
+/**
+ * Sets the operations of a TC context
+ * @param tc_tf the TC context
+ * @param ops the operations. NULL restores the default operations
+ * @param user the pointer passed to every operation
+ */
+void
+osdlp_tc_set_ops(struct tc_transfer_frame *tc_tf,
+                 const struct osdlp_tc_ops *ops, void *user);
+
+/**
+ * Sets the operations of a TM context
+ * @param tm_tf the TM context
+ * @param ops the operations. NULL restores the default operations
+ * @param user the pointer passed to every operation
+ */
+void
+osdlp_tm_set_ops(struct tm_transfer_frame *tm_tf,
+                 const struct osdlp_tm_ops *ops, void *user);
+
+#endif /* INCLUDE_OSDLP_OPS_H_ */
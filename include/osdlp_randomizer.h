@@ -0,0 +1,51 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_RANDOMIZER_H_
+#define INCLUDE_OSDLP_RANDOMIZER_H_
+
+#include <stdint.h>
+
+/* Period of the CCSDS pseudo-randomization sequences in octets */
+#define RANDOMIZER_PERIOD           255
+
+/**
+ * Applies the CCSDS TM pseudo-randomizer, h(x) = x^8 + x^7 + x^5 + x^3 + 1,
+ * to a buffer. The operation is its own inverse, so the same call
+ * de-randomizes a received frame before osdlp_tm_receive().
+ * The randomizer must be applied after the frame, including its FECF,
+ * has been packed.
+ * @param buf the buffer
+ * @param length the length of the buffer
+ */
+void
+osdlp_tm_randomize(uint8_t *buf, uint32_t length);
+
+/**
+ * Applies the CCSDS TC pseudo-randomizer,
+ * h(x) = x^8 + x^6 + x^4 + x^3 + x^2 + x + 1, to a buffer.
+ * The operation is its own inverse. On the sending side it is applied to the
+ * packed frame before it is encoded into a CLTU.
+ * @param buf the buffer
+ * @param length the length of the buffer
+ */
+void
+osdlp_tc_randomize(uint8_t *buf, uint32_t length);
+
+#endif /* INCLUDE_OSDLP_RANDOMIZER_H_ */
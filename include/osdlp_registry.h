@@ -0,0 +1,152 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_REGISTRY_H_
+#define INCLUDE_OSDLP_REGISTRY_H_
+
+#include <stdint.h>
+#include "osdlp_tc.h"
+
+/**
+ * A slot of the registry. Empty slots have a NULL tc_tf
+ */
+struct tc_registry_slot {
+	uint16_t                    key;        /* SCID << 6 | VCID*/
+	struct tc_transfer_frame    *tc_tf;     /* The context of the VC*/
+};
+
+/**
+ * Registry of TC contexts keyed by (SCID, VCID).
+ * The registry uses open addressing with linear probing over a slot array
+ * provided by the user, so that lookups cost O(1) regardless of the number
+ * of spacecraft served.
+ */
+struct tc_registry {
+	struct tc_registry_slot     *slots;
+	uint32_t                    mask;       /* Number of slots - 1*/
+	uint32_t                    count;      /* Registered contexts*/
+	uint8_t                     shift;      /* 32 - log2(number of slots)*/
+};
+
+/**
+ * Initializes a registry
+ * @param reg the registry
+ * @param slots the slot array. Its contents are cleared
+ * @param nslots the number of slots. Must be a power of 2, at least 2.
+ * The registry accepts up to 3/4 of nslots contexts
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_tc_registry_init(struct tc_registry *reg, struct tc_registry_slot *slots,
+                       uint32_t nslots);
+
+/**
+ * Registers a TC context under the SCID and the VCID of its mission
+ * parameters
+ * @param reg the registry
+ * @param tc_tf the context, initialized with osdlp_tc_init()
+ *
+ * @return 0 on success, negative value if the registry is full or the
+ * (SCID, VCID) pair is already registered
+ */
+int
+osdlp_tc_registry_add(struct tc_registry *reg, struct tc_transfer_frame *tc_tf);
+
+/**
+ * Removes the context registered under (SCID, VCID)
+ * @param reg the registry
+ * @param scid the spacecraft ID
+ * @param vcid the virtual channel ID
+ *
+ * @return 0 on success, negative value if no such context exists
+ */
+int
+osdlp_tc_registry_remove(struct tc_registry *reg, uint16_t scid, uint8_t vcid);
+
+/**
+ * Returns the context registered under (SCID, VCID) or NULL
+ * @param reg the registry
+ * @param scid the spacecraft ID
+ * @param vcid the virtual channel ID
+ */
+struct tc_transfer_frame *
+osdlp_tc_registry_lookup(struct tc_registry *reg, uint16_t scid, uint8_t vcid);
+
+/**
+ * Calls fn on every registered context. The registry must not be modified
+ * by fn
+ * @param reg the registry
+ * @param fn the function to call
+ * @param arg an opaque argument passed to fn
+ */
+void
+osdlp_tc_registry_foreach(struct tc_registry *reg,
+                          void (*fn)(struct tc_transfer_frame *, void *),
+                          void *arg);
+
+/**
+ * Performs TC receive with COP, routing the frame to the context that
+ * matches the SCID and the VCID of its primary header
+ * @param reg the registry
+ * @param rx_buffer the received frame
+ * @param length the length of the rx_buffer
+ * @param tc_tf reference to the pointer that will hold the matched context.
+ * Can be NULL
+ *
+ * @return the negative value of tc_rx_result_t for error, 0 for success
+ */
+int
+osdlp_tc_registry_receive(struct tc_registry *reg, uint8_t *rx_buffer,
+                          uint32_t length, struct tc_transfer_frame **tc_tf);
+
+/**
+ * Passes a CLCW to the FOP-1 of the context that matches the given SCID
+ * and the VCID reported in the CLCW
+ * @param reg the registry
+ * @param scid the spacecraft ID of the TM frame that carried the CLCW
+ * @param ocf_buffer the CLCW
+ *
+ * @return the notification of the FOP-1, UNDEF_ERROR if no such context exists
+ */
+notification_t
+osdlp_tc_registry_handle_clcw(struct tc_registry *reg, uint16_t scid,
+                              uint8_t *ocf_buffer);
+
+/**
+ * Passes a burst of CLCWs to the FOP-1 of their contexts, evaluating the
+ * FOP-1 as few times as possible:
+ * - a CLCW without the lockout, wait and retransmit flags is superseded by
+ *   a later one of the same VC that has none of them either and whose N(R)
+ *   is not behind
+ * - a CLCW identical to the last one processed is dropped, as long as the
+ *   FOP-1 has not changed since (see osdlp_handle_clcw_once())
+ * CLCWs of a VC are processed in order. CLCWs of unknown VCs are skipped.
+ * @param reg the registry
+ * @param scid the spacecraft ID of the TM frames that carried the CLCWs
+ * @param ocf_buffers the CLCWs, 4 octets each
+ * @param count the number of CLCWs
+ *
+ * @return the number of CLCWs that were processed by the FOP-1
+ */
+uint32_t
+osdlp_tc_registry_handle_clcw_batch(struct tc_registry *reg, uint16_t scid,
+                                    uint8_t *ocf_buffers, uint32_t count);
+
+#endif /* INCLUDE_OSDLP_REGISTRY_H_ */
@@ -0,0 +1,109 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_REORDER_H_
+#define INCLUDE_OSDLP_REORDER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_types.h"
+
+struct tm_transfer_frame;
+struct osdlp_reorder;
+
+/**
+ * A received frame travelling through the stateless stages
+ */
+struct osdlp_rx_job {
+	struct osdlp_reorder    *owner;
+	uint8_t                 *frame;     /* frame_len octets*/
+	int32_t                 status;     /* Result of the stateless stages*/
+	uint32_t                done;       /* Set once status is valid*/
+};
+
+/**
+ * Reorder buffer of a TM virtual channel. The receiving thread reserves a
+ * job for each frame in arrival order and hands it to a pool of threads,
+ * e.g. through work-stealing deques. The pool runs the stateless stages,
+ * de-randomization and FECF check, in any order, and the reassembly thread
+ * drains the finished jobs in arrival order into the stateful
+ * reassembly of the virtual channel.
+ */
+struct osdlp_reorder {
+	uint32_t                    head
+	__attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t                    tail
+	__attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t                    errors;     /* Frames rejected*/
+	/* Constant after initialization*/
+	struct osdlp_rx_job         *jobs
+	__attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t                    mask;       /* nslots - 1*/
+	bool                        derandomize;
+	struct tm_transfer_frame    *tm_tf;
+};
+
+/**
+ * Initializes an empty reorder buffer
+ * @param r the reorder buffer
+ * @param tm_tf the receiving configuration of the virtual channel
+ * @param jobs memory for nslots jobs
+ * @param storage the frame storage. Must hold nslots frames of the virtual
+ * channel
+ * @param nslots the number of frames in flight. Must be a power of 2
+ * @param derandomize true if frames are de-randomized before the FECF check
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_reorder_init(struct osdlp_reorder *r, struct tm_transfer_frame *tm_tf,
+                   struct osdlp_rx_job *jobs, uint8_t *storage,
+                   uint32_t nslots, bool derandomize);
+
+/**
+ * Reserves the job of the next received frame. Receiving side, one thread
+ * per buffer. The frame is then copied into job->frame
+ * @param r the reorder buffer
+ *
+ * @return the job, NULL if all slots are in flight
+ */
+struct osdlp_rx_job *
+osdlp_reorder_reserve(struct osdlp_reorder *r);
+
+/**
+ * Runs the stateless stages on a frame and marks its job as finished.
+ * Safe to call from any thread, once per reserved job
+ * @param job the job
+ */
+void
+osdlp_rx_job_run(struct osdlp_rx_job *job);
+
+/**
+ * Passes the finished frames to the reassembly of the virtual channel,
+ * in the order they were reserved. Stops at the first unfinished one.
+ * Reassembly side, one thread per buffer
+ * @param r the reorder buffer
+ * @param max the maximum number of frames to pass
+ *
+ * @return the number of frames passed, including rejected ones
+ */
+uint32_t
+osdlp_reorder_drain(struct osdlp_reorder *r, uint32_t max);
+
+#endif /* INCLUDE_OSDLP_REORDER_H_ */
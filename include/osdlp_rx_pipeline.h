@@ -0,0 +1,149 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_RX_PIPELINE_H_
+#define INCLUDE_OSDLP_RX_PIPELINE_H_
+
+#include <stdint.h>
+#include "osdlp_spsc_ring.h"
+#include "osdlp_types.h"
+
+#define RX_PIPELINE_MAX_VCS     OSDLP_MAX_VCS
+#define RX_PIPELINE_NO_LANE     0xff
+
+typedef enum {
+	OSDLP_RX_PIPELINE_TC = 0,
+	OSDLP_RX_PIPELINE_TM = 1
+} osdlp_rx_pipeline_type_t;
+
+struct tc_transfer_frame;
+struct tm_transfer_frame;
+
+/**
+ * A lane carries the frames of one or more virtual channels from the
+ * dispatcher to a single worker.
+ */
+struct osdlp_rx_lane {
+	struct osdlp_spsc_ring  ring;
+	uint32_t                dropped;    /* Frames not fitting the ring*/
+	uint32_t                errors;     /* Frames rejected by the receiver*/
+};
+
+/**
+ * Receive pipeline. A dispatcher thread reads the VCID of each raw frame
+ * and passes the frame to the lane of its virtual channel. A worker thread
+ * per lane, typically pinned to its own core, runs the receive logic of
+ * the virtual channels of the lane. As a virtual channel belongs to a
+ * single lane and each lane is a FIFO, the frames of a virtual channel are
+ * received in order, while different lanes proceed in parallel. The
+ * threads are created by the application.
+ * TM frames must have the frame length of their virtual channel. The
+ * master channel frame count is not updated on receive, so the virtual
+ * channels of a master channel can be on different lanes.
+ */
+struct osdlp_rx_pipeline {
+	uint8_t                 type;       /* osdlp_rx_pipeline_type_t*/
+	uint8_t                 nlanes;
+	uint8_t                 lane_of[RX_PIPELINE_MAX_VCS];
+	void                    *ctx[RX_PIPELINE_MAX_VCS];
+	struct osdlp_rx_lane    *lanes;
+	uint32_t                unknown;    /* Frames of unknown VCs*/
+};
+
+/**
+ * Initializes a pipeline without any virtual channels
+ * @param p the pipeline
+ * @param type whether TC or TM frames are received
+ * @param lanes memory for the lanes
+ * @param nlanes the number of lanes
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_rx_pipeline_init(struct osdlp_rx_pipeline *p,
+                       osdlp_rx_pipeline_type_t type,
+                       struct osdlp_rx_lane *lanes, uint8_t nlanes);
+
+/**
+ * Initializes the ring of a lane
+ * @param p the pipeline
+ * @param lane the lane
+ * @param storage the frame storage. Must hold
+ * nslots * SPSC_RING_STRIDE(slot_len) octets and be 4-byte aligned
+ * @param nslots the number of slots. Must be a power of 2
+ * @param slot_len the maximum frame length of the virtual channels of the
+ * lane
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_rx_pipeline_lane_init(struct osdlp_rx_pipeline *p, uint8_t lane,
+                            uint8_t *storage, uint32_t nslots,
+                            uint32_t slot_len);
+
+/**
+ * Assigns a TC virtual channel to a lane
+ * @param p the pipeline
+ * @param lane the lane
+ * @param tc_tf the receiving configuration of the virtual channel
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_rx_pipeline_add_tc(struct osdlp_rx_pipeline *p, uint8_t lane,
+                         struct tc_transfer_frame *tc_tf);
+
+/**
+ * Assigns a TM virtual channel to a lane
+ * @param p the pipeline
+ * @param lane the lane
+ * @param tm_tf the receiving configuration of the virtual channel
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_rx_pipeline_add_tm(struct osdlp_rx_pipeline *p, uint8_t lane,
+                         struct tm_transfer_frame *tm_tf);
+
+/**
+ * Passes a raw frame to the lane of its virtual channel. Dispatcher side
+ * @param p the pipeline
+ * @param frame the frame
+ * @param length the length of the frame
+ *
+ * @return 0 on success, negative value if the virtual channel is unknown or
+ * its lane is full
+ */
+int
+osdlp_rx_pipeline_dispatch(struct osdlp_rx_pipeline *p, const uint8_t *frame,
+                           uint32_t length);
+
+/**
+ * Receives the frames waiting on a lane. Worker side, one worker per lane
+ * @param p the pipeline
+ * @param lane the lane
+ * @param max the maximum number of frames to receive
+ *
+ * @return the number of frames received, including rejected ones
+ */
+uint32_t
+osdlp_rx_pipeline_work(struct osdlp_rx_pipeline *p, uint8_t lane,
+                       uint32_t max);
+
+#endif /* INCLUDE_OSDLP_RX_PIPELINE_H_ */
@@ -0,0 +1,173 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_SENT_RING_H_
+#define INCLUDE_OSDLP_SENT_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_cop.h"
+
+#define SENT_RING_MAX_SLOTS     256
+
+struct tc_frame_pool;
+
+/**
+ * Library owned sent queue of a virtual channel.
+ * Type-A frames are stored at the slot indexed by their sequence number
+ * modulo the number of slots, so acknowledging N(R) releases a range of
+ * slots and the next frame to retransmit is found with a find-first-set
+ * over the retransmit bitmap. The Type-B frame, if any, has its own slot.
+ * A shared ring holds references to frame pool buffers instead of copies.
+ */
+struct tc_sent_ring {
+	uint8_t     *storage;       /* (nslots + 1) * slot_len octets*/
+	struct tc_frame_pool *pool; /* Frame pool of a shared ring, else NULL*/
+	uint8_t     **refs;         /* nslots + 1 frames of a shared ring*/
+	uint16_t    slot_len;       /* Maximum frame length*/
+	uint16_t    mask;           /* nslots - 1*/
+	uint16_t    count;          /* Number of Type-A frames*/
+	uint8_t     head;           /* Sequence number of the oldest frame*/
+	uint8_t     bc_held;        /* A Type-B frame is stored*/
+	uint8_t     bc_rt;          /* Retransmit flag of the Type-B frame*/
+	uint8_t     bc_seq_num;
+	uint64_t    rt[SENT_RING_MAX_SLOTS / 64];  /* Retransmit bitmap*/
+};
+
+/**
+ * Initializes a sent ring
+ * @param ring the ring
+ * @param storage the frame storage. Must hold (nslots + 1) * slot_len octets
+ * @param nslots the number of Type-A slots. Must be a power of 2, at most
+ * 256 and not smaller than the FOP sliding window
+ * @param slot_len the maximum frame length
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_sent_ring_init(struct tc_sent_ring *ring, uint8_t *storage,
+                     uint16_t nslots, uint16_t slot_len);
+
+/**
+ * Initializes a shared sent ring. Instead of copying the sent frames, the
+ * ring takes a reference to them and drops it when they are released.
+ * All frames must be allocated from the frame pool attached to the virtual
+ * channel.
+ * @param ring the ring
+ * @param pool the frame pool of the virtual channel
+ * @param refs the frame references. Must hold nslots + 1 pointers
+ * @param nslots the number of Type-A slots. Must be a power of 2, at most
+ * 256 and not smaller than the FOP sliding window
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_sent_ring_init_shared(struct tc_sent_ring *ring,
+                            struct tc_frame_pool *pool, uint8_t **refs,
+                            uint16_t nslots);
+
+/**
+ * Stores a sent frame
+ * @param ring the ring
+ * @param item the sent frame
+ *
+ * @return 0 on success, negative value if there is no room
+ */
+int
+osdlp_sent_ring_enqueue(struct tc_sent_ring *ring, struct queue_item *item);
+
+/**
+ * Returns the oldest frame of the ring
+ * @param ring the ring
+ * @param item the queue_item that will hold the frame
+ *
+ * @return 0 on success, negative value if the ring is empty
+ */
+int
+osdlp_sent_ring_head(struct tc_sent_ring *ring, struct queue_item *item);
+
+/**
+ * Removes the oldest frame of the ring
+ * @param ring the ring
+ *
+ * @return 0 on success, negative value if the ring is empty
+ */
+int
+osdlp_sent_ring_dequeue(struct tc_sent_ring *ring);
+
+/**
+ * Releases the Type-A frames acknowledged by N(R) in a single step
+ * @param ring the ring
+ * @param nr the N(R) reported by the CLCW
+ * @param max the maximum number of frames to release
+ *
+ * @return the number of released frames
+ */
+uint16_t
+osdlp_sent_ring_release(struct tc_sent_ring *ring, uint8_t nr, uint16_t max);
+
+bool
+osdlp_sent_ring_empty(struct tc_sent_ring *ring);
+
+void
+osdlp_sent_ring_clear(struct tc_sent_ring *ring);
+
+/**
+ * Marks all Type-A frames as 'to be retransmitted'
+ */
+void
+osdlp_sent_ring_mark_ad_as_rt(struct tc_sent_ring *ring);
+
+/**
+ * Marks the Type-B frame as 'to be retransmitted'
+ *
+ * @return 0 on success, negative value if there is no Type-B frame
+ */
+int
+osdlp_sent_ring_mark_bc_as_rt(struct tc_sent_ring *ring);
+
+/**
+ * Fetches the oldest Type-A frame with the retransmit flag on
+ * @param ring the ring
+ * @param item the queue_item that will hold the frame
+ *
+ * @return 0 on success, negative value if there is no such frame
+ */
+int
+osdlp_sent_ring_first_ad_rt(struct tc_sent_ring *ring, struct queue_item *item);
+
+/**
+ * Resets the retransmit flag of a frame
+ * @param ring the ring
+ * @param item the frame
+ */
+void
+osdlp_sent_ring_reset_rt(struct tc_sent_ring *ring, struct queue_item *item);
+
+/**
+ * Makes the COP-1 of a virtual channel keep its sent frames in a ring
+ * instead of the sent queue callbacks. Passing NULL restores the callbacks.
+ * @param tc_tf the TC config struct
+ * @param ring the ring
+ */
+void
+osdlp_sent_ring_attach(struct tc_transfer_frame *tc_tf,
+                       struct tc_sent_ring *ring);
+
+#endif /* INCLUDE_OSDLP_SENT_RING_H_ */
@@ -0,0 +1,173 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_SPSC_RING_H_
+#define INCLUDE_OSDLP_SPSC_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_types.h"
+
+/* Octets occupied by a slot of slot_len octets, including its length*/
+#define SPSC_RING_STRIDE(slot_len)                                      \
+	((((uint32_t)(slot_len) + 3) & ~(uint32_t)3) + sizeof(uint32_t))
+
+struct tc_transfer_frame;
+struct tm_transfer_frame;
+
+/**
+ * Lock-free single producer single consumer ring of frames.
+ * The producer and the consumer may run on different threads without any
+ * locking. Each side only writes its own index, which lives on its own
+ * cache line together with a cached copy of the index of the other side,
+ * so the shared lines are only touched when the cached copy says the ring
+ * is full or empty. Frames are written and read in place.
+ */
+struct osdlp_spsc_ring {
+	/* Producer side*/
+	uint32_t    tail __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    head_cache;     /* Last head seen by the producer*/
+	/* Consumer side*/
+	uint32_t    head __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    tail_cache;     /* Last tail seen by the consumer*/
+	/* Constant after initialization*/
+	uint8_t     *storage __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    mask;           /* nslots - 1*/
+	uint32_t    stride;         /* SPSC_RING_STRIDE(slot_len)*/
+	uint32_t    slot_len;       /* Maximum frame length*/
+};
+
+/**
+ * Initializes a ring
+ * @param ring the ring
+ * @param storage the frame storage. Must hold
+ * nslots * SPSC_RING_STRIDE(slot_len) octets and be 4-byte aligned
+ * @param nslots the number of slots. Must be a power of 2
+ * @param slot_len the maximum frame length
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_spsc_ring_init(struct osdlp_spsc_ring *ring, uint8_t *storage,
+                     uint32_t nslots, uint32_t slot_len);
+
+/**
+ * Returns the next free slot of the ring. Producer side only.
+ * The slot holds up to slot_len octets and becomes visible to the consumer
+ * with osdlp_spsc_ring_commit()
+ * @param ring the ring
+ *
+ * @return the slot, NULL if the ring is full
+ */
+uint8_t *
+osdlp_spsc_ring_reserve(struct osdlp_spsc_ring *ring);
+
+/**
+ * Publishes the slot returned by osdlp_spsc_ring_reserve()
+ * @param ring the ring
+ * @param length the length of the frame in the slot
+ */
+void
+osdlp_spsc_ring_commit(struct osdlp_spsc_ring *ring, uint32_t length);
+
+/**
+ * Returns the oldest frame of the ring, without removing it. Consumer side
+ * only
+ * @param ring the ring
+ * @param length pointer to store the length of the frame
+ *
+ * @return the frame, NULL if the ring is empty
+ */
+uint8_t *
+osdlp_spsc_ring_peek(struct osdlp_spsc_ring *ring, uint32_t *length);
+
+/**
+ * Removes the frame returned by osdlp_spsc_ring_peek(), giving its slot
+ * back to the producer
+ * @param ring the ring
+ */
+void
+osdlp_spsc_ring_release(struct osdlp_spsc_ring *ring);
+
+/**
+ * Copies a frame into the ring. Producer side only
+ * @param ring the ring
+ * @param frame the frame
+ * @param length the length of the frame
+ *
+ * @return 0 on success, negative value if the ring is full or the frame
+ * does not fit in a slot
+ */
+int
+osdlp_spsc_ring_push(struct osdlp_spsc_ring *ring, const uint8_t *frame,
+                     uint32_t length);
+
+/**
+ * Copies the oldest frame out of the ring and removes it. Consumer side only
+ * @param ring the ring
+ * @param frame buffer of at least slot_len octets
+ * @param length pointer to store the length of the frame
+ *
+ * @return 0 on success, negative value if the ring is empty
+ */
+int
+osdlp_spsc_ring_pop(struct osdlp_spsc_ring *ring, uint8_t *frame,
+                    uint32_t *length);
+
+/**
+ * Returns true if the ring is full. Exact on the producer side
+ */
+bool
+osdlp_spsc_ring_full(struct osdlp_spsc_ring *ring);
+
+/**
+ * Returns true if the ring is empty. Exact on the consumer side
+ */
+bool
+osdlp_spsc_ring_empty(struct osdlp_spsc_ring *ring);
+
+/**
+ * Makes a virtual channel pass its received SDUs to a ring instead of the
+ * osdlp_tc_rx_queue_* hooks. The TC context is the producer of the ring.
+ * Passing NULL restores the hooks.
+ * @param tc_tf the TC config struct
+ * @param ring the ring. Its slots must hold the maximum SDU length
+ *
+ * @return 0 on success, negative value if the slots are too short
+ */
+int
+osdlp_spsc_ring_attach_tc_rx(struct tc_transfer_frame *tc_tf,
+                             struct osdlp_spsc_ring *ring);
+
+/**
+ * Makes a virtual channel pack its frames directly into the slots of a ring
+ * instead of passing them to the osdlp_tm_tx_queue_* hooks. The TM context
+ * is the producer of the ring. As queued frames may already be read by the
+ * consumer, new packets are never stuffed into them. Passing NULL restores
+ * the hooks.
+ * @param tm_tf the TM config struct
+ * @param ring the ring. Its slots must hold a whole frame
+ *
+ * @return 0 on success, negative value if the slots are too short
+ */
+int
+osdlp_spsc_ring_attach_tm_tx(struct tm_transfer_frame *tm_tf,
+                             struct osdlp_spsc_ring *ring);
+
+#endif /* INCLUDE_OSDLP_SPSC_RING_H_ */
@@ -24,8 +24,10 @@
 #include <stdint.h>
 
 #include "osdlp_clcw.h"
+#include "osdlp_types.h"
 
 #define TC_VERSION_NUMBER           0
+#define TC_PRIMARY_HDR_LEN          5
 #define UNLOCK_CMD                  0
 #define SETVR_BYTE1                 0x82
 #define SETVR_BYTE2                 0
@@ -85,15 +87,20 @@ typedef enum {
 	TC_TX_COP_ERR          = 3
 } tc_tx_result_t;
 
+/**
+ * The header fields are plain integers rather than bitfields, so updating
+ * them per frame is a single store. They are masked to their width when
+ * the frame is packed.
+ */
 struct tc_primary_hdr {
-	uint8_t             version_num     : 2;    /* TC version number*/
-	uint8_t             bypass          : 1;    /* Bypass flag*/
-	uint8_t             ctrl_cmd        : 1;    /* Control command*/
-	uint8_t             rsvd_spare      : 2;    /* Raserved - spare*/
-	uint16_t            spacecraft_id   : 10;   /* Spacecraft ID*/
-	uint8_t             vcid            : 6;    /* Cirtual Channel ID*/
-	uint16_t            frame_len       : 10;   /* Frame length (Total octets - 1)*/
-	uint8_t             frame_seq_num;          /* Frame sequence number*/
+	uint8_t             version_num;    /* TC version number, 2 bits*/
+	uint8_t             bypass;         /* Bypass flag*/
+	uint8_t             ctrl_cmd;       /* Control command*/
+	uint8_t             rsvd_spare;     /* Raserved - spare, 2 bits*/
+	uint16_t            spacecraft_id;  /* Spacecraft ID, 10 bits*/
+	uint8_t             vcid;           /* Cirtual Channel ID, 6 bits*/
+	uint8_t             frame_seq_num;  /* Frame sequence number*/
+	uint16_t            frame_len;      /* Frame length (Total octets - 1)*/
 };
 
 /**
@@ -107,17 +114,17 @@ typedef enum {
 } tc_seq_flag_t;
 
 struct tc_seg_hdr {
-	uint8_t         seq_flag    : 2;    /* Sequence flag*/
-	uint8_t         map_id      : 6;    /* MAP ID*/
+	uint8_t         seq_flag;   /* Sequence flag, 2 bits*/
+	uint8_t         map_id;     /* MAP ID, 6 bits*/
 };
 
 /**
  * Frame data field struct
  */
 struct	tc_fdf {
-	struct tc_seg_hdr   seg_hdr;
 	uint8_t             *data;
 	uint16_t            data_len;
+	struct tc_seg_hdr   seg_hdr;
 };
 
 /**
@@ -125,7 +132,7 @@ struct	tc_fdf {
  */
 struct tc_util_buf {
 	uint8_t             *buffer;
-	uint16_t            buffered_length;
+	osdlp_sdu_len_t     buffered_length;
 	uint8_t             loop_state;
 };
 
@@ -136,7 +143,7 @@ struct tc_mission_params {
 	struct tc_util_buf  util;
 	uint8_t             crc_flag;
 	uint8_t             seg_hdr_flag;
-	uint16_t            max_sdu_len;       /* Maximum size of higher layer frame*/
+	osdlp_sdu_len_t     max_sdu_len;       /* Maximum size of higher layer frame*/
 	uint16_t
 	max_data_len;      /* Maximum size of data portion of packet*/
 	uint16_t            max_frame_len;     /* Maximum size of frame*/
@@ -155,7 +162,7 @@ struct tc_mission_params {
  */
 struct segment_status {
 	uint8_t     flag;
-	uint16_t    octets_txed;
+	osdlp_sdu_len_t octets_txed;
 };
 
 struct farm_config {
@@ -207,6 +214,10 @@ struct fop_config {
 	uint8_t         ss;
 	notification_t  signal;   /* This field is used as a way to signal
                               higher layers from the COP-1*/
+	uint8_t         memo_valid;
+	uint8_t         rt_burst;   /* Type-AD retransmission burst running*/
+	uint32_t        memo_clcw;  /* Last CLCW of osdlp_handle_clcw_once()*/
+	uint32_t        memo_fop;   /* FOP-1 status after processing it*/
 };
 
 struct cop_config {
@@ -216,19 +227,89 @@ struct cop_config {
 	};
 };
 
+/**
+ * Per-frame state of a TC frame. Together with a TC config struct that is
+ * only read, it holds everything needed to pack a frame, so that several
+ * threads can pack frames of the same virtual channel at once.
+ */
+struct tc_frame_work {
+	uint8_t     bypass;
+	uint8_t     ctrl_cmd;
+	uint8_t     seq_num;        /* N(S) of a Type-A frame*/
+	uint8_t     seq_flag;       /* Segment header sequence flag*/
+	uint16_t    crc;            /* CRC of the packed frame, if present*/
+};
+
+struct tc_sent_ring;
+struct tc_frame_pool;
+struct tc_timer_wheel;
+struct tc_timer;
+struct osdlp_tc_ops;
+struct osdlp_spsc_ring;
+struct osdlp_mpmc_queue;
+
+struct tc_transfer_frame;
+
+/**
+ * Notification callback of a virtual channel. It is called by the COP-1
+ * with each notification, at the point the notification is raised, so no
+ * intermediate notification is lost. The FOP-1 state is already updated.
+ * It runs on the thread driving the COP-1 and must not call back into the
+ * COP-1 of the same virtual channel.
+ */
+typedef void (*osdlp_tc_notify_t)(struct tc_transfer_frame *tc_tf,
+                                  notification_t notif, void *arg);
+
+/**
+ * TC config struct. The fields written for every frame come first, so that
+ * they share the first cache line, followed by the pointers read for every
+ * frame. The configuration and the rarely used state come last.
+ */
 struct tc_transfer_frame {
 	struct tc_primary_hdr       primary_hdr;    /* Primary header struct*/
-	struct tc_mission_params    mission;        /* Mission params*/
-	struct cop_config           cop_cfg;        /* COP configuration struct*/
+	uint16_t                    crc;            /* CRC*/
 	struct tc_fdf               frame_data;     /* Frame data structure*/
+	struct cop_config           cop_cfg;        /* COP configuration struct*/
+	const struct osdlp_tc_ops   *ops;           /* Hook operations*/
+	void                        *user;          /* Operations context*/
+	struct tc_sent_ring         *sent_ring;     /* Optional sent ring*/
+	struct tc_frame_pool        *frame_pool;    /* Optional frame pool*/
+	struct tc_timer_wheel       *timer_wheel;   /* Optional timer wheel*/
+	struct tc_timer             *timer;         /* T1 timer on the wheel*/
+	struct osdlp_spsc_ring      *rx_ring;       /* Optional RX ring*/
+	struct osdlp_mpmc_queue     *uplink;        /* Optional shared uplink*/
+	struct tc_mission_params    mission;        /* Mission params*/
 	struct segment_status       seg_status;     /* Segment status struct*/
-	uint16_t                    crc;            /* CRC*/
+	osdlp_tc_notify_t           notify;         /* Optional callback*/
+	void                        *notify_arg;    /* Callback argument*/
+	uint32_t                    notify_cnt;     /* Notifications raised*/
 };
 
+/* Frame format parameters, constants when fixed by osdlp_config.h */
+#ifdef OSDLP_TC_CRC
+#define TC_CRC_FLAG(tc_tf)          (OSDLP_TC_CRC)
+#else
+#define TC_CRC_FLAG(tc_tf)          ((tc_tf)->mission.crc_flag)
+#endif
+
+#ifdef OSDLP_TC_SEG_HDR
+#define TC_SEG_HDR_FLAG(tc_tf)      (OSDLP_TC_SEG_HDR)
+#else
+#define TC_SEG_HDR_FLAG(tc_tf)      ((tc_tf)->mission.seg_hdr_flag)
+#endif
+
+#if defined(OSDLP_TC_CRC) && defined(OSDLP_TC_SEG_HDR)
+#define TC_OVERHEAD_LEN(tc_tf)                                          \
+	(TC_PRIMARY_HDR_LEN + (OSDLP_TC_SEG_HDR == TC_SEG_HDR_PRESENT)      \
+	 + 2 * (OSDLP_TC_CRC == TC_CRC_PRESENT))
+#else
+#define TC_OVERHEAD_LEN(tc_tf)      ((tc_tf)->mission.fixed_overhead_len)
+#endif
+
 int
 osdlp_tc_init(struct tc_transfer_frame *tc_tf,
               uint16_t scid,
-              uint16_t max_fdu_len,
+              osdlp_sdu_len_t max_fdu_len,
               uint16_t max_frame_len,
               uint16_t rx_fifo_len,
               uint8_t vcid,
@@ -239,6 +320,18 @@ osdlp_tc_init(struct tc_transfer_frame *tc_tf,
               tc_ctrl_t ctrl_cmd,
               uint8_t *util_buffer,
               struct cop_config cop);
+
+/**
+ * Sets the notification callback of a virtual channel. The signal field of
+ * the FOP-1 is still updated, so polling it keeps working
+ * @param tc_tf the TC config struct
+ * @param notify the callback. NULL disables it
+ * @param arg the pointer passed to the callback
+ */
+void
+osdlp_tc_set_notify(struct tc_transfer_frame *tc_tf,
+                    osdlp_tc_notify_t notify, void *arg);
+
 /**
  * Unpacks a received buffer and populates the corresponding fields of
  * a TC config structure
@@ -259,6 +352,21 @@ void
 osdlp_tc_pack(struct tc_transfer_frame *tc_tf, uint8_t *pkt_out,
               uint8_t *data_in, uint16_t length);
 
+/**
+ * Packs a TC frame without writing to the TC config struct. The per-frame
+ * fields are taken from the work state instead, so the config can be shared
+ * read-only by several threads.
+ * @param tc_tf the TC config struct
+ * @param work the per-frame state. Its crc field is set on return
+ * @param pkt_out the buffer where the packet will be placed
+ * @param data_in the input data buffer
+ * @param length the length of the data_in buffer
+ */
+void
+osdlp_tc_pack_frame(const struct tc_transfer_frame *tc_tf,
+                    struct tc_frame_work *work, uint8_t *pkt_out,
+                    const uint8_t *data_in, uint16_t length);
+
 void
 osdlp_prepare_typea_data_frame(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
                                uint16_t len, uint8_t mapid);
@@ -280,6 +388,48 @@ int
 osdlp_frame_validation_check(struct tc_transfer_frame *tc_tf,
                              uint8_t *rx_buffer);
 
+/**
+ * Decodes and validates a received frame in a single pass.
+ * The configuration of the virtual channel is retrieved through
+ * osdlp_tc_get_rx_config(). Frames with a foreign spacecraft ID or an
+ * unknown VCID are rejected before the CRC is computed.
+ *
+ * @param tc_tf reference to the pointer that will hold the configuration
+ * of the virtual channel
+ * @param rx_buffer the received frame
+ * @param length the length of the rx_buffer
+ *
+ * @return the negative value of tc_rx_result_t for error, 0 for success
+ */
+int
+osdlp_tc_rx_decode(struct tc_transfer_frame **tc_tf, uint8_t *rx_buffer,
+                   uint32_t length);
+
+/**
+ * Decodes and validates a received frame against a known virtual channel
+ * configuration, bypassing osdlp_tc_get_rx_config()
+ *
+ * @param tc_tf the configuration of the virtual channel
+ * @param rx_buffer the received frame
+ * @param length the length of the rx_buffer
+ *
+ * @return the negative value of tc_rx_result_t for error, 0 for success
+ */
+int
+osdlp_tc_rx_validate(struct tc_transfer_frame *tc_tf, uint8_t *rx_buffer,
+                     uint32_t length);
+
+/**
+ * Runs the FARM-1 and the reassembly logic on a frame that has been
+ * decoded with osdlp_tc_rx_decode() or osdlp_tc_rx_validate()
+ *
+ * @param tc_tf the configuration of the virtual channel
+ *
+ * @return the negative value of tc_rx_result_t for error, 0 for success
+ */
+int
+osdlp_tc_rx_process(struct tc_transfer_frame *tc_tf);
+
 /* Performs TC receive with COP
  *
  * @param the rx_buffer
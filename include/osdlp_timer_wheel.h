@@ -0,0 +1,109 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_TIMER_WHEEL_H_
+#define INCLUDE_OSDLP_TIMER_WHEEL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "osdlp_tc.h"
+
+/**
+ * The T1 timer of a virtual channel. Timers are linked into the slot of
+ * the wheel that their expiry tick hashes to
+ */
+struct tc_timer {
+	struct tc_timer             *next;
+	struct tc_timer             **pprev;    /* NULL if not running*/
+	uint32_t                    expires;    /* Expiry tick*/
+	struct tc_transfer_frame    *tc_tf;     /* The owner VC*/
+};
+
+/**
+ * Hashed timer wheel serving the T1 timers of many virtual channels.
+ * Starting, restarting and cancelling a timer cost O(1). Timeouts longer
+ * than the wheel stay in their slot for more than one revolution.
+ */
+struct tc_timer_wheel {
+	struct tc_timer             **slots;
+	uint32_t                    mask;       /* Number of slots - 1*/
+	uint32_t                    now;        /* Current tick*/
+	uint32_t                    running;    /* Number of running timers*/
+};
+
+/**
+ * Initializes a timer wheel
+ * @param wheel the wheel
+ * @param slots the slot array. Its contents are cleared
+ * @param nslots the number of slots. Must be a power of 2. For best
+ * performance it should exceed the largest T1 in ticks
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_timer_wheel_init(struct tc_timer_wheel *wheel, struct tc_timer **slots,
+                       uint32_t nslots);
+
+/**
+ * Makes the COP-1 of a virtual channel use a timer of the wheel instead of
+ * the osdlp_timer_start() and osdlp_timer_cancel() callbacks. The T1 initial
+ * value of the FOP-1 is interpreted in ticks of the wheel. Passing a NULL
+ * wheel restores the callbacks.
+ * @param tc_tf the TC config struct
+ * @param wheel the wheel
+ * @param timer the timer of the virtual channel
+ */
+void
+osdlp_timer_wheel_attach(struct tc_transfer_frame *tc_tf,
+                         struct tc_timer_wheel *wheel, struct tc_timer *timer);
+
+/**
+ * Starts or restarts a timer
+ * @param wheel the wheel
+ * @param timer the timer
+ * @param ticks the timeout in ticks. A timeout of 0 expires on the next tick
+ */
+void
+osdlp_timer_wheel_start(struct tc_timer_wheel *wheel, struct tc_timer *timer,
+                        uint32_t ticks);
+
+/**
+ * Cancels a timer. Cancelling a timer that is not running has no effect
+ * @param wheel the wheel
+ * @param timer the timer
+ */
+void
+osdlp_timer_wheel_cancel(struct tc_timer_wheel *wheel, struct tc_timer *timer);
+
+bool
+osdlp_timer_wheel_running(const struct tc_timer *timer);
+
+/**
+ * Advances the wheel. The timers that expire are collected first and then
+ * passed to osdlp_handle_timer_expired() of their virtual channel, so a
+ * handler may freely restart or cancel any timer.
+ * @param wheel the wheel
+ * @param ticks the number of elapsed ticks
+ *
+ * @return the number of expired timers
+ */
+uint32_t
+osdlp_timer_wheel_advance(struct tc_timer_wheel *wheel, uint32_t ticks);
+
+#endif /* INCLUDE_OSDLP_TIMER_WHEEL_H_ */
@@ -21,6 +21,7 @@
 #include <stdbool.h>
 
 #include "osdlp_crc.h"
+#include "osdlp_types.h"
 
 #ifndef INCLUDE_TM_H_
 #define INCLUDE_TM_H_
@@ -85,20 +86,25 @@ typedef enum {
 	TM_RX_WRONG_CRC     = 5
 } tm_rx_result_t;
 
+/*
+ * The header fields are plain integers rather than bitfields, so updating
+ * them per frame is a single store. They are masked to their width when
+ * the frame is packed.
+ */
 struct tm_master_channel_id {
-	uint8_t		version_num     : 2;
-	uint16_t	spacecraft_id   : 10;
+	uint8_t		version_num;        /* 2 bits*/
+	uint16_t	spacecraft_id;      /* 10 bits*/
 };
 
 /**
  * Data field status struct
  */
 struct tm_df_status {
-	uint8_t					sec_hdr         : 1;
-	uint8_t					sync            : 1;
-	uint8_t					pkt_order       : 1;
-	uint8_t					seg_len_id      : 2;
-	uint16_t				first_hdr_ptr   : 11;
+	uint8_t					sec_hdr;
+	uint8_t					sync;
+	uint8_t					pkt_order;
+	uint8_t					seg_len_id;         /* 2 bits*/
+	uint16_t				first_hdr_ptr;      /* 11 bits*/
 };
 
 /**
@@ -106,12 +112,12 @@ struct tm_df_status {
  */
 struct tm_primary_hdr {
 	struct tm_master_channel_id     mcid;
-	uint8_t                         vcid            : 3;
-	uint8_t                         ocf             : 1;
-	uint8_t
-	*mc_frame_cnt;			// This field needs to be shared among all vcs
+	uint8_t                         vcid;           /* 3 bits*/
+	uint8_t                         ocf;
 	uint8_t                         vc_frame_cnt;
 	struct tm_df_status             status;
+	uint8_t
+	*mc_frame_cnt;			// This field needs to be shared among all vcs
 };
 
 /**
@@ -136,9 +142,9 @@ struct tm_sec_hdr {
 
 struct tm_util_buf {
 	uint8_t            *buffer;
-	uint16_t            buffered_length;
+	osdlp_sdu_len_t     buffered_length;
 	uint8_t             loop_state;
-	uint16_t            expected_pkt_len;
+	osdlp_sdu_len_t     expected_pkt_len;
 };
 
 struct tm_mission_params {
@@ -148,7 +154,7 @@ struct tm_mission_params {
 	header_len;			/* Header length - Including secondary if present*/
 	uint16_t
 	max_data_len;		/* Maximum allowed data size per FDU*/
-	uint16_t
+	osdlp_sdu_len_t
 	max_sdu_len;       /* Maximum size of higher layer frame*/
 	uint8_t                     crc_present;		/* CRC present flag*/
 	uint16_t                    max_vcs;			/* Max number oc VCs allowed*/
@@ -158,15 +164,63 @@ struct tm_mission_params {
 	uint8_t                     ocf_type;
 };
 
+/**
+ * Per-frame state of a TM frame. Together with a TM config struct that is
+ * only read, it holds everything needed to pack a frame, so that several
+ * threads can pack frames of the same virtual channel at once.
+ */
+struct tm_frame_work {
+	uint8_t     mc_frame_cnt;
+	uint8_t     vc_frame_cnt;
+	uint16_t    first_hdr_ptr;
+	uint16_t    crc;            /* CRC of the packed frame, if present*/
+};
+
+struct osdlp_tm_ops;
+struct osdlp_spsc_ring;
+
+/**
+ * TM config struct. The fields used for every frame share the first cache
+ * line. The configuration comes after them.
+ */
 struct tm_transfer_frame {
 	struct tm_primary_hdr       primary_hdr;        /* The primary header struct*/
-	struct tm_sec_hdr           secondary_hdr;      /* The secondary header struct*/
 	uint8_t                     ocf[4];             /* The OCF field */
 	uint16_t                    crc;                /* CRC value*/
+	uint8_t                     claim_lock;         /* Frame count lock*/
 	uint8_t                     *data;              /* Pointer to FDU*/
+	const struct osdlp_tm_ops   *ops;               /* Queue operations*/
+	void                        *user;              /* Operations context*/
+	struct osdlp_spsc_ring      *tx_ring;           /* Optional TX ring*/
 	struct tm_mission_params    mission;            /* Mission specific parameters*/
+	struct tm_sec_hdr           secondary_hdr;      /* The secondary header struct*/
 };
 
+/* Frame format parameters, constants when fixed by osdlp_config.h */
+#ifdef OSDLP_TM_CRC
+#define TM_CRC_FLAG(tm_tf)          (OSDLP_TM_CRC)
+#else
+#define TM_CRC_FLAG(tm_tf)          ((tm_tf)->mission.crc_present)
+#endif
+
+#ifdef OSDLP_TM_OCF
+#define TM_OCF_FLAG(tm_tf)          (OSDLP_TM_OCF)
+#else
+#define TM_OCF_FLAG(tm_tf)          ((tm_tf)->primary_hdr.ocf)
+#endif
+
+#ifdef OSDLP_TM_STUFFING
+#define TM_STUFF_STATE(tm_tf)       (OSDLP_TM_STUFFING)
+#else
+#define TM_STUFF_STATE(tm_tf)       ((tm_tf)->mission.stuff_state)
+#endif
+
+#ifdef OSDLP_TM_FRAME_LEN
+#define TM_FRAME_SIZE(tm_tf)        (OSDLP_TM_FRAME_LEN)
+#else
+#define TM_FRAME_SIZE(tm_tf)        ((tm_tf)->mission.frame_len)
+#endif
+
 /**
  * Initializes the TM config structure
  * @param spacecraft_id the spacecraft ID
@@ -200,7 +254,7 @@ osdlp_tm_init(struct tm_transfer_frame *tm_tf,
               uint8_t *sec_hdr,
               tm_crc_flag_t crc_flag,
               uint16_t frame_size,
-              uint16_t max_sdu_len,
+              osdlp_sdu_len_t max_sdu_len,
               uint16_t max_vcs,
               uint16_t max_fifo_size,
               tm_stuff_state_t stuffing,
@@ -217,9 +271,40 @@ void
 osdlp_tm_pack(struct tm_transfer_frame *frame_params, uint8_t *pkt_out,
               uint8_t *data_in, uint16_t length);
 
+/**
+ * Assigns the next master and virtual channel frame counts to a frame.
+ * Both counts are taken under a lock of the virtual channel, so threads can
+ * claim frames of the same virtual channel concurrently and pack them with
+ * osdlp_tm_pack_frame() in any order. The frames of a virtual channel get
+ * their master channel counts in the order of their virtual channel counts.
+ * The master channel counter is incremented atomically, as other virtual
+ * channels may share it. osdlp_tm_transmit() takes its counts the same way.
+ * @param tm_tf the TM config struct
+ * @param work the per-frame state to fill
+ * @param first_hdr_ptr the first header pointer of the frame
+ */
+void
+osdlp_tm_claim_frame(struct tm_transfer_frame *tm_tf,
+                     struct tm_frame_work *work, uint16_t first_hdr_ptr);
+
+/**
+ * Packs a TM frame without writing to the TM config struct. The per-frame
+ * fields are taken from the work state instead, so the config can be shared
+ * read-only by several threads.
+ * @param tm_tf the TM config struct
+ * @param work the per-frame state. Its crc field is set on return
+ * @param pkt_out the buffer where the packet will be placed
+ * @param data_in the input data buffer
+ * @param length the length of the data_in buffer
+ */
+void
+osdlp_tm_pack_frame(const struct tm_transfer_frame *tm_tf,
+                    struct tm_frame_work *work, uint8_t *pkt_out,
+                    const uint8_t *data_in, uint16_t length);
+
 /**
  * Unpacks a received buffer and populates the corresponding fields of
- * a TM config structure
+ * a TM config structure, including the shared master channel frame count
  * @param frame_params the TM config struct
  * @param pkt_in the received packet buffer
  */
@@ -228,11 +313,50 @@ osdlp_tm_unpack(struct tm_transfer_frame *frame_params, uint8_t *pkt_in);
 
 int
 osdlp_tm_transmit(struct tm_transfer_frame *tm_tf,
-                  uint8_t *data_in, uint16_t length);
+                  uint8_t *data_in, osdlp_sdu_len_t length);
 
 int
 osdlp_tm_receive(uint8_t *data_in);
 
+/**
+ * Receives a frame on a known virtual channel configuration, bypassing
+ * osdlp_tm_get_rx_config(). Unlike osdlp_tm_receive(), it does not update
+ * the master channel frame count, so different virtual channels can be
+ * received concurrently
+ * @param tm_tf the configuration of the virtual channel
+ * @param data_in the received frame
+ *
+ * @return the negative value of tm_rx_result_t for error, 0 or a positive
+ * tm_rx_result_t otherwise
+ */
+int
+osdlp_tm_rx_frame(struct tm_transfer_frame *tm_tf, uint8_t *data_in);
+
+/**
+ * Checks the FECF of a received frame. The configuration is only read, so
+ * several threads may verify frames of the same virtual channel at once
+ * @param tm_tf the configuration of the virtual channel
+ * @param data_in the received frame
+ *
+ * @return 0 if the frame is intact, -TM_RX_WRONG_CRC otherwise
+ */
+int
+osdlp_tm_rx_verify(const struct tm_transfer_frame *tm_tf,
+                   uint8_t *data_in);
+
+/**
+ * Receives a frame already checked with osdlp_tm_rx_verify(). Frames of a
+ * virtual channel must be passed one at a time and in order. The master
+ * channel frame count is not updated
+ * @param tm_tf the configuration of the virtual channel
+ * @param data_in the received frame
+ *
+ * @return the negative value of tm_rx_result_t for error, 0 or a positive
+ * tm_rx_result_t otherwise
+ */
+int
+osdlp_tm_rx_verified(struct tm_transfer_frame *tm_tf, uint8_t *data_in);
+
 /**
  * Transmits an FDU with idle packets only
  */
@@ -246,13 +370,15 @@ void
 osdlp_abort_segmentation(struct tm_transfer_frame *tm_tf);
 
 /**
- * Disables the stuffing of packets into FDUs
+ * Disables the stuffing of packets into FDUs. Has no effect if
+ * OSDLP_TM_STUFFING is fixed by osdlp_config.h
  */
 void
 osdlp_disable_packet_stuffing(struct tm_transfer_frame *tm_tf);
 
 /**
- * Enables the stuffing of packets into FDUs
+ * Enables the stuffing of packets into FDUs. Has no effect if
+ * OSDLP_TM_STUFFING is fixed by osdlp_config.h
  */
 void
 osdlp_enable_packet_stuffing(struct tm_transfer_frame *tm_tf);
@@ -315,7 +441,7 @@ osdlp_tm_rx_queue_enqueue(uint8_t *, uint8_t);
  */
 __attribute__((weak))
 int
-osdlp_tm_get_packet_len(uint16_t *, uint8_t *, uint16_t);
+osdlp_tm_get_packet_len(osdlp_sdu_len_t *, uint8_t *, osdlp_sdu_len_t);
 
 /**
  * gets the TM config corresponding to the vcid
@@ -0,0 +1,154 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_TRACE_H_
+#define INCLUDE_OSDLP_TRACE_H_
+
+#include <stdint.h>
+
+/**
+ * Event trace of the COP-1 and the TC framing.
+ * Building the library with -DOSDLP_TRACE makes the FOP-1, the FARM-1 and
+ * the TC transmit and receive paths record a fixed size event into the
+ * trace ring of the calling thread, if it has one. Without it the trace
+ * points compile to nothing. The ring functions are always available, so
+ * that tools can decode recorded traces.
+ */
+
+typedef enum {
+	OSDLP_TRACE_FOP     = 1,    /* arg: FOP-1 event, see below*/
+	OSDLP_TRACE_FARM    = 2,    /* arg: farm_result_t*/
+	OSDLP_TRACE_TC_TX   = 3,    /* arg: notification_t of the FDU request*/
+	OSDLP_TRACE_TC_RX   = 4     /* arg: tc_rx_result_t of a rejected frame*/
+} osdlp_trace_id_t;
+
+/**
+ * A trace event. For FOP-1 and TC transmit events the states are FOP-1
+ * states, vs is V(S) and nr is the N(R) of the CLCW or NN(R). For FARM-1
+ * events the states are FARM-1 states, vs is V(R) and nr is N(S).
+ * depth is the number of frames in the sent ring, if one is attached.
+ * FOP-1 events are numbered from 0 in the order E1-E14, E101-E103, E16,
+ * E104, E17, E18.
+ */
+struct osdlp_trace_event {
+	uint64_t    ts;             /* Timestamp*/
+	uint8_t     vcid;
+	uint8_t     id;             /* osdlp_trace_id_t*/
+	uint8_t     arg;
+	uint8_t     before;         /* State before the event*/
+	uint8_t     after;          /* State after the event*/
+	uint8_t     vs;
+	uint8_t     nr;
+	uint8_t     depth;
+};
+
+/**
+ * Single producer ring of trace events. When full, the oldest events are
+ * overwritten.
+ */
+struct osdlp_trace_ring {
+	struct osdlp_trace_event    *events;
+	uint32_t                    mask;       /* Number of events - 1*/
+	uint32_t                    head;       /* Number of recorded events*/
+};
+
+/**
+ * Returns the timestamp of an event. The default implementation returns 0.
+ * On x86 the time stamp counter is used instead, unless OSDLP_TRACE_CLOCK
+ * is defined.
+ */
+__attribute__((weak))
+uint64_t
+osdlp_trace_clock(void);
+
+#ifndef OSDLP_TRACE_CLOCK
+#if defined(__x86_64__) || defined(__i386__)
+#define OSDLP_TRACE_CLOCK()     __builtin_ia32_rdtsc()
+#else
+#define OSDLP_TRACE_CLOCK()     osdlp_trace_clock()
+#endif
+#endif
+
+/* The trace ring of the calling thread, NULL if it does not trace */
+extern __thread struct osdlp_trace_ring *osdlp_trace_current;
+
+/**
+ * Initializes a trace ring
+ * @param ring the ring
+ * @param events the event storage
+ * @param nevents the number of events. Must be a power of 2
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_trace_init(struct osdlp_trace_ring *ring,
+                 struct osdlp_trace_event *events, uint32_t nevents);
+
+/**
+ * Makes the calling thread record its events into a ring. Passing NULL
+ * stops tracing on the thread.
+ * @param ring the ring
+ */
+void
+osdlp_trace_attach(struct osdlp_trace_ring *ring);
+
+/**
+ * Copies the newest recorded events of a ring, oldest first. The ring should
+ * not be written during the copy, otherwise the oldest events may be torn.
+ * @param ring the ring
+ * @param out the buffer that will hold the events
+ * @param max the maximum number of events to copy
+ *
+ * @return the number of copied events
+ */
+uint32_t
+osdlp_trace_snapshot(const struct osdlp_trace_ring *ring,
+                     struct osdlp_trace_event *out, uint32_t max);
+
+#ifdef OSDLP_TRACE
+static inline void
+osdlp_trace_record(uint8_t id, uint8_t vcid, uint8_t arg, uint8_t before,
+                   uint8_t after, uint8_t vs, uint8_t nr, uint8_t depth)
+{
+	struct osdlp_trace_ring *ring = osdlp_trace_current;
+	struct osdlp_trace_event *e;
+	if (!ring) {
+		return;
+	}
+	e = &ring->events[ring->head & ring->mask];
+	e->ts = OSDLP_TRACE_CLOCK();
+	e->vcid = vcid;
+	e->id = id;
+	e->arg = arg;
+	e->before = before;
+	e->after = after;
+	e->vs = vs;
+	e->nr = nr;
+	e->depth = depth;
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+#else
+static inline void
+osdlp_trace_record(uint8_t id, uint8_t vcid, uint8_t arg, uint8_t before,
+                   uint8_t after, uint8_t vs, uint8_t nr, uint8_t depth)
+{
+}
+#endif
+
+#endif /* INCLUDE_OSDLP_TRACE_H_ */
@@ -0,0 +1,74 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_TYPES_H_
+#define INCLUDE_OSDLP_TYPES_H_
+
+#include <stdint.h>
+
+/**
+ * Build time configuration. Building with -DOSDLP_USE_CONFIG includes
+ * osdlp_config.h from the include path. It may define any of the following
+ * to fix a parameter for every virtual channel of the mission, so that the
+ * compiler drops the branches of the other values and folds the offsets
+ * that depend on it. A parameter left undefined is read from the
+ * configuration of the virtual channel at runtime, as in the default build.
+ *
+ * OSDLP_TC_CRC         TC_CRC_PRESENT or TC_CRC_NOTPRESENT
+ * OSDLP_TC_SEG_HDR     TC_SEG_HDR_PRESENT or TC_SEG_HDR_NOTPRESENT
+ * OSDLP_TM_CRC         TM_CRC_PRESENT or TM_CRC_NOTPRESENT
+ * OSDLP_TM_OCF         TM_OCF_PRESENT or TM_OCF_NOTPRESENT
+ * OSDLP_TM_STUFFING    TM_STUFFING_ON or TM_STUFFING_OFF
+ * OSDLP_TM_FRAME_LEN   the TM frame length in octets
+ * OSDLP_MAX_VCS        the size of the per-VC tables, at most 64
+ *
+ * osdlp_tc_init() and osdlp_tm_init() reject a configuration that differs
+ * from the fixed parameters.
+ */
+#ifdef OSDLP_USE_CONFIG
+#include "osdlp_config.h"
+#endif
+
+#ifndef OSDLP_MAX_VCS
+#define OSDLP_MAX_VCS       64
+#endif
+
+/**
+ * The type used for SDU lengths and reassembly offsets.
+ * By default SDUs are limited to 64 KiB. Building with -DOSDLP_LARGE_SDU
+ * switches to 32-bit lengths, so that large files can be handed to the
+ * TC and TM services without chunking them first. Note that the util buffers
+ * must then be able to hold max_sdu_len octets.
+ */
+#ifdef OSDLP_LARGE_SDU
+typedef uint32_t osdlp_sdu_len_t;
+#else
+typedef uint16_t osdlp_sdu_len_t;
+#endif
+
+/* Alignment that keeps fields written by different threads apart*/
+#ifndef OSDLP_CACHE_LINE
+#define OSDLP_CACHE_LINE        64
+#endif
+
+/* Compile time check, usable at file scope of C99 sources */
+#define OSDLP_STATIC_ASSERT(cond, name)                                 \
+	typedef char osdlp_static_assert_##name[(cond) ? 1 : -1]
+
+#endif /* INCLUDE_OSDLP_TYPES_H_ */
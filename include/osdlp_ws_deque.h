@@ -0,0 +1,94 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INCLUDE_OSDLP_WS_DEQUE_H_
+#define INCLUDE_OSDLP_WS_DEQUE_H_
+
+#include <stdint.h>
+#include "osdlp_types.h"
+
+/**
+ * Bounded work-stealing deque (Chase-Lev). The owner thread pushes and pops
+ * work at the bottom, while idle threads steal from the top. The owner only
+ * contends with thieves for the last item, so a pool of threads with one
+ * deque each balances per-frame work without a shared lock.
+ */
+struct osdlp_ws_deque {
+	uint32_t    top __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    bottom __attribute__((aligned(OSDLP_CACHE_LINE)));
+	/* Constant after initialization*/
+	void        **items __attribute__((aligned(OSDLP_CACHE_LINE)));
+	uint32_t    mask;           /* capacity - 1*/
+};
+
+/**
+ * Initializes an empty deque
+ * @param d the deque
+ * @param items memory for capacity pointers
+ * @param capacity the number of items. Must be a power of 2, at least 2
+ *
+ * @return 0 on success, negative value otherwise
+ */
+int
+osdlp_ws_deque_init(struct osdlp_ws_deque *d, void **items,
+                    uint32_t capacity);
+
+/**
+ * Adds an item at the bottom. Owner side
+ * @param d the deque
+ * @param item the item
+ *
+ * @return 0 on success, negative value if the deque is full
+ */
+int
+osdlp_ws_deque_push(struct osdlp_ws_deque *d, void *item);
+
+/**
+ * Removes the most recent item. Owner side
+ * @param d the deque
+ *
+ * @return the item, NULL if the deque is empty
+ */
+void *
+osdlp_ws_deque_pop(struct osdlp_ws_deque *d);
+
+/**
+ * Removes the oldest item. Safe to call from any thread
+ * @param d the deque
+ *
+ * @return the item, NULL if the deque is empty or another thread took the
+ * item first
+ */
+void *
+osdlp_ws_deque_steal(struct osdlp_ws_deque *d);
+
+/**
+ * Takes an item for a thread of a pool: from its own deque first, then
+ * from the deques of the other threads
+ * @param deques the deques of the pool, one per thread
+ * @param n the number of deques
+ * @param self the index of the deque owned by the calling thread
+ *
+ * @return the item, NULL if no work was found
+ */
+void *
+osdlp_ws_deque_take(struct osdlp_ws_deque *deques, uint32_t n,
+                    uint32_t self);
+
+#endif /* INCLUDE_OSDLP_WS_DEQUE_H_ */
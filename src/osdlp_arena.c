@@ -0,0 +1,240 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_arena.h"
+
+int
+osdlp_arena_init(struct osdlp_arena *arena, void *region, size_t size)
+{
+	if (!arena || !region || size == 0) {
+		return -1;
+	}
+	arena->base = region;
+	arena->size = size;
+	arena->used = 0;
+	return 0;
+}
+
+void *
+osdlp_arena_alloc(struct osdlp_arena *arena, size_t size, size_t align)
+{
+	uintptr_t start = (uintptr_t)arena->base + arena->used;
+	size_t pad;
+	if (align == 0 || (align & (align - 1))) {
+		return NULL;
+	}
+	pad = (align - (start & (align - 1))) & (align - 1);
+	if (pad + size > arena->size - arena->used) {
+		return NULL;
+	}
+	arena->used += pad + size;
+	return (void *)(start + pad);
+}
+
+void
+osdlp_arena_reset(struct osdlp_arena *arena)
+{
+	arena->used = 0;
+}
+
+size_t
+osdlp_arena_used(const struct osdlp_arena *arena)
+{
+	return arena->used;
+}
+
+static inline void
+slab_lock(struct osdlp_slab *slab)
+{
+	while (__atomic_test_and_set(&slab->lock, __ATOMIC_ACQUIRE)) {
+		/* Held for a few pointer moves only*/
+	}
+}
+
+static inline void
+slab_unlock(struct osdlp_slab *slab)
+{
+	__atomic_clear(&slab->lock, __ATOMIC_RELEASE);
+}
+
+static inline void *
+slab_pop(struct osdlp_slab *slab)
+{
+	void *obj = slab->free;
+	if (obj) {
+		memcpy(&slab->free, obj, sizeof(void *));
+		slab->available--;
+	}
+	return obj;
+}
+
+static inline void
+slab_push(struct osdlp_slab *slab, void *obj)
+{
+	memcpy(obj, &slab->free, sizeof(void *));
+	slab->free = obj;
+	slab->available++;
+}
+
+int
+osdlp_slab_init(struct osdlp_slab *slab, struct osdlp_arena *arena,
+                uint32_t obj_size, uint32_t nobjs)
+{
+	uint8_t *base;
+	/* Objects hold the free list link and keep its alignment*/
+	if (obj_size < sizeof(void *)) {
+		obj_size = sizeof(void *);
+	}
+	obj_size = (obj_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+	if (nobjs == 0) {
+		return -1;
+	}
+	base = osdlp_arena_alloc(arena, (size_t)obj_size * nobjs,
+	                         OSDLP_CACHE_LINE);
+	if (!base) {
+		return -1;
+	}
+	return osdlp_slab_init_region(slab, base, obj_size, nobjs);
+}
+
+int
+osdlp_slab_init_region(struct osdlp_slab *slab, void *region,
+                       uint32_t obj_size, uint32_t nobjs)
+{
+	uint8_t *base = region;
+	if (!region || obj_size < sizeof(void *) || nobjs == 0) {
+		return -1;
+	}
+	slab->base = base;
+	slab->free = NULL;
+	slab->obj_size = obj_size;
+	slab->nobjs = nobjs;
+	slab->available = 0;
+	slab->lock = 0;
+	for (uint32_t i = nobjs; i > 0; i--) {
+		slab_push(slab, base + (size_t)(i - 1) * obj_size);
+	}
+	return 0;
+}
+
+void *
+osdlp_slab_alloc(struct osdlp_slab *slab)
+{
+	void *obj;
+	slab_lock(slab);
+	obj = slab_pop(slab);
+	slab_unlock(slab);
+	return obj;
+}
+
+void
+osdlp_slab_free(struct osdlp_slab *slab, void *obj)
+{
+	slab_lock(slab);
+	slab_push(slab, obj);
+	slab_unlock(slab);
+}
+
+bool
+osdlp_slab_owns(const struct osdlp_slab *slab, const void *obj)
+{
+	const uint8_t *p = obj;
+	if (p < slab->base
+	    || p >= slab->base + (size_t)slab->obj_size * slab->nobjs) {
+		return false;
+	}
+	return (size_t)(p - slab->base) % slab->obj_size == 0;
+}
+
+void
+osdlp_slab_cache_init(struct osdlp_slab_cache *cache,
+                      struct osdlp_slab *slab)
+{
+	cache->slab = slab;
+	cache->count = 0;
+}
+
+void *
+osdlp_slab_cache_alloc(struct osdlp_slab_cache *cache)
+{
+	struct osdlp_slab *slab = cache->slab;
+	void *obj;
+	if (cache->count == 0) {
+		slab_lock(slab);
+		while (cache->count < SLAB_CACHE_SIZE / 2) {
+			obj = slab_pop(slab);
+			if (!obj) {
+				break;
+			}
+			cache->objs[cache->count++] = obj;
+		}
+		slab_unlock(slab);
+		if (cache->count == 0) {
+			return NULL;
+		}
+	}
+	return cache->objs[--cache->count];
+}
+
+void
+osdlp_slab_cache_free(struct osdlp_slab_cache *cache, void *obj)
+{
+	struct osdlp_slab *slab = cache->slab;
+	if (cache->count == SLAB_CACHE_SIZE) {
+		slab_lock(slab);
+		while (cache->count > SLAB_CACHE_SIZE / 2) {
+			slab_push(slab, cache->objs[--cache->count]);
+		}
+		slab_unlock(slab);
+	}
+	cache->objs[cache->count++] = obj;
+}
+
+void
+osdlp_slab_cache_drain(struct osdlp_slab_cache *cache)
+{
+	struct osdlp_slab *slab = cache->slab;
+	slab_lock(slab);
+	while (cache->count > 0) {
+		slab_push(slab, cache->objs[--cache->count]);
+	}
+	slab_unlock(slab);
+}
+
+int
+osdlp_frame_slabs_init(struct osdlp_frame_slabs *slabs,
+                       struct osdlp_arena *arena, uint16_t tc_frame_len,
+                       uint16_t tm_frame_len, uint32_t sdu_len,
+                       uint32_t nframes)
+{
+	int ret;
+	ret = osdlp_slab_init(&slabs->cls[OSDLP_CLASS_TC_FRAME], arena,
+	                      tc_frame_len, nframes);
+	if (ret < 0) {
+		return ret;
+	}
+	ret = osdlp_slab_init(&slabs->cls[OSDLP_CLASS_TM_FRAME], arena,
+	                      tm_frame_len, nframes);
+	if (ret < 0) {
+		return ret;
+	}
+	return osdlp_slab_init(&slabs->cls[OSDLP_CLASS_SDU], arena, sdu_len,
+	                       nframes);
+}
@@ -0,0 +1,201 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_cltu.h"
+#include "osdlp_tc.h"
+
+static const uint8_t start_seq[CLTU_START_SEQ_LEN] = {0xeb, 0x90};
+
+static const uint8_t tail_seq[CLTU_TAIL_SEQ_LEN] = {
+	0xc5, 0xc5, 0xc5, 0xc5, 0xc5, 0xc5, 0xc5, 0x79
+};
+
+/*
+ * BCH(63,56) remainder table for g(x) = x^7 + x^6 + x^2 + 1.
+ * The 7-bit remainder is kept left aligned in an octet, so that the
+ * parity of a code block is computed one octet at a time.
+ */
+static const uint8_t bch_table[256] = {
+	0x00, 0x8a, 0x9e, 0x14, 0xb6, 0x3c, 0x28, 0xa2,
+	0xe6, 0x6c, 0x78, 0xf2, 0x50, 0xda, 0xce, 0x44,
+	0x46, 0xcc, 0xd8, 0x52, 0xf0, 0x7a, 0x6e, 0xe4,
+	0xa0, 0x2a, 0x3e, 0xb4, 0x16, 0x9c, 0x88, 0x02,
+	0x8c, 0x06, 0x12, 0x98, 0x3a, 0xb0, 0xa4, 0x2e,
+	0x6a, 0xe0, 0xf4, 0x7e, 0xdc, 0x56, 0x42, 0xc8,
+	0xca, 0x40, 0x54, 0xde, 0x7c, 0xf6, 0xe2, 0x68,
+	0x2c, 0xa6, 0xb2, 0x38, 0x9a, 0x10, 0x04, 0x8e,
+	0x92, 0x18, 0x0c, 0x86, 0x24, 0xae, 0xba, 0x30,
+	0x74, 0xfe, 0xea, 0x60, 0xc2, 0x48, 0x5c, 0xd6,
+	0xd4, 0x5e, 0x4a, 0xc0, 0x62, 0xe8, 0xfc, 0x76,
+	0x32, 0xb8, 0xac, 0x26, 0x84, 0x0e, 0x1a, 0x90,
+	0x1e, 0x94, 0x80, 0x0a, 0xa8, 0x22, 0x36, 0xbc,
+	0xf8, 0x72, 0x66, 0xec, 0x4e, 0xc4, 0xd0, 0x5a,
+	0x58, 0xd2, 0xc6, 0x4c, 0xee, 0x64, 0x70, 0xfa,
+	0xbe, 0x34, 0x20, 0xaa, 0x08, 0x82, 0x96, 0x1c,
+	0xae, 0x24, 0x30, 0xba, 0x18, 0x92, 0x86, 0x0c,
+	0x48, 0xc2, 0xd6, 0x5c, 0xfe, 0x74, 0x60, 0xea,
+	0xe8, 0x62, 0x76, 0xfc, 0x5e, 0xd4, 0xc0, 0x4a,
+	0x0e, 0x84, 0x90, 0x1a, 0xb8, 0x32, 0x26, 0xac,
+	0x22, 0xa8, 0xbc, 0x36, 0x94, 0x1e, 0x0a, 0x80,
+	0xc4, 0x4e, 0x5a, 0xd0, 0x72, 0xf8, 0xec, 0x66,
+	0x64, 0xee, 0xfa, 0x70, 0xd2, 0x58, 0x4c, 0xc6,
+	0x82, 0x08, 0x1c, 0x96, 0x34, 0xbe, 0xaa, 0x20,
+	0x3c, 0xb6, 0xa2, 0x28, 0x8a, 0x00, 0x14, 0x9e,
+	0xda, 0x50, 0x44, 0xce, 0x6c, 0xe6, 0xf2, 0x78,
+	0x7a, 0xf0, 0xe4, 0x6e, 0xcc, 0x46, 0x52, 0xd8,
+	0x9c, 0x16, 0x02, 0x88, 0x2a, 0xa0, 0xb4, 0x3e,
+	0xb0, 0x3a, 0x2e, 0xa4, 0x06, 0x8c, 0x98, 0x12,
+	0x56, 0xdc, 0xc8, 0x42, 0xe0, 0x6a, 0x7e, 0xf4,
+	0xf6, 0x7c, 0x68, 0xe2, 0x40, 0xca, 0xde, 0x54,
+	0x10, 0x9a, 0x8e, 0x04, 0xa6, 0x2c, 0x38, 0xb2
+};
+
+/*
+ * Maps the syndrome of a code block to the position of the erroneous bit.
+ * Positions 0-55 are the information bits in transmission order, 56-62
+ * the parity bits. 0xff marks syndromes of uncorrectable errors.
+ */
+static const uint8_t bch_syndrome_table[128] = {
+	0xff, 0x3e, 0x3d, 0xff, 0x3c, 0xff, 0xff, 0x24,
+	0x3b, 0xff, 0xff, 0x1b, 0xff, 0x0e, 0x23, 0xff,
+	0x3a, 0xff, 0xff, 0x2e, 0xff, 0x0a, 0x1a, 0xff,
+	0xff, 0x11, 0x0d, 0xff, 0x22, 0xff, 0xff, 0x06,
+	0x39, 0xff, 0xff, 0x33, 0xff, 0x1f, 0x2d, 0xff,
+	0xff, 0x27, 0x09, 0xff, 0x19, 0xff, 0xff, 0x16,
+	0xff, 0x01, 0x10, 0xff, 0x0c, 0xff, 0xff, 0x13,
+	0x21, 0xff, 0xff, 0x29, 0xff, 0x03, 0x05, 0xff,
+	0x38, 0xff, 0xff, 0xff, 0xff, 0x37, 0x32, 0xff,
+	0xff, 0x31, 0x1e, 0xff, 0x2c, 0xff, 0xff, 0x36,
+	0xff, 0x1d, 0x26, 0xff, 0x08, 0xff, 0xff, 0x30,
+	0x18, 0xff, 0xff, 0x35, 0xff, 0x2b, 0x15, 0xff,
+	0xff, 0x25, 0x00, 0xff, 0x0f, 0xff, 0xff, 0x1c,
+	0x0b, 0xff, 0xff, 0x2f, 0xff, 0x07, 0x12, 0xff,
+	0x20, 0xff, 0xff, 0x34, 0xff, 0x17, 0x28, 0xff,
+	0xff, 0x14, 0x02, 0xff, 0x04, 0xff, 0xff, 0x2a
+};
+
+static inline uint8_t
+bch_parity(const uint8_t *info)
+{
+	uint8_t r = 0;
+	for (int i = 0; i < CLTU_INFO_LEN; i++) {
+		r = bch_table[r ^ info[i]];
+	}
+	/* Parity bits are complemented, the filler bit is zero */
+	return ~r & 0xfe;
+}
+
+uint32_t
+osdlp_cltu_len(uint32_t length)
+{
+	uint32_t nblocks = (length + CLTU_INFO_LEN - 1) / CLTU_INFO_LEN;
+	return CLTU_START_SEQ_LEN + nblocks * CLTU_BLOCK_LEN
+	       + CLTU_TAIL_SEQ_LEN;
+}
+
+int
+osdlp_cltu_encode(uint8_t *cltu_out, uint32_t max_len, const uint8_t *frame,
+                  uint32_t length)
+{
+	uint32_t cltu_len = osdlp_cltu_len(length);
+	uint8_t *block;
+	if (length == 0 || cltu_len > max_len) {
+		return -CLTU_LEN_ERR;
+	}
+	memcpy(cltu_out, start_seq, CLTU_START_SEQ_LEN);
+	block = cltu_out + CLTU_START_SEQ_LEN;
+	while (length >= CLTU_INFO_LEN) {
+		memcpy(block, frame, CLTU_INFO_LEN);
+		block[CLTU_INFO_LEN] = bch_parity(block);
+		block += CLTU_BLOCK_LEN;
+		frame += CLTU_INFO_LEN;
+		length -= CLTU_INFO_LEN;
+	}
+	if (length > 0) {
+		memcpy(block, frame, length);
+		memset(block + length, CLTU_FILL_BYTE, CLTU_INFO_LEN - length);
+		block[CLTU_INFO_LEN] = bch_parity(block);
+		block += CLTU_BLOCK_LEN;
+	}
+	memcpy(block, tail_seq, CLTU_TAIL_SEQ_LEN);
+	return cltu_len;
+}
+
+int
+osdlp_cltu_decode(uint8_t *frame_out, uint32_t max_len, const uint8_t *cltu,
+                  uint32_t length, uint32_t *corrected)
+{
+	uint32_t i = 0;
+	uint32_t decoded = 0;
+	uint8_t syndrome;
+	uint8_t pos;
+	if (corrected) {
+		*corrected = 0;
+	}
+	/* Search for the start sequence */
+	while (i + CLTU_START_SEQ_LEN <= length
+	       && (cltu[i] != start_seq[0] || cltu[i + 1] != start_seq[1])) {
+		i++;
+	}
+	if (i + CLTU_START_SEQ_LEN > length) {
+		return -CLTU_NO_START_SEQ;
+	}
+	i += CLTU_START_SEQ_LEN;
+
+	for (; i + CLTU_BLOCK_LEN <= length; i += CLTU_BLOCK_LEN) {
+		syndrome = bch_parity(&cltu[i]) ^ cltu[i + CLTU_INFO_LEN];
+		syndrome >>= 1;
+		if (syndrome) {
+			pos = bch_syndrome_table[syndrome];
+			if (pos == 0xff) {
+				/* The tail sequence or a corrupted block */
+				break;
+			}
+			if (corrected) {
+				(*corrected)++;
+			}
+		} else {
+			pos = 0xff;
+		}
+		if (decoded + CLTU_INFO_LEN > max_len) {
+			return -CLTU_LEN_ERR;
+		}
+		memcpy(&frame_out[decoded], &cltu[i], CLTU_INFO_LEN);
+		if (pos < CLTU_INFO_LEN * 8) {
+			frame_out[decoded + pos / 8] ^= 0x80 >> (pos % 8);
+		}
+		decoded += CLTU_INFO_LEN;
+	}
+	if (decoded == 0) {
+		return -CLTU_UNCORRECTABLE;
+	}
+	return decoded;
+}
+
+int
+osdlp_cltu_receive(const uint8_t *cltu, uint32_t length, uint8_t *util,
+                   uint32_t util_len)
+{
+	int ret = osdlp_cltu_decode(util, util_len, cltu, length, NULL);
+	if (ret < 0) {
+		return -TC_RX_FRAME_VAL_ERR;
+	}
+	return osdlp_tc_receive(util, ret);
+}
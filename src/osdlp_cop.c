@@ -18,8 +18,212 @@
  */
 
 #include "osdlp_cop.h"
+#include "osdlp_cop_priv.h"
 #include "osdlp.h"
 
+/*
+ * Frame buffers. With a frame pool attached every packed frame gets its own
+ * reference counted buffer, otherwise the util buffer is reused.
+ */
+static uint8_t *
+frame_alloc(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->frame_pool) {
+		return osdlp_frame_pool_alloc(tc_tf->frame_pool);
+	}
+	return tc_tf->mission.util.buffer;
+}
+
+static inline void
+frame_put(struct tc_transfer_frame *tc_tf, uint8_t *fdu)
+{
+	osdlp_tc_tx_done(tc_tf, fdu);
+}
+
+static inline uint16_t
+fdu_len(const uint8_t *fdu)
+{
+	return (((fdu[2] & 0x03) << 8) | fdu[3]) + 1;
+}
+
+/*
+ * Passes a frame to the lower layers, handing over one reference to it.
+ * The reference is dropped here if the frame is not accepted. A shared
+ * queue keeps a copy of the frame, so the reference is dropped right away.
+ */
+static int
+tx_queue_enqueue(struct tc_transfer_frame *tc_tf, uint8_t *fdu)
+{
+	int ret;
+	if (tc_tf->uplink) {
+		ret = osdlp_mpmc_queue_enqueue(tc_tf->uplink, fdu, fdu_len(fdu),
+		                               tc_tf->primary_hdr.vcid);
+		frame_put(tc_tf, fdu);
+		return ret;
+	}
+	ret = tc_tf->ops->tx_queue_enqueue(tc_tf->user, fdu,
+	                                   tc_tf->primary_hdr.vcid);
+	if (ret < 0) {
+		frame_put(tc_tf, fdu);
+	}
+	return ret;
+}
+
+/* Retransmits a frame of the sent queue */
+static int
+tx_queue_retransmit(struct tc_transfer_frame *tc_tf, uint8_t *fdu)
+{
+	struct tc_frame_pool *pool = tc_tf->frame_pool;
+	if (pool && osdlp_frame_pool_owns(pool, fdu)) {
+		osdlp_frame_pool_ref(pool, fdu);
+	}
+	return tx_queue_enqueue(tc_tf, fdu);
+}
+
+/*
+ * Sent queue accessors. If a sent ring is attached to the virtual channel the
+ * library keeps the sent frames itself, otherwise the callbacks are used.
+ */
+static bool
+sent_queue_empty(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_empty(tc_tf->sent_ring);
+	}
+	return tc_tf->ops->sent_queue_empty(tc_tf->user,
+	                                    tc_tf->primary_hdr.vcid);
+}
+
+/*
+ * Starts T1 on the timer wheel of the virtual channel, if one is attached,
+ * otherwise through the timer callbacks
+ */
+static int
+timer_start(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->timer_wheel) {
+		osdlp_timer_wheel_start(tc_tf->timer_wheel, tc_tf->timer,
+		                        tc_tf->cop_cfg.fop.t1_init);
+		return 0;
+	}
+	return tc_tf->ops->timer_start(tc_tf->user, tc_tf->primary_hdr.vcid);
+}
+
+static int
+timer_cancel(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->timer_wheel) {
+		osdlp_timer_wheel_cancel(tc_tf->timer_wheel, tc_tf->timer);
+		return 0;
+	}
+	return tc_tf->ops->timer_cancel(tc_tf->user, tc_tf->primary_hdr.vcid);
+}
+
+static int
+sent_queue_enqueue(struct tc_transfer_frame *tc_tf, struct queue_item *item)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_enqueue(tc_tf->sent_ring, item);
+	}
+	return tc_tf->ops->sent_queue_enqueue(tc_tf->user, item,
+	                                      tc_tf->primary_hdr.vcid);
+}
+
+static int
+sent_queue_head(struct tc_transfer_frame *tc_tf, struct queue_item *item)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_head(tc_tf->sent_ring, item);
+	}
+	return tc_tf->ops->sent_queue_head(tc_tf->user, item,
+	                                   tc_tf->primary_hdr.vcid);
+}
+
+static int
+sent_queue_dequeue(struct tc_transfer_frame *tc_tf, struct queue_item *item)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_dequeue(tc_tf->sent_ring);
+	}
+	return tc_tf->ops->sent_queue_dequeue(tc_tf->user, item,
+	                                      tc_tf->primary_hdr.vcid);
+}
+
+static int
+sent_queue_clear(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->sent_ring) {
+		osdlp_sent_ring_clear(tc_tf->sent_ring);
+		return 0;
+	}
+	return tc_tf->ops->sent_queue_clear(tc_tf->user,
+	                                    tc_tf->primary_hdr.vcid);
+}
+
+static int
+mark_ad_as_rt(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->sent_ring) {
+		osdlp_sent_ring_mark_ad_as_rt(tc_tf->sent_ring);
+		return 0;
+	}
+	return tc_tf->ops->mark_ad_as_rt(tc_tf->user, tc_tf->primary_hdr.vcid);
+}
+
+static int
+mark_bc_as_rt(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_mark_bc_as_rt(tc_tf->sent_ring);
+	}
+	return tc_tf->ops->mark_bc_as_rt(tc_tf->user, tc_tf->primary_hdr.vcid);
+}
+
+static int
+get_first_ad_rt_frame(struct tc_transfer_frame *tc_tf, struct queue_item *item)
+{
+	if (tc_tf->sent_ring) {
+		return osdlp_sent_ring_first_ad_rt(tc_tf->sent_ring, item);
+	}
+	return tc_tf->ops->get_first_ad_rt_frame(tc_tf->user, item,
+	                                         tc_tf->primary_hdr.vcid);
+}
+
+static int
+reset_rt_frame(struct tc_transfer_frame *tc_tf, struct queue_item *item)
+{
+	if (tc_tf->sent_ring) {
+		osdlp_sent_ring_reset_rt(tc_tf->sent_ring, item);
+		return 0;
+	}
+	return tc_tf->ops->reset_rt_frame(tc_tf->user, item,
+	                                  tc_tf->primary_hdr.vcid);
+}
+
+/* The number of sent frames, as far as the library knows */
+static inline uint8_t
+trace_depth(struct tc_transfer_frame *tc_tf)
+{
+	struct tc_sent_ring *ring = tc_tf->sent_ring;
+	if (ring) {
+		return ring->count > 255 ? 255 : ring->count;
+	}
+	return 0;
+}
+
+/* Queues the frame data of the context for Type-AD transmission */
+static int
+wait_queue_enqueue(struct tc_transfer_frame *tc_tf)
+{
+	struct tc_wait_desc desc;
+	desc.data = tc_tf->frame_data.data;
+	desc.data_len = tc_tf->frame_data.data_len;
+	desc.map_id = tc_tf->frame_data.seg_hdr.map_id;
+	desc.seq_flag = tc_tf->frame_data.seg_hdr.seq_flag;
+	return tc_tf->ops->wait_queue_enqueue(tc_tf->user, &desc,
+	                                      tc_tf->primary_hdr.vcid);
+}
+
 void
 osdlp_prepare_fop(struct fop_config *fop, uint16_t slide_wnd, fop_state_t state,
                   uint16_t t1_init, uint8_t timeout_type, uint8_t tx_lim)
@@ -34,6 +238,8 @@ osdlp_prepare_fop(struct fop_config *fop, uint16_t slide_wnd, fop_state_t state,
 	fop->tx_lim = tx_lim;
 	fop->vs = 0;
 	fop->signal = IGNORE;
+	fop->memo_valid = 0;
+	fop->rt_burst = 0;
 }
 
 void
@@ -223,67 +429,61 @@ farm_e8(struct tc_transfer_frame *tc_tf)
 	}
 }
 
-static bool
-condition_farm_e3(struct tc_transfer_frame *tc_tf)
+/**
+ * Classifies a Type-AD frame against the FARM-1 sliding window. The offset
+ * of N(S) from V(R) modulo 256 is computed once and compared against the
+ * positive and negative window widths, so that wrap around needs no special
+ * handling
+ */
+static inline uint8_t
+farm_window_event(const struct farm_config *farm, uint8_t ns)
 {
-	return ((tc_tf->primary_hdr.frame_seq_num > tc_tf->cop_cfg.farm.vr)
-	        && (tc_tf->primary_hdr.frame_seq_num
-	            <= tc_tf->cop_cfg.farm.vr + tc_tf->cop_cfg.farm.pw - 1))
-	       ||
-	       ((tc_tf->cop_cfg.farm.vr > ((tc_tf->cop_cfg.farm.vr + tc_tf->cop_cfg.farm.pw -
-	                                    1) % 256))
-	        && (tc_tf->primary_hdr.frame_seq_num < tc_tf->cop_cfg.farm.vr) &&
-	        (tc_tf->primary_hdr.frame_seq_num < ((tc_tf->cop_cfg.farm.vr +
-	                        tc_tf->cop_cfg.farm.pw - 1) % 256)));
+	uint8_t d = ns - farm->vr;
+	if (d == 0) {
+		return 1;
+	}
+	if (d < farm->pw) {
+		return 3;
+	}
+	if (d >= 256 - farm->nw) {
+		return 4;
+	}
+	return 5;
 }
 
-static bool
-condition_farm_e4(struct tc_transfer_frame *tc_tf)
+static inline bool
+rx_queue_full(struct tc_transfer_frame *tc_tf)
 {
-	return ((tc_tf->primary_hdr.frame_seq_num < tc_tf->cop_cfg.farm.vr)
-	        && (tc_tf->primary_hdr.frame_seq_num
-	            >= tc_tf->cop_cfg.farm.vr - tc_tf->cop_cfg.farm.nw))
-	       || ((((tc_tf->primary_hdr.frame_seq_num + tc_tf->cop_cfg.farm.pw) % 256) >=
-	            tc_tf->cop_cfg.farm.vr)
-	           && (((tc_tf->primary_hdr.frame_seq_num + tc_tf->cop_cfg.farm.pw) % 256) <
-	               (tc_tf->cop_cfg.farm.vr + tc_tf->cop_cfg.farm.pw - 1)));
+	if (tc_tf->rx_ring) {
+		return osdlp_spsc_ring_full(tc_tf->rx_ring);
+	}
+	return tc_tf->ops->rx_queue_full(tc_tf->user, tc_tf->primary_hdr.vcid);
 }
 
 static farm_result_t
 handle_farm_typea(struct tc_transfer_frame *tc_tf)
 {
-	farm_result_t ret;
-	if (tc_tf->primary_hdr.frame_seq_num == tc_tf->cop_cfg.farm.vr) {
-		/*E1*/
-		if (!osdlp_tc_rx_queue_full(tc_tf->primary_hdr.vcid)) {
-			ret = farm_e1(tc_tf);
-			return ret;
-		}
-		/*E2*/
-		else {
-			ret = farm_e2(tc_tf);
-			return ret;
-		}
-	}
-	/*E3*/
-	else if (condition_farm_e3(tc_tf)) {
-		ret = farm_e3(tc_tf);
-		return ret;
-	}
-	/*E4*/
-	else if (condition_farm_e4(tc_tf)) {
-		ret = farm_e4(tc_tf);
-		return ret;
-	}
-	/*E5*/
-	else {
-		ret = farm_e5(tc_tf);
-		return ret;
+	switch (farm_window_event(&tc_tf->cop_cfg.farm,
+	                          tc_tf->primary_hdr.frame_seq_num)) {
+		case 1:
+			/*E1*/
+			if (!rx_queue_full(tc_tf)) {
+				return farm_e1(tc_tf);
+			}
+			/*E2*/
+			return farm_e2(tc_tf);
+		case 3:
+			/*E3*/
+			return farm_e3(tc_tf);
+		case 4:
+			/*E4*/
+			return farm_e4(tc_tf);
+		default:
+			/*E5*/
+			return farm_e5(tc_tf);
 	}
 }
 
-
-
 static farm_result_t
 handle_farm_typeb_cmd(struct tc_transfer_frame *tc_tf)
 {
@@ -311,8 +511,8 @@ handle_farm_typeb_data(struct tc_transfer_frame *tc_tf)
 	return ret;
 }
 
-farm_result_t
-osdlp_farm_1(struct tc_transfer_frame *tc_tf)
+static farm_result_t
+farm_execute(struct tc_transfer_frame *tc_tf)
 {
 	farm_result_t ret;
 	if (tc_tf->primary_hdr.bypass == TYPE_A) {
@@ -335,6 +535,18 @@ osdlp_farm_1(struct tc_transfer_frame *tc_tf)
 	return COP_ERROR;
 }
 
+farm_result_t
+osdlp_farm_1(struct tc_transfer_frame *tc_tf)
+{
+	struct farm_config *farm = &tc_tf->cop_cfg.farm;
+	uint8_t before = farm->state;
+	farm_result_t ret = farm_execute(tc_tf);
+	osdlp_trace_record(OSDLP_TRACE_FARM, tc_tf->primary_hdr.vcid, ret,
+	                   before, farm->state, farm->vr,
+	                   tc_tf->primary_hdr.frame_seq_num, 0);
+	return ret;
+}
+
 int
 osdlp_initialize_cop(struct tc_transfer_frame *tc_tf)
 {
@@ -356,7 +568,7 @@ int
 osdlp_alert(struct tc_transfer_frame *tc_tf)
 {
 	int ret;
-	ret = osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
+	ret = timer_cancel(tc_tf);
 	if (ret < 0) {
 		return -1;
 	}
@@ -369,14 +581,14 @@ osdlp_alert(struct tc_transfer_frame *tc_tf)
 		return -1;
 	}
 	// Return negative confirm directive
-	tc_tf->cop_cfg.fop.signal = NEGATIVE_TX;
+	fop_signal(tc_tf, NEGATIVE_TX);
 	return 0;
 }
 
 int
 osdlp_resume(struct tc_transfer_frame *tc_tf)
 {
-	int ret = osdlp_timer_start(tc_tf->primary_hdr.vcid);
+	int ret = timer_start(tc_tf);
 	if (ret < 0) {
 		return -1;
 	}
@@ -396,35 +608,36 @@ notification_t
 osdlp_look_for_fdu(struct tc_transfer_frame *tc_tf)
 {
 	int ret;
-	if (!osdlp_tc_sent_queue_empty(tc_tf->primary_hdr.vcid)) {
+	if (!sent_queue_empty(tc_tf)) {
 		struct queue_item item;
-		ret = osdlp_get_first_ad_rt_frame(&item, tc_tf->primary_hdr.vcid);
+		ret = get_first_ad_rt_frame(tc_tf, &item);
 		if (ret >= 0) {
-			ret = osdlp_reset_rt_frame(&item, tc_tf->primary_hdr.vcid);
+			ret = reset_rt_frame(tc_tf, &item);
 			if (ret < 0) {
 				return UNDEF_ERROR;
 			}
-			ret = osdlp_tc_tx_queue_enqueue(item.fdu, tc_tf->primary_hdr.vcid);
+			ret = tx_queue_retransmit(tc_tf, item.fdu);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 		}
 	}
 	/*Perform checks in case window wraps around*/
 
-	if (!osdlp_tc_wait_queue_empty(tc_tf->primary_hdr.vcid)) {
+	if (!tc_tf->ops->wait_queue_empty(tc_tf->user,
+	                                  tc_tf->primary_hdr.vcid)) {
 		if (tc_tf->cop_cfg.fop.nnr + tc_tf->cop_cfg.fop.slide_wnd >= 256) {
 			if (condition_fop_inwindow(tc_tf)) {
 				ret = osdlp_transmit_type_ad(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = DELAY_RESP;
+				fop_signal(tc_tf, DELAY_RESP);
 				return DELAY_RESP;
 			}
 		} else {
@@ -432,43 +645,66 @@ osdlp_look_for_fdu(struct tc_transfer_frame *tc_tf)
 			    < tc_tf->cop_cfg.fop.nnr + tc_tf->cop_cfg.fop.slide_wnd) {
 				ret = osdlp_transmit_type_ad(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = DELAY_RESP;
+				fop_signal(tc_tf, DELAY_RESP);
 				return DELAY_RESP;
 			}
 		}
 	} else {
 		return IGNORE;
 	}
-	tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+	fop_signal(tc_tf, UNDEF_ERROR);
 	return UNDEF_ERROR; // Should not get here
 }
 
+int
+osdlp_retransmit_ad_frames(struct tc_transfer_frame *tc_tf)
+{
+	struct queue_item item;
+	int n = 0;
+	/*
+	 * The flag is reset before the frame is handed over, so that a lower
+	 * layer calling back into the FOP-1 does not send it a second time.
+	 * Accepts of the lower layer are ignored until the burst is over, so
+	 * that no new frame is sent between the retransmitted ones
+	 */
+	tc_tf->cop_cfg.fop.rt_burst = 1;
+	while (get_first_ad_rt_frame(tc_tf, &item) >= 0) {
+		if (reset_rt_frame(tc_tf, &item) < 0
+		    || tx_queue_retransmit(tc_tf, item.fdu) < 0) {
+			tc_tf->cop_cfg.fop.rt_burst = 0;
+			return -1;
+		}
+		n++;
+	}
+	tc_tf->cop_cfg.fop.rt_burst = 0;
+	return n;
+}
+
 notification_t
 osdlp_look_for_directive(struct tc_transfer_frame *tc_tf)
 {
 	notification_t notif;
 	int ret;
 	struct queue_item item;
-	ret = osdlp_tc_sent_queue_head(&item,
-	                               tc_tf->primary_hdr.vcid);
+	ret = sent_queue_head(tc_tf, &item);
 	if (ret < 0) {
-		tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+		fop_signal(tc_tf, UNDEF_ERROR);
 		return UNDEF_ERROR;
 	}
 	if (item.rt_flag == RT_FLAG_ON && item.type == TYPE_B) {
 		item.rt_flag = RT_FLAG_OFF;
-		ret = osdlp_tc_tx_queue_enqueue(item.fdu, tc_tf->primary_hdr.vcid);
+		ret = tx_queue_retransmit(tc_tf, item.fdu);
 		if (ret < 0) {
 			notif = osdlp_bc_reject(tc_tf);
 			return notif;
 		} else {
-			ret = osdlp_reset_rt_frame(&item, tc_tf->primary_hdr.vcid);
+			ret = reset_rt_frame(tc_tf, &item);
 			if (ret < 0) {
 				return UNDEF_ERROR;
 			}
@@ -483,30 +719,40 @@ int
 osdlp_transmit_type_ad(struct tc_transfer_frame *tc_tf)
 {
 	struct queue_item item;
-	struct tc_transfer_frame wait_item;
-	int ret = osdlp_tc_wait_queue_dequeue(&wait_item, tc_tf->primary_hdr.vcid);
+	struct tc_wait_desc wait_item;
+	struct tc_seg_hdr seg_hdr = tc_tf->frame_data.seg_hdr;
+	uint8_t *fdu = frame_alloc(tc_tf);
+	int ret;
+	if (!fdu) {
+		return -1;
+	}
+	ret = tc_tf->ops->wait_queue_dequeue(tc_tf->user, &wait_item,
+	                                     tc_tf->primary_hdr.vcid);
 
-	osdlp_tc_pack(tc_tf, tc_tf->mission.util.buffer, wait_item.frame_data.data,
-	              wait_item.frame_data.data_len);
+	/* Pack with the segment header the frame data were queued with */
+	tc_tf->frame_data.seg_hdr.map_id = wait_item.map_id;
+	tc_tf->frame_data.seg_hdr.seq_flag = wait_item.seq_flag;
+	osdlp_tc_pack(tc_tf, fdu, wait_item.data, wait_item.data_len);
+	tc_tf->frame_data.seg_hdr = seg_hdr;
 
-	if (osdlp_tc_sent_queue_empty(tc_tf->primary_hdr.vcid)) {
+	if (sent_queue_empty(tc_tf)) {
 		tc_tf->cop_cfg.fop.tx_cnt = 1;
 	}
-	osdlp_timer_start(tc_tf->primary_hdr.vcid);
+	timer_start(tc_tf);
 
 	item.type = TYPE_A;
-	item.fdu = tc_tf->mission.util.buffer;
+	item.fdu = fdu;
 	item.rt_flag = RT_FLAG_OFF;
 	item.seq_num = tc_tf->cop_cfg.fop.vs;
-	ret = osdlp_tc_sent_queue_enqueue(&item, tc_tf->primary_hdr.vcid);
+	ret = sent_queue_enqueue(tc_tf, &item);
 	tc_tf->cop_cfg.fop.vs = (tc_tf->cop_cfg.fop.vs + 1) % 256;
 
 	if (ret < 0) {
+		frame_put(tc_tf, fdu);
 		return -1;
 	}
 
-	ret = osdlp_tc_tx_queue_enqueue(tc_tf->mission.util.buffer,
-	                                tc_tf->primary_hdr.vcid);
+	ret = tx_queue_enqueue(tc_tf, fdu);
 	if (ret < 0) {
 		return -1;
 	}
@@ -518,23 +764,27 @@ osdlp_transmit_type_bc(struct tc_transfer_frame *tc_tf)
 {
 	struct queue_item item;
 	int ret;
-	osdlp_tc_pack(tc_tf, tc_tf->mission.util.buffer, tc_tf->frame_data.data,
+	uint8_t *fdu = frame_alloc(tc_tf);
+	if (!fdu) {
+		return -1;
+	}
+	osdlp_tc_pack(tc_tf, fdu, tc_tf->frame_data.data,
 	              tc_tf->frame_data.data_len);
 	tc_tf->cop_cfg.fop.tx_cnt = 1;
-	tc_tf->primary_hdr.frame_len = tc_tf->mission.fixed_overhead_len +
+	tc_tf->primary_hdr.frame_len = TC_OVERHEAD_LEN(tc_tf) +
 	                               tc_tf->frame_data.data_len - 1;
-	osdlp_timer_start(tc_tf->primary_hdr.vcid);
+	timer_start(tc_tf);
 	item.type = TYPE_B;
-	item.fdu = tc_tf->mission.util.buffer;
+	item.fdu = fdu;
 	item.rt_flag = RT_FLAG_OFF;
 	item.seq_num = tc_tf->cop_cfg.fop.vs;
-	ret = osdlp_tc_sent_queue_enqueue(&item, tc_tf->primary_hdr.vcid);
+	ret = sent_queue_enqueue(tc_tf, &item);
 	if (ret < 0) {
+		frame_put(tc_tf, fdu);
 		return -1;
 	}
 
-	ret = osdlp_tc_tx_queue_enqueue(tc_tf->mission.util.buffer,
-	                                tc_tf->primary_hdr.vcid);
+	ret = tx_queue_enqueue(tc_tf, fdu);
 	if (ret < 0) {
 		return -1;
 	}
@@ -545,13 +795,16 @@ int
 osdlp_transmit_type_bd(struct tc_transfer_frame *tc_tf)
 {
 	int ret;
-	osdlp_tc_pack(tc_tf, tc_tf->mission.util.buffer, tc_tf->frame_data.data,
+	uint8_t *fdu = frame_alloc(tc_tf);
+	if (!fdu) {
+		return -1;
+	}
+	osdlp_tc_pack(tc_tf, fdu, tc_tf->frame_data.data,
 	              tc_tf->frame_data.data_len);
 	//Set BD_Out not ready
-	tc_tf->primary_hdr.frame_len = tc_tf->mission.fixed_overhead_len +
+	tc_tf->primary_hdr.frame_len = TC_OVERHEAD_LEN(tc_tf) +
 	                               tc_tf->frame_data.data_len - 1;
-	ret = osdlp_tc_tx_queue_enqueue(tc_tf->mission.util.buffer,
-	                                tc_tf->primary_hdr.vcid);
+	ret = tx_queue_enqueue(tc_tf, fdu);
 	if (ret < 0) {
 		return -1;
 	}
@@ -560,1315 +813,525 @@ osdlp_transmit_type_bd(struct tc_transfer_frame *tc_tf)
 
 int
 osdlp_initiate_ad_retransmission(struct tc_transfer_frame *tc_tf)
-{
-	int ret;
-	osdlp_cancel_lower_ops();
-	tc_tf->cop_cfg.fop.tx_cnt = (tc_tf->cop_cfg.fop.tx_cnt + 1) % 256;
-	ret = osdlp_timer_start(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	ret = osdlp_mark_ad_as_rt(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	return 0;
-}
-
-int
-osdlp_initiate_bc_retransmission(struct tc_transfer_frame *tc_tf)
-{
-	int ret;
-	osdlp_cancel_lower_ops();
-	tc_tf->cop_cfg.fop.tx_cnt = (tc_tf->cop_cfg.fop.tx_cnt + 1) % 256;
-	ret = osdlp_timer_start(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	ret = osdlp_mark_bc_as_rt(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	return 0;
-}
-
-int
-osdlp_purge_sent_queue(struct tc_transfer_frame *tc_tf)
-{
-	int ret = osdlp_tc_sent_queue_clear(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	return 0;
-}
-
-int
-osdlp_purge_wait_queue(struct tc_transfer_frame *tc_tf)
-{
-	int ret = osdlp_tc_wait_queue_clear(tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	return 0;
-}
-
-int
-osdlp_remove_acked_frames(struct tc_transfer_frame *tc_tf, uint8_t nr)
-{
-	struct queue_item item;
-	int ret;
-	uint16_t counter = 0;
-	while (1) {
-		ret = osdlp_tc_sent_queue_head(&item, tc_tf->primary_hdr.vcid);
-		if (ret < 0) {
-			break;
-		}
-		if (item.seq_num != nr) {
-			ret = osdlp_tc_sent_queue_dequeue(&item, tc_tf->primary_hdr.vcid);
-			if (ret < 0) {
-				return -1;
-			}
-			tc_tf->cop_cfg.fop.nnr = nr;
-			tc_tf->cop_cfg.fop.tx_cnt = 1;
-		} else {
-			break;
-		}
-		counter++;
-		if (counter > tc_tf->cop_cfg.fop.slide_wnd) {
-			return 1;
-		}
-	}
-	return 0;
-}
-
-int
-osdlp_release_copy_of_bc(struct tc_transfer_frame *tc_tf)
-{
-	int ret;
-	struct queue_item item;
-	ret = osdlp_tc_sent_queue_head(&item, tc_tf->primary_hdr.vcid);
-	if (ret < 0) {
-		return -1;
-	}
-	/* Check that item in head is TYPE B*/
-	if ((item.type == TYPE_B)) {
-		ret = osdlp_tc_sent_queue_dequeue(&item, tc_tf->primary_hdr.vcid);
-		if (ret < 0) {
-			return -1;
-		}
-	}
-	return 0;
-}
-
-notification_t
-fop_e1(struct tc_transfer_frame *tc_tf)
-{
-	notification_t ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_RT_WAIT:
-			// Alert;
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_INIT_NO_BC:
-			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
-			return POSITIVE_DIR;
-		case FOP_STATE_INIT_BC:
-			ret = osdlp_release_copy_of_bc(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
-			return POSITIVE_DIR;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e2(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	notification_t notif;
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e3(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_INIT_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_INIT:
-			// Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e4(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_INIT_BC:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT:
-			// Ignore
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e5(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
-			return ALERT_SYNCH;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e6(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	notification_t notif;
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e7(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
-			return ALERT_CLCW;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			// Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e101(struct tc_transfer_frame *tc_tf,
-         struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_RT_WAIT:
-			osdlp_remove_acked_frames(tc_tf, clcw->report_value);
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return 0;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e102(struct tc_transfer_frame *tc_tf,
-         struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
-			return ALERT_LIMIT;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e8(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	notification_t notif;
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_NO_WAIT;
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_NO_WAIT;
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e9(struct tc_transfer_frame *tc_tf,
-       struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_WAIT:
-			ret = osdlp_remove_acked_frames(tc_tf,
-			                                clcw->report_value);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e10(struct tc_transfer_frame *tc_tf,
-        struct clcw_frame *clcw)
-{
-	notification_t notif;
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_NO_WAIT;
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_RT_WAIT:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_NO_WAIT;
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e11(struct tc_transfer_frame *tc_tf,
-        struct clcw_frame *clcw)
-{
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			// Ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return IGNORE;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return IGNORE;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e12(struct tc_transfer_frame *tc_tf,
-        struct clcw_frame *clcw)
-{
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_NO_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_RT_WAIT:
-			// Ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_NO_WAIT;
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e103(struct tc_transfer_frame *tc_tf,
-         struct clcw_frame *clcw)
-{
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_NO_WAIT:
-			// Ignore
-			tc_tf->cop_cfg.fop.state =
-			        FOP_STATE_RT_WAIT;
-			return IGNORE;
-		case FOP_STATE_RT_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT_BC:
-			// NA
-			return NA;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e13(struct tc_transfer_frame *tc_tf,
-        struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_NNR;
-			return ALERT_NNR;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_NNR;
-			return ALERT_NNR;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_NNR;
-			return ALERT_NNR;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_NNR;
-			return ALERT_NNR;
-		case FOP_STATE_INIT_BC:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e14(struct tc_transfer_frame *tc_tf,
-        struct clcw_frame *clcw)
-{
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LOCKOUT;
-			return ALERT_LOCKOUT;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LOCKOUT;
-			return ALERT_LOCKOUT;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LOCKOUT;
-			return ALERT_LOCKOUT;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LOCKOUT;
-			return ALERT_LOCKOUT;
-		case FOP_STATE_INIT_BC:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT:
-			//Ignore
-			return IGNORE;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-	}
-}
-
-notification_t
-fop_e16(struct tc_transfer_frame *tc_tf)
-{
-	notification_t notif;
-	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_INIT_BC:
-			ret = osdlp_initiate_bc_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_directive(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT:
-			// NA
-			return NA;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
+{
+	int ret;
+	tc_tf->ops->cancel_lower_ops(tc_tf->user, tc_tf->primary_hdr.vcid);
+	tc_tf->cop_cfg.fop.tx_cnt = (tc_tf->cop_cfg.fop.tx_cnt + 1) % 256;
+	ret = timer_start(tc_tf);
+	if (ret < 0) {
+		return -1;
+	}
+	ret = mark_ad_as_rt(tc_tf);
+	if (ret < 0) {
+		return -1;
 	}
+	return 0;
 }
 
-notification_t
-fop_e104(struct tc_transfer_frame *tc_tf)
+int
+osdlp_initiate_bc_retransmission(struct tc_transfer_frame *tc_tf)
 {
-	notification_t notif;
 	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_initiate_ad_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_fdu(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_RT_WAIT:
-			// Ignore
-			return IGNORE;
-		case FOP_STATE_INIT_NO_BC:
-			// Suspend
-			tc_tf->cop_cfg.fop.ss = 4;
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return SUSPEND;
-		case FOP_STATE_INIT_BC:
-			ret = osdlp_initiate_bc_retransmission(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			notif = osdlp_look_for_directive(tc_tf);
-			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
-				return notif;
-			} else {
-				return tc_tf->cop_cfg.fop.signal;
-			}
-		case FOP_STATE_INIT:
-			// NA
-			return NA;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
+	tc_tf->ops->cancel_lower_ops(tc_tf->user, tc_tf->primary_hdr.vcid);
+	tc_tf->cop_cfg.fop.tx_cnt = (tc_tf->cop_cfg.fop.tx_cnt + 1) % 256;
+	ret = timer_start(tc_tf);
+	if (ret < 0) {
+		return -1;
+	}
+	ret = mark_bc_as_rt(tc_tf);
+	if (ret < 0) {
+		return -1;
 	}
+	return 0;
 }
 
-notification_t
-fop_e17(struct tc_transfer_frame *tc_tf)
+int
+osdlp_purge_sent_queue(struct tc_transfer_frame *tc_tf)
+{
+	int ret = sent_queue_clear(tc_tf);
+	if (ret < 0) {
+		return -1;
+	}
+	return 0;
+}
+
+int
+osdlp_purge_wait_queue(struct tc_transfer_frame *tc_tf)
+{
+	int ret = tc_tf->ops->wait_queue_clear(tc_tf->user,
+	                                       tc_tf->primary_hdr.vcid);
+	if (ret < 0) {
+		return -1;
+	}
+	return 0;
+}
+
+static int
+sent_ring_remove_acked_frames(struct tc_transfer_frame *tc_tf, uint8_t nr)
+{
+	struct tc_sent_ring *ring = tc_tf->sent_ring;
+	uint16_t max = tc_tf->cop_cfg.fop.slide_wnd + 1;
+	uint16_t counter = 0;
+	if (ring->bc_held) {
+		if (ring->bc_seq_num == nr) {
+			return 0;
+		}
+		osdlp_sent_ring_dequeue(ring);
+		counter++;
+	}
+	counter += osdlp_sent_ring_release(ring, nr, max - counter);
+	if (counter > 0) {
+		tc_tf->cop_cfg.fop.nnr = nr;
+		tc_tf->cop_cfg.fop.tx_cnt = 1;
+	}
+	return counter > tc_tf->cop_cfg.fop.slide_wnd ? 1 : 0;
+}
+
+int
+osdlp_remove_acked_frames(struct tc_transfer_frame *tc_tf, uint8_t nr)
 {
+	struct queue_item item;
 	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_RT_NO_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_RT_WAIT:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_INIT_NO_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_INIT_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
+	uint16_t counter = 0;
+	if (tc_tf->sent_ring) {
+		return sent_ring_remove_acked_frames(tc_tf, nr);
+	}
+	while (1) {
+		ret = sent_queue_head(tc_tf, &item);
+		if (ret < 0) {
+			break;
+		}
+		if (item.seq_num != nr) {
+			ret = sent_queue_dequeue(tc_tf, &item);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
+				return -1;
 			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_INIT:
-			// NA
-			return NA;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
+			tc_tf->cop_cfg.fop.nnr = nr;
+			tc_tf->cop_cfg.fop.tx_cnt = 1;
+		} else {
+			break;
+		}
+		counter++;
+		if (counter > tc_tf->cop_cfg.fop.slide_wnd) {
+			return 1;
+		}
 	}
+	return 0;
 }
 
-notification_t
-fop_e18(struct tc_transfer_frame *tc_tf)
+int
+osdlp_release_copy_of_bc(struct tc_transfer_frame *tc_tf)
 {
 	int ret;
-	switch (tc_tf->cop_cfg.fop.state) {
-		case FOP_STATE_ACTIVE:
-			// Suspend
-			tc_tf->cop_cfg.fop.ss = 1;
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return SUSPEND;
-		case FOP_STATE_RT_NO_WAIT:
-			// Suspend
-			tc_tf->cop_cfg.fop.ss = 2;
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return SUSPEND;
-		case FOP_STATE_RT_WAIT:
-			// Suspend
-			tc_tf->cop_cfg.fop.ss = 3;
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return SUSPEND;
-		case FOP_STATE_INIT_NO_BC:
-			// Suspend
-			tc_tf->cop_cfg.fop.ss = 4;
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			return SUSPEND;
-		case FOP_STATE_INIT_BC:
-			// Alert
-			ret = osdlp_alert(tc_tf);
-			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-				return UNDEF_ERROR;
-			}
-			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_T1;
-			return ALERT_T1;
-		case FOP_STATE_INIT:
-			// NA
-			return NA;
-		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
+	struct queue_item item;
+	ret = sent_queue_head(tc_tf, &item);
+	if (ret < 0) {
+		return -1;
+	}
+	/* Check that item in head is TYPE B*/
+	if ((item.type == TYPE_B)) {
+		ret = sent_queue_dequeue(tc_tf, &item);
+		if (ret < 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * FOP-1 engine for the CLCW and timer events.
+ * The events are classified by a table lookup on the conditions that tell
+ * them apart and each (event, state) pair is mapped to an action cell.
+ * The operations of a cell are always performed in the order of the
+ * FOP_OP_* flags below. Cells that look for a frame to send enter the next
+ * state only afterwards, unless FOP_OP_ENTER_FIRST is set, because the
+ * lower layer may call back into the FOP while the frame is transmitted.
+ */
+typedef enum {
+	FOP_EV_E1 = 0,
+	FOP_EV_E2,
+	FOP_EV_E3,
+	FOP_EV_E4,
+	FOP_EV_E5,
+	FOP_EV_E6,
+	FOP_EV_E7,
+	FOP_EV_E8,
+	FOP_EV_E9,
+	FOP_EV_E10,
+	FOP_EV_E11,
+	FOP_EV_E12,
+	FOP_EV_E13,
+	FOP_EV_E14,
+	FOP_EV_E101,
+	FOP_EV_E102,
+	FOP_EV_E103,
+	FOP_EV_E16,
+	FOP_EV_E104,
+	FOP_EV_E17,
+	FOP_EV_E18,
+	FOP_EV_INVALID
+} fop_event_t;
+
+#define FOP_OP_RM_ACKED         0x0001  /* Remove acknowledged frames*/
+#define FOP_OP_RELEASE_BC       0x0002  /* Release the copy of the BC frame*/
+#define FOP_OP_ALERT            0x0004
+#define FOP_OP_TIMER_CANCEL     0x0008
+#define FOP_OP_AD_RT            0x0010  /* Initiate AD retransmission*/
+#define FOP_OP_BC_RT            0x0020  /* Initiate BC retransmission*/
+#define FOP_OP_SUSPEND          0x0040
+#define FOP_OP_LOOK_FDU         0x0080
+#define FOP_OP_LOOK_DIR         0x0100
+#define FOP_OP_SIGNAL           0x0200  /* Report the notification as signal*/
+#define FOP_OP_ENTER_FIRST      0x0400  /* Enter the next state before looking*/
+
+#define FOP_KEEP                0xff    /* Do not change state*/
+
+struct fop_action {
+	uint16_t    ops;
+	uint8_t     next;       /* Next state or FOP_KEEP*/
+	uint8_t     notif;      /* Notification if not looking for an FDU*/
+};
+
+#define FOP_IGNORE      {0, FOP_KEEP, IGNORE}
+#define FOP_NA          {0, FOP_KEEP, NA}
+#define FOP_GOTO(s)     {0, s, IGNORE}
+#define FOP_ALERT(n)    {FOP_OP_ALERT | FOP_OP_SIGNAL, FOP_STATE_INIT, n}
+#define FOP_SUSPEND     {FOP_OP_SUSPEND, FOP_STATE_INIT, SUSPEND}
+#define FOP_FDU(ops, s) {(ops) | FOP_OP_LOOK_FDU, s, IGNORE}
+
+/* Cells in the order ACTIVE, RT_NO_WAIT, RT_WAIT, INIT_NO_BC, INIT_BC, INIT */
+static const struct fop_action fop_actions[FOP_EV_INVALID][6] = {
+	[FOP_EV_E1] = {
+		FOP_IGNORE, FOP_ALERT(ALERT_SYNCH), FOP_ALERT(ALERT_SYNCH),
+		{
+			FOP_OP_TIMER_CANCEL | FOP_OP_SIGNAL, FOP_STATE_ACTIVE,
+			POSITIVE_DIR
+		},
+		{
+			FOP_OP_RELEASE_BC | FOP_OP_TIMER_CANCEL | FOP_OP_SIGNAL,
+			FOP_STATE_ACTIVE, POSITIVE_DIR
+		},
+		FOP_IGNORE
+	},
+	[FOP_EV_E2] = {
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_TIMER_CANCEL, FOP_KEEP),
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_TIMER_CANCEL, FOP_KEEP),
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_TIMER_CANCEL, FOP_KEEP),
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E3] = {
+		FOP_ALERT(ALERT_CLCW), FOP_ALERT(ALERT_CLCW),
+		FOP_ALERT(ALERT_CLCW), FOP_ALERT(ALERT_CLCW),
+		FOP_ALERT(ALERT_CLCW), FOP_IGNORE
+	},
+	[FOP_EV_E4] = {
+		FOP_ALERT(ALERT_SYNCH), FOP_ALERT(ALERT_SYNCH),
+		FOP_ALERT(ALERT_SYNCH), FOP_ALERT(ALERT_SYNCH),
+		FOP_IGNORE, FOP_IGNORE
+	},
+	[FOP_EV_E5] = {
+		FOP_IGNORE, FOP_ALERT(ALERT_SYNCH), FOP_ALERT(ALERT_SYNCH),
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E6] = {
+		FOP_FDU(FOP_OP_RM_ACKED, FOP_KEEP),
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_ENTER_FIRST, FOP_STATE_ACTIVE),
+		FOP_FDU(FOP_OP_RM_ACKED, FOP_STATE_ACTIVE),
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E7] = {
+		FOP_ALERT(ALERT_CLCW), FOP_ALERT(ALERT_CLCW),
+		FOP_ALERT(ALERT_CLCW), FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E8] = {
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_AD_RT, FOP_STATE_RT_NO_WAIT),
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_AD_RT, FOP_STATE_RT_NO_WAIT),
+		FOP_FDU(FOP_OP_RM_ACKED | FOP_OP_AD_RT, FOP_STATE_RT_NO_WAIT),
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E9] = {
+		{FOP_OP_RM_ACKED, FOP_STATE_RT_WAIT, IGNORE},
+		{FOP_OP_RM_ACKED, FOP_STATE_RT_WAIT, IGNORE},
+		{FOP_OP_RM_ACKED, FOP_STATE_RT_WAIT, IGNORE},
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E10] = {
+		FOP_FDU(FOP_OP_AD_RT, FOP_STATE_RT_NO_WAIT), FOP_IGNORE,
+		FOP_FDU(FOP_OP_AD_RT, FOP_STATE_RT_NO_WAIT),
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E11] = {
+		FOP_GOTO(FOP_STATE_RT_WAIT), FOP_GOTO(FOP_STATE_RT_WAIT),
+		FOP_IGNORE, FOP_IGNORE, FOP_IGNORE, FOP_IGNORE
+	},
+	[FOP_EV_E12] = {
+		FOP_GOTO(FOP_STATE_RT_NO_WAIT), FOP_IGNORE,
+		FOP_GOTO(FOP_STATE_RT_NO_WAIT), FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E13] = {
+		FOP_ALERT(ALERT_NNR), FOP_ALERT(ALERT_NNR),
+		FOP_ALERT(ALERT_NNR), FOP_ALERT(ALERT_NNR),
+		FOP_IGNORE, FOP_IGNORE
+	},
+	[FOP_EV_E14] = {
+		FOP_ALERT(ALERT_LOCKOUT), FOP_ALERT(ALERT_LOCKOUT),
+		FOP_ALERT(ALERT_LOCKOUT), FOP_ALERT(ALERT_LOCKOUT),
+		FOP_IGNORE, FOP_IGNORE
+	},
+	[FOP_EV_E101] = {
+		{
+			FOP_OP_RM_ACKED | FOP_OP_ALERT | FOP_OP_SIGNAL,
+			FOP_STATE_INIT, ALERT_LIMIT
+		},
+		{
+			FOP_OP_RM_ACKED | FOP_OP_ALERT | FOP_OP_SIGNAL,
+			FOP_STATE_INIT, ALERT_LIMIT
+		},
+		{
+			FOP_OP_RM_ACKED | FOP_OP_ALERT | FOP_OP_SIGNAL,
+			FOP_STATE_INIT, ALERT_LIMIT
+		},
+		FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E102] = {
+		FOP_ALERT(ALERT_LIMIT), FOP_ALERT(ALERT_LIMIT),
+		FOP_ALERT(ALERT_LIMIT), FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E103] = {
+		FOP_GOTO(FOP_STATE_RT_WAIT), FOP_GOTO(FOP_STATE_RT_WAIT),
+		FOP_IGNORE, FOP_NA, FOP_NA, FOP_IGNORE
+	},
+	[FOP_EV_E16] = {
+		FOP_FDU(FOP_OP_AD_RT, FOP_KEEP),
+		FOP_FDU(FOP_OP_AD_RT, FOP_KEEP),
+		FOP_IGNORE, FOP_ALERT(ALERT_T1),
+		{FOP_OP_BC_RT | FOP_OP_LOOK_DIR, FOP_KEEP, IGNORE},
+		FOP_NA
+	},
+	[FOP_EV_E104] = {
+		FOP_FDU(FOP_OP_AD_RT, FOP_KEEP),
+		FOP_FDU(FOP_OP_AD_RT, FOP_KEEP),
+		FOP_IGNORE, FOP_SUSPEND,
+		{FOP_OP_BC_RT | FOP_OP_LOOK_DIR, FOP_KEEP, IGNORE},
+		FOP_NA
+	},
+	[FOP_EV_E17] = {
+		FOP_ALERT(ALERT_T1), FOP_ALERT(ALERT_T1), FOP_ALERT(ALERT_T1),
+		FOP_ALERT(ALERT_T1), FOP_ALERT(ALERT_T1), FOP_NA
+	},
+	[FOP_EV_E18] = {
+		FOP_SUSPEND, FOP_SUSPEND, FOP_SUSPEND, FOP_SUSPEND,
+		FOP_ALERT(ALERT_T1), FOP_NA
+	}
+};
+
+/*
+ * CLCW event of each combination of the conditions below. The table is
+ * expanded at compile time from FOP_CLCW_EVENT()
+ */
+#define FOP_C_WAIT              0x001   /* Wait flag set*/
+#define FOP_C_RT                0x002   /* Retransmit flag set*/
+#define FOP_C_NR_EQ_NNR         0x004   /* N(R) == NN(R)*/
+#define FOP_C_CNT_LT_LIM        0x008   /* Transmission count < limit*/
+#define FOP_C_LIM_ONE           0x010   /* Transmission limit == 1*/
+#define FOP_C_LIM_MANY          0x020   /* Transmission limit > 1*/
+#define FOP_C_IN_WINDOW         0x040   /* N(R) is a valid acknowledgement*/
+#define FOP_C_NR_EQ_VS          0x080   /* N(R) == V(S)*/
+#define FOP_C_LOCKOUT           0x100
+
+#define FOP_CLCW_RT_EVENT(c)                                                   \
+	(((c) & FOP_C_LIM_ONE) ?                                               \
+	 (((c) & FOP_C_NR_EQ_NNR) ? FOP_EV_E102 : FOP_EV_E101) :               \
+	 !((c) & FOP_C_LIM_MANY) ? FOP_EV_INVALID :                            \
+	 !((c) & FOP_C_NR_EQ_NNR) ?                                            \
+	 (((c) & FOP_C_WAIT) ? FOP_EV_E9 : FOP_EV_E8) :                        \
+	 ((c) & FOP_C_CNT_LT_LIM) ?                                            \
+	 (((c) & FOP_C_WAIT) ? FOP_EV_E11 : FOP_EV_E10) :                      \
+	 (((c) & FOP_C_WAIT) ? FOP_EV_E103 : FOP_EV_E12))
+
+#define FOP_CLCW_EVENT(c)                                                      \
+	(((c) & FOP_C_LOCKOUT) ? FOP_EV_E14 :                                  \
+	 ((c) & FOP_C_NR_EQ_VS) ?                                              \
+	 (((c) & FOP_C_RT) ? FOP_EV_E4 : ((c) & FOP_C_WAIT) ? FOP_EV_E3 :      \
+	  ((c) & FOP_C_NR_EQ_NNR) ? FOP_EV_E1 : FOP_EV_E2) :                   \
+	 !((c) & FOP_C_IN_WINDOW) ? FOP_EV_E13 :                               \
+	 ((c) & FOP_C_RT) ? FOP_CLCW_RT_EVENT(c) :                             \
+	 ((c) & FOP_C_WAIT) ? FOP_EV_E7 :                                      \
+	 ((c) & FOP_C_NR_EQ_NNR) ? FOP_EV_E5 : FOP_EV_E6)
+
+#define FOP_X4(m, c)    m(c), m((c) + 1), m((c) + 2), m((c) + 3)
+#define FOP_X16(m, c)   FOP_X4(m, c), FOP_X4(m, (c) + 4), \
+	FOP_X4(m, (c) + 8), FOP_X4(m, (c) + 12)
+#define FOP_X64(m, c)   FOP_X16(m, c), FOP_X16(m, (c) + 16), \
+	FOP_X16(m, (c) + 32), FOP_X16(m, (c) + 48)
+#define FOP_X512(m, c)  FOP_X64(m, c), FOP_X64(m, (c) + 64), \
+	FOP_X64(m, (c) + 128), FOP_X64(m, (c) + 192), \
+	FOP_X64(m, (c) + 256), FOP_X64(m, (c) + 320), \
+	FOP_X64(m, (c) + 384), FOP_X64(m, (c) + 448)
+
+static const uint8_t fop_clcw_events[512] = {
+	FOP_X512(FOP_CLCW_EVENT, 0)
+};
+
+/* Timer event indexed by (tt << 1) | (transmission count < limit) */
+static const uint8_t fop_timer_events[6] = {
+	FOP_EV_E17, FOP_EV_E16, FOP_EV_E18, FOP_EV_E104,
+	FOP_EV_INVALID, FOP_EV_INVALID
+};
+
+static fop_event_t
+fop_clcw_event(const struct fop_config *fop, const struct clcw_frame *clcw)
+{
+	uint8_t nr = clcw->report_value;
+	uint16_t c;
+	c = (clcw->wait != CLCW_DO_NOT_WAIT)
+	    | (clcw->rt != CLCW_NO_RETRANSMIT) << 1
+	    | (nr == fop->nnr) << 2
+	    | (fop->tx_cnt < fop->tx_lim) << 3
+	    | (fop->tx_lim == 1) << 4
+	    | (fop->tx_lim > 1) << 5
+	    /* NN(R) <= N(R) < V(S), modulo 256 */
+	    | ((uint8_t)(nr - fop->nnr) < (uint8_t)(fop->vs - fop->nnr)) << 6
+	    | (nr == fop->vs) << 7
+	    | (clcw->lockout != CLCW_NO_LOCKOUT) << 8;
+	return fop_clcw_events[c];
+}
+
+static fop_event_t
+fop_timer_event(const struct fop_config *fop)
+{
+	uint8_t tt = fop->tt > 2 ? 2 : fop->tt;
+	return fop_timer_events[(tt << 1) | (fop->tx_cnt < fop->tx_lim)];
+}
+
+static notification_t
+fop_execute(struct tc_transfer_frame *tc_tf, fop_event_t ev)
+{
+	struct fop_config *fop = &tc_tf->cop_cfg.fop;
+	struct clcw_frame *clcw = &tc_tf->mission.clcw;
+	const struct fop_action *a;
+	notification_t notif;
+	uint32_t cnt;
+	int ret = 0;
+
+	if (ev == FOP_EV_INVALID || fop->state > FOP_STATE_INIT) {
+		fop_signal(tc_tf, UNDEF_ERROR);
+		return UNDEF_ERROR;
+	}
+	a = &fop_actions[ev][fop->state];
+	if (a->ops & FOP_OP_RM_ACKED) {
+		ret = osdlp_remove_acked_frames(tc_tf, clcw->report_value);
+	}
+	if (ret >= 0 && (a->ops & FOP_OP_RELEASE_BC)) {
+		/* Having no copy of the BC frame to release is not an error */
+		osdlp_release_copy_of_bc(tc_tf);
+	}
+	if (ret >= 0 && (a->ops & FOP_OP_ALERT)) {
+		ret = osdlp_alert(tc_tf);
+	}
+	if (ret >= 0 && (a->ops & FOP_OP_TIMER_CANCEL)) {
+		timer_cancel(tc_tf);
 	}
+	if (ret >= 0 && (a->ops & FOP_OP_AD_RT)) {
+		ret = osdlp_initiate_ad_retransmission(tc_tf);
+		if (ret >= 0) {
+			ret = osdlp_retransmit_ad_frames(tc_tf);
+		}
+	}
+	if (ret >= 0 && (a->ops & FOP_OP_BC_RT)) {
+		ret = osdlp_initiate_bc_retransmission(tc_tf);
+	}
+	if (ret < 0) {
+		fop_signal(tc_tf, UNDEF_ERROR);
+		return UNDEF_ERROR;
+	}
+	if (a->ops & FOP_OP_SUSPEND) {
+		fop->ss = fop->state + 1;
+	}
+	if (a->next != FOP_KEEP && (a->ops & FOP_OP_ENTER_FIRST)) {
+		fop->state = a->next;
+	}
+	if (a->ops & (FOP_OP_LOOK_FDU | FOP_OP_LOOK_DIR)) {
+		cnt = tc_tf->notify_cnt;
+		if (a->ops & FOP_OP_LOOK_FDU) {
+			notif = osdlp_look_for_fdu(tc_tf);
+		} else {
+			notif = osdlp_look_for_directive(tc_tf);
+		}
+	}
+	if (a->next != FOP_KEEP && !(a->ops & FOP_OP_ENTER_FIRST)) {
+		fop->state = a->next;
+	}
+	if (a->ops & (FOP_OP_LOOK_FDU | FOP_OP_LOOK_DIR)) {
+		if (notif == IGNORE) {
+			return fop->signal;
+		}
+		fop_forward(tc_tf, notif, cnt);
+		return notif;
+	}
+	if (a->ops & FOP_OP_SIGNAL) {
+		fop_signal(tc_tf, a->notif);
+	}
+	return a->notif;
 }
 
 notification_t
 fop_e19(struct tc_transfer_frame *tc_tf)
 {
 	notification_t notif;
+	uint32_t cnt;
 	int ret;
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
-			ret = osdlp_tc_wait_queue_enqueue(tc_tf, tc_tf->primary_hdr.vcid);
+			ret = wait_queue_enqueue(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_look_for_fdu(tc_tf);
 			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
+				fop_forward(tc_tf, notif, cnt);
 				return notif;
 			} else {
 				return tc_tf->cop_cfg.fop.signal;
 			}
 		case FOP_STATE_RT_NO_WAIT:
-			ret = osdlp_tc_wait_queue_enqueue(tc_tf, tc_tf->primary_hdr.vcid);
+			ret = wait_queue_enqueue(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_look_for_fdu(tc_tf);
 			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
+				fop_forward(tc_tf, notif, cnt);
 				return notif;
 			} else {
 				return tc_tf->cop_cfg.fop.signal;
 			}
 		case FOP_STATE_RT_WAIT:
-			ret = osdlp_tc_wait_queue_enqueue(tc_tf, tc_tf->primary_hdr.vcid);
+			ret = wait_queue_enqueue(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
-			tc_tf->cop_cfg.fop.signal = DELAY_RESP;
+			fop_signal(tc_tf, DELAY_RESP);
 			return DELAY_RESP;
 		case FOP_STATE_INIT_NO_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_INIT_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_INIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -1879,30 +1342,30 @@ fop_e20(struct tc_transfer_frame *tc_tf)
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_RT_NO_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_RT_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_INIT_NO_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_INIT_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		case FOP_STATE_INIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return REJECT_TX;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -1915,213 +1378,136 @@ fop_e21(struct tc_transfer_frame *tc_tf)
 		case FOP_STATE_ACTIVE:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		case FOP_STATE_RT_NO_WAIT:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		case FOP_STATE_RT_WAIT:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		case FOP_STATE_INIT_NO_BC:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		case FOP_STATE_INIT_BC:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		case FOP_STATE_INIT:
 			ret = osdlp_transmit_type_bd(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_signal(tc_tf, REJECT_TX);
 				return REJECT_TX;
 			} else {
-				tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+				fop_signal(tc_tf, ACCEPT_TX);
 				return ACCEPT_TX;
 			}
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
 
+static notification_t
+fop_dispatch(struct tc_transfer_frame *tc_tf, fop_event_t ev)
+{
+	struct fop_config *fop = &tc_tf->cop_cfg.fop;
+	uint8_t before = fop->state;
+	uint8_t nr = tc_tf->mission.clcw.report_value;
+	notification_t notif = fop_execute(tc_tf, ev);
+	osdlp_trace_record(OSDLP_TRACE_FOP, tc_tf->primary_hdr.vcid, ev, before,
+	                   fop->state, fop->vs, nr, trace_depth(tc_tf));
+	return notif;
+}
+
 notification_t
 osdlp_handle_clcw(struct tc_transfer_frame *tc_tf, uint8_t *ocf_buffer)
 {
-	notification_t notif;
+	tc_tf->cop_cfg.fop.memo_valid = 0;
 	osdlp_clcw_unpack(&tc_tf->mission.clcw, ocf_buffer);
-	if (tc_tf->mission.clcw.lockout == CLCW_NO_LOCKOUT) {
-		if (tc_tf->cop_cfg.fop.vs == tc_tf->mission.clcw.report_value) {
-			if (tc_tf->mission.clcw.rt == CLCW_NO_RETRANSMIT) {
-				if (tc_tf->mission.clcw.wait == CLCW_DO_NOT_WAIT) {
-					if (tc_tf->mission.clcw.report_value == tc_tf->cop_cfg.fop.nnr) {
-						/*E1*/
-						notif = fop_e1(tc_tf);
-						return notif;
-					} else {
-						/* E2 */
-						notif = fop_e2(tc_tf, &tc_tf->mission.clcw);
-						return notif;
-					}
-				} else { // Wait flag  = 1
-					/*E3*/
-					notif = fop_e3(tc_tf, &tc_tf->mission.clcw);
-					return notif;
-				}
-			} else { // Retransmit flag = 1
-				/*E4*/
-				notif = fop_e4(tc_tf, &tc_tf->mission.clcw);
-				return notif;
-			}
-		}
-		/* Make sure the N(R) falls within bounds even if the counter has wrapped around */
-		else if (((tc_tf->cop_cfg.fop.vs > tc_tf->mission.clcw.report_value)
-		          && (tc_tf->mission.clcw.report_value >= tc_tf->cop_cfg.fop.nnr))
-		         || ((tc_tf->cop_cfg.fop.vs < tc_tf->mission.clcw.report_value)
-		             && (tc_tf->mission.clcw.report_value > tc_tf->cop_cfg.fop.nnr))
-		         || ((tc_tf->cop_cfg.fop.vs > tc_tf->mission.clcw.report_value)
-		             && (tc_tf->mission.clcw.report_value < tc_tf->cop_cfg.fop.nnr))) {
-			if (tc_tf->mission.clcw.rt == CLCW_NO_RETRANSMIT) {
-				if (tc_tf->mission.clcw.wait == CLCW_DO_NOT_WAIT) {
-					if (tc_tf->mission.clcw.report_value == tc_tf->cop_cfg.fop.nnr) {
-						/*E5*/
-						notif = fop_e5(tc_tf, &tc_tf->mission.clcw);
-						return notif;
-					} else {
-						/* E6 */
-						notif = fop_e6(tc_tf, &tc_tf->mission.clcw);
-						return notif;
-					}
-				} else { // Wait flag  = 1
-					/*E7*/
-					notif = fop_e7(tc_tf, &tc_tf->mission.clcw);
-					return notif;
-				}
-			} else { // Retransmit flag = 1
-				if (tc_tf->cop_cfg.fop.tx_lim == 1) {
-					/*E101*/
-					if (tc_tf->mission.clcw.report_value != tc_tf->cop_cfg.fop.nnr) {
-						notif = fop_e101(tc_tf, &tc_tf->mission.clcw);
-						return notif;
-					}
-					/*E102*/
-					else {
-						notif = fop_e102(tc_tf, &tc_tf->mission.clcw);
-						return notif;
-					}
-				} else if (tc_tf->cop_cfg.fop.tx_lim > 1) {
-					if (tc_tf->mission.clcw.report_value != tc_tf->cop_cfg.fop.nnr) {
-						/*E8*/
-						if (tc_tf->mission.clcw.wait == CLCW_DO_NOT_WAIT) {
-							notif = fop_e8(tc_tf, &tc_tf->mission.clcw);
-							return notif;
-						}
-						/*E9*/
-						else { //Wait flag = 1
-							notif = fop_e9(tc_tf, &tc_tf->mission.clcw);
-							return notif;
-						}
-					} else { //N(R == NN{R}
-						if (tc_tf->cop_cfg.fop.tx_cnt
-						    < tc_tf->cop_cfg.fop.tx_lim) {
-							/*E10*/
-							if (tc_tf->mission.clcw.wait == CLCW_DO_NOT_WAIT) {
-								notif = fop_e10(tc_tf, &tc_tf->mission.clcw);
-								return notif;
-							}
-							/*E11*/
-							else { //Wait flag = 1
-								notif = fop_e11(tc_tf, &tc_tf->mission.clcw);
-								return notif;
-							}
-						} else { // Tx cnt >= Tx limit
-							/*E12*/
-							if (tc_tf->mission.clcw.wait == CLCW_DO_NOT_WAIT) {
-								notif = fop_e12(tc_tf, &tc_tf->mission.clcw);
-								return notif;
-							}
-							/*E103*/
-							else { //Wait flag = 1
-								notif = fop_e103(tc_tf, &tc_tf->mission.clcw);
-								return notif;
-							}
-						}
-					}
-				} else {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-					return UNDEF_ERROR;
-				}
-			}
-		} else { // N(R) not within bounds
-			/*E13*/
-			notif = fop_e13(tc_tf, &tc_tf->mission.clcw);
-			return notif;
-		}
-	} else { // Lockout = 1
-		/*E14*/
-		notif = fop_e14(tc_tf, &tc_tf->mission.clcw);
-		return notif;
-	}
+	return fop_dispatch(tc_tf, fop_clcw_event(&tc_tf->cop_cfg.fop,
+	                    &tc_tf->mission.clcw));
+}
+
+/* The part of the FOP-1 status that the processing of a CLCW depends on */
+static inline uint32_t
+fop_memo_key(const struct fop_config *fop)
+{
+	return fop->state | (fop->vs << 8) | (fop->nnr << 16)
+	       | ((uint32_t)fop->tx_cnt << 24);
+}
+
+static inline uint32_t
+clcw_word(const uint8_t *ocf_buffer)
+{
+	return ((uint32_t)ocf_buffer[0] << 24) | (ocf_buffer[1] << 16)
+	       | (ocf_buffer[2] << 8) | ocf_buffer[3];
+}
+
+bool
+osdlp_clcw_duplicate(const struct tc_transfer_frame *tc_tf,
+                     const uint8_t *ocf_buffer)
+{
+	const struct fop_config *fop = &tc_tf->cop_cfg.fop;
+	/*
+	 * Processing a CLCW leaves the FOP-1 in a state where processing the
+	 * same CLCW again has no effect, as long as nothing else has changed
+	 */
+	return fop->memo_valid && fop->memo_clcw == clcw_word(ocf_buffer)
+	       && fop->memo_fop == fop_memo_key(fop);
 }
 
 notification_t
-osdlp_handle_timer_expired(struct tc_transfer_frame *tc_tf)
+osdlp_handle_clcw_once(struct tc_transfer_frame *tc_tf, uint8_t *ocf_buffer,
+                       bool *handled)
 {
+	struct fop_config *fop = &tc_tf->cop_cfg.fop;
 	notification_t notif;
-	if (tc_tf->cop_cfg.fop.tx_cnt < tc_tf->cop_cfg.fop.tx_lim) {
-		if (tc_tf->cop_cfg.fop.tt == 0) {
-			/*E16*/
-			notif = fop_e16(tc_tf);
-			return notif;
-		} else if (tc_tf->cop_cfg.fop.tt == 1) {
-			/*E104*/
-			notif = fop_e104(tc_tf);
-			return notif;
-		} else {
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-		}
-	} else { // tx_cnt >= tx_lim
-		if (tc_tf->cop_cfg.fop.tt == 0) {
-			/*E17*/
-			notif = fop_e17(tc_tf);
-			return notif;
-		} else if (tc_tf->cop_cfg.fop.tt == 1) {
-			/*E18*/
-			notif = fop_e18(tc_tf);
-			return notif;
-		} else {
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
-			return UNDEF_ERROR;
-		}
+	bool dup = osdlp_clcw_duplicate(tc_tf, ocf_buffer);
+	if (handled) {
+		*handled = !dup;
+	}
+	if (dup) {
+		return IGNORE;
 	}
+	notif = osdlp_handle_clcw(tc_tf, ocf_buffer);
+	fop->memo_valid = 1;
+	fop->memo_clcw = clcw_word(ocf_buffer);
+	fop->memo_fop = fop_memo_key(fop);
+	return notif;
+}
+
+notification_t
+osdlp_handle_timer_expired(struct tc_transfer_frame *tc_tf)
+{
+	return fop_dispatch(tc_tf, fop_timer_event(&tc_tf->cop_cfg.fop));
 }
 
 notification_t
@@ -2129,7 +1515,8 @@ osdlp_req_transfer_fdu(struct tc_transfer_frame *tc_tf)
 {
 	notification_t notif;
 	if (tc_tf->primary_hdr.bypass == TYPE_A) {
-		if (osdlp_tc_wait_queue_empty(tc_tf->primary_hdr.vcid)) {
+		if (tc_tf->ops->wait_queue_empty(tc_tf->user,
+		                                 tc_tf->primary_hdr.vcid)) {
 			/*E19*/
 			notif = fop_e19(tc_tf);
 			return notif;
@@ -2144,7 +1531,7 @@ osdlp_req_transfer_fdu(struct tc_transfer_frame *tc_tf)
 		notif = fop_e21(tc_tf);
 		return notif;
 	} else {
-		tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+		fop_signal(tc_tf, UNDEF_ERROR);
 		return UNDEF_ERROR;
 	}
 }
@@ -2157,37 +1544,37 @@ osdlp_initiate_no_clcw(struct tc_transfer_frame *tc_tf)
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_RT_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT:
 			// accept();
 			ret = osdlp_initialize_cop(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			// confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2200,36 +1587,36 @@ osdlp_initiate_with_clcw(struct tc_transfer_frame *tc_tf)
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_RT_WAIT:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT_BC:
 			// Reject
-			tc_tf->cop_cfg.fop.signal = REJECT_DIR;
+			fop_signal(tc_tf, REJECT_DIR);
 			return REJECT_DIR;
 		case FOP_STATE_INIT:
 			ret = osdlp_initialize_cop(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
-			osdlp_timer_start(tc_tf->primary_hdr.vcid);
+			timer_start(tc_tf);
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT_NO_BC;
-			tc_tf->cop_cfg.fop.signal = ACCEPT_DIR;
+			fop_signal(tc_tf, ACCEPT_DIR);
 			return ACCEPT_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2258,20 +1645,20 @@ osdlp_initiate_with_unlock(struct tc_transfer_frame *tc_tf)
 		case FOP_STATE_INIT:
 			ret = osdlp_initialize_cop(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			osdlp_prepare_typeb_unlock(tc_tf);
 			ret = osdlp_transmit_type_bc(tc_tf); // Unlock
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT_BC;
-			tc_tf->cop_cfg.fop.signal = ACCEPT_DIR;
+			fop_signal(tc_tf, ACCEPT_DIR);
 			return ACCEPT_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2301,7 +1688,7 @@ osdlp_initiate_with_setvr(struct tc_transfer_frame *tc_tf,
 		case FOP_STATE_INIT:
 			ret = osdlp_initialize_cop(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.vs = new_vr;
@@ -2309,14 +1696,14 @@ osdlp_initiate_with_setvr(struct tc_transfer_frame *tc_tf,
 			osdlp_prepare_typeb_setvr(tc_tf, new_vr);
 			ret = osdlp_transmit_type_bc(tc_tf); // Set V(R)
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT_BC;
-			tc_tf->cop_cfg.fop.signal = ACCEPT_DIR;
+			fop_signal(tc_tf, ACCEPT_DIR);
 			return ACCEPT_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2331,63 +1718,63 @@ osdlp_terminate_ad(struct tc_transfer_frame *tc_tf)
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			//confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			//confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			//confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			//confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			//confirm();
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT:
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2418,7 +1805,7 @@ osdlp_resume_ad(struct tc_transfer_frame *tc_tf)
 				// Reject
 				return REJECT_DIR;
 			default:
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 		}
 	} else if (tc_tf->cop_cfg.fop.ss == 1) {
@@ -2441,15 +1828,15 @@ osdlp_resume_ad(struct tc_transfer_frame *tc_tf)
 			case FOP_STATE_INIT:
 				ret = osdlp_resume(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
 				//confirm();
 				tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
-				tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+				fop_signal(tc_tf, POSITIVE_DIR);
 				return POSITIVE_DIR;
 			default:
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 		}
 	} else if (tc_tf->cop_cfg.fop.ss == 2) {
@@ -2473,15 +1860,15 @@ osdlp_resume_ad(struct tc_transfer_frame *tc_tf)
 			case FOP_STATE_INIT:
 				ret = osdlp_resume(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
 				//confirm();
 				tc_tf->cop_cfg.fop.state = FOP_STATE_RT_NO_WAIT;
-				tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+				fop_signal(tc_tf, POSITIVE_DIR);
 				return POSITIVE_DIR;
 			default:
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 		}
 	} else if (tc_tf->cop_cfg.fop.ss == 3) {
@@ -2505,15 +1892,15 @@ osdlp_resume_ad(struct tc_transfer_frame *tc_tf)
 			case FOP_STATE_INIT:
 				ret = osdlp_resume(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
 				//confirm();
 				tc_tf->cop_cfg.fop.state = FOP_STATE_RT_WAIT;
-				tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+				fop_signal(tc_tf, POSITIVE_DIR);
 				return POSITIVE_DIR;
 			default:
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 		}
 	} else if (tc_tf->cop_cfg.fop.ss == 4) {
@@ -2537,19 +1924,19 @@ osdlp_resume_ad(struct tc_transfer_frame *tc_tf)
 			case FOP_STATE_INIT:
 				ret = osdlp_resume(tc_tf);
 				if (ret < 0) {
-					tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+					fop_signal(tc_tf, UNDEF_ERROR);
 					return UNDEF_ERROR;
 				}
 				//confirm();
 				tc_tf->cop_cfg.fop.state = FOP_STATE_INIT_NO_BC;
-				tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+				fop_signal(tc_tf, POSITIVE_DIR);
 				return POSITIVE_DIR;
 			default:
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 		}
 	} else {
-		tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+		fop_signal(tc_tf, UNDEF_ERROR);
 		return UNDEF_ERROR;
 	}
 }
@@ -2579,14 +1966,14 @@ osdlp_set_new_vs(struct tc_transfer_frame *tc_tf, uint8_t new_vs)
 				tc_tf->cop_cfg.fop.vs = new_vs;
 				tc_tf->cop_cfg.fop.nnr = new_vs;
 				//confirm();
-				tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+				fop_signal(tc_tf, POSITIVE_DIR);
 				return POSITIVE_DIR;
 			} else {
 				// Reject
 				return REJECT_DIR;
 			}
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2600,35 +1987,35 @@ osdlp_set_sliding_window(struct tc_transfer_frame *tc_tf,
 		case FOP_STATE_ACTIVE:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_WAIT:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_BC:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT:
 			tc_tf->cop_cfg.fop.slide_wnd = new_wnd;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2641,35 +2028,35 @@ osdlp_set_timer(struct tc_transfer_frame *tc_tf, uint16_t new_t1)
 		case FOP_STATE_ACTIVE:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_WAIT:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_BC:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT:
 			tc_tf->cop_cfg.fop.t1_init = new_t1;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2682,35 +2069,35 @@ osdlp_set_tx_limit(struct tc_transfer_frame *tc_tf, uint8_t new_lim)
 		case FOP_STATE_ACTIVE:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_WAIT:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_BC:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT:
 			tc_tf->cop_cfg.fop.tx_lim = new_lim;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2723,35 +2110,35 @@ osdlp_set_tt(struct tc_transfer_frame *tc_tf, uint8_t new_tt)
 		case FOP_STATE_ACTIVE:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_NO_WAIT:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_RT_WAIT:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_NO_BC:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT_BC:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		case FOP_STATE_INIT:
 			tc_tf->cop_cfg.fop.tt = new_tt;
 			//confirm();
-			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			fop_signal(tc_tf, POSITIVE_DIR);
 			return POSITIVE_DIR;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2760,20 +2147,27 @@ notification_t
 osdlp_ad_accept(struct tc_transfer_frame *tc_tf)
 {
 	notification_t notif;
+	uint32_t cnt;
+	/* The retransmission burst sends the next frames itself*/
+	if (tc_tf->cop_cfg.fop.rt_burst) {
+		return IGNORE;
+	}
 	/*E41*/
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_look_for_fdu(tc_tf);
 			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
+				fop_forward(tc_tf, notif, cnt);
 				return notif;
 			} else {
 				return tc_tf->cop_cfg.fop.signal;
 			}
 		case FOP_STATE_RT_NO_WAIT:
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_look_for_fdu(tc_tf);
 			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
+				fop_forward(tc_tf, notif, cnt);
 				return notif;
 			} else {
 				return tc_tf->cop_cfg.fop.signal;
@@ -2787,7 +2181,7 @@ osdlp_ad_accept(struct tc_transfer_frame *tc_tf)
 		case FOP_STATE_INIT:
 			return IGNORE;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2802,63 +2196,63 @@ osdlp_ad_reject(struct tc_transfer_frame *tc_tf)
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_NO_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_NO_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2867,6 +2261,7 @@ notification_t
 osdlp_bc_accept(struct tc_transfer_frame *tc_tf)
 {
 	notification_t notif;
+	uint32_t cnt;
 	/*E43*/
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
@@ -2878,9 +2273,10 @@ osdlp_bc_accept(struct tc_transfer_frame *tc_tf)
 		case FOP_STATE_INIT_NO_BC:
 			return IGNORE;
 		case FOP_STATE_INIT_BC:
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_look_for_directive(tc_tf);
 			if (!(notif == IGNORE)) {
-				tc_tf->cop_cfg.fop.signal = notif;
+				fop_forward(tc_tf, notif, cnt);
 				return notif;
 			} else {
 				return tc_tf->cop_cfg.fop.signal;
@@ -2888,7 +2284,7 @@ osdlp_bc_accept(struct tc_transfer_frame *tc_tf)
 		case FOP_STATE_INIT:
 			return IGNORE;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2903,63 +2299,63 @@ osdlp_bc_reject(struct tc_transfer_frame *tc_tf)
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_NO_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_NO_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -2970,25 +2366,25 @@ osdlp_bd_accept(struct tc_transfer_frame *tc_tf)
 	/*E45*/
 	switch (tc_tf->cop_cfg.fop.state) {
 		case FOP_STATE_ACTIVE:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		case FOP_STATE_RT_NO_WAIT:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		case FOP_STATE_RT_WAIT:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		case FOP_STATE_INIT_NO_BC:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		case FOP_STATE_INIT_BC:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		case FOP_STATE_INIT:
-			tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+			fop_signal(tc_tf, ACCEPT_TX);
 			return ACCEPT_TX;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
@@ -3003,63 +2399,63 @@ osdlp_bd_reject(struct tc_transfer_frame *tc_tf)
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_NO_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_RT_WAIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_NO_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT_BC:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
 			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		case FOP_STATE_INIT:
 			// Alert
 			ret = osdlp_alert(tc_tf);
 			if (ret < 0) {
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_signal(tc_tf, UNDEF_ERROR);
 				return UNDEF_ERROR;
 			}
-			tc_tf->cop_cfg.fop.signal = ALERT_LLIF;
+			fop_signal(tc_tf, ALERT_LLIF);
 			return ALERT_LLIF;
 		default:
-			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			fop_signal(tc_tf, UNDEF_ERROR);
 			return UNDEF_ERROR;
 	}
 }
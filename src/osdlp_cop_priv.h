@@ -0,0 +1,67 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SRC_OSDLP_COP_PRIV_H_
+#define SRC_OSDLP_COP_PRIV_H_
+
+#include "osdlp_tc.h"
+
+/*
+ * Helpers shared by the COP-1 and the TC service. They are not part of the
+ * public API.
+ */
+
+/**
+ * Reports a COP-1 notification to the higher layers, through the signal
+ * field and the notification callback of the virtual channel, if any
+ * @param tc_tf the TC configuration struct
+ * @param notif the notification
+ */
+static inline void
+fop_signal(struct tc_transfer_frame *tc_tf, notification_t notif)
+{
+	tc_tf->cop_cfg.fop.signal = notif;
+	if (notif == IGNORE) {
+		return;
+	}
+	tc_tf->notify_cnt++;
+	if (tc_tf->notify) {
+		tc_tf->notify(tc_tf, notif, tc_tf->notify_arg);
+	}
+}
+
+/**
+ * Passes on a notification returned by a function that may have reported
+ * it already
+ * @param tc_tf the TC configuration struct
+ * @param notif the notification
+ * @param cnt the notification count before calling that function
+ */
+static inline void
+fop_forward(struct tc_transfer_frame *tc_tf, notification_t notif,
+            uint32_t cnt)
+{
+	if (tc_tf->notify_cnt == cnt) {
+		fop_signal(tc_tf, notif);
+	} else {
+		tc_tf->cop_cfg.fop.signal = notif;
+	}
+}
+
+#endif /* SRC_OSDLP_COP_PRIV_H_ */
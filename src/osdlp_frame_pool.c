@@ -0,0 +1,95 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "osdlp_frame_pool.h"
+
+static inline uint16_t
+frame_index(const struct tc_frame_pool *pool, const uint8_t *frame)
+{
+	return (frame - pool->slab.base) / pool->frame_len;
+}
+
+int
+osdlp_frame_pool_init(struct tc_frame_pool *pool, uint8_t *storage,
+                      uint8_t *refcnt, uint16_t nframes, uint16_t frame_len)
+{
+	int ret = osdlp_slab_init_region(&pool->slab, storage, frame_len,
+	                                 nframes);
+	if (ret < 0) {
+		return ret;
+	}
+	pool->refcnt = refcnt;
+	pool->frame_len = frame_len;
+	pool->nframes = nframes;
+	memset(refcnt, 0, nframes);
+	return 0;
+}
+
+uint8_t *
+osdlp_frame_pool_alloc(struct tc_frame_pool *pool)
+{
+	uint8_t *frame = osdlp_slab_alloc(&pool->slab);
+	if (!frame) {
+		return NULL;
+	}
+	pool->refcnt[frame_index(pool, frame)] = 1;
+	return frame;
+}
+
+bool
+osdlp_frame_pool_owns(struct tc_frame_pool *pool, const uint8_t *frame)
+{
+	return osdlp_slab_owns(&pool->slab, frame);
+}
+
+void
+osdlp_frame_pool_ref(struct tc_frame_pool *pool, uint8_t *frame)
+{
+	pool->refcnt[frame_index(pool, frame)]++;
+}
+
+void
+osdlp_frame_pool_unref(struct tc_frame_pool *pool, uint8_t *frame)
+{
+	uint16_t idx = frame_index(pool, frame);
+	if (pool->refcnt[idx] == 0) {
+		return;
+	}
+	if (--pool->refcnt[idx] == 0) {
+		osdlp_slab_free(&pool->slab, frame);
+	}
+}
+
+void
+osdlp_frame_pool_attach(struct tc_transfer_frame *tc_tf,
+                        struct tc_frame_pool *pool)
+{
+	tc_tf->frame_pool = pool;
+}
+
+void
+osdlp_tc_tx_done(struct tc_transfer_frame *tc_tf, uint8_t *fdu)
+{
+	struct tc_frame_pool *pool = tc_tf->frame_pool;
+	if (pool && osdlp_frame_pool_owns(pool, fdu)) {
+		osdlp_frame_pool_unref(pool, fdu);
+	}
+}
@@ -0,0 +1,187 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_mpmc_queue.h"
+#include "osdlp_tc.h"
+
+/* Cell header fields*/
+#define CELL_SEQ        0
+#define CELL_LEN        4
+#define CELL_VCID       8
+
+static inline uint8_t *
+cell(const struct osdlp_mpmc_queue *q, uint32_t pos)
+{
+	return q->storage + (pos & q->mask) * q->stride;
+}
+
+static inline uint32_t *
+cell_field(uint8_t *c, uint32_t field)
+{
+	return (uint32_t *)(c + field);
+}
+
+static inline uint32_t
+cell_seq(uint8_t *c)
+{
+	return __atomic_load_n(cell_field(c, CELL_SEQ), __ATOMIC_ACQUIRE);
+}
+
+/* Moves a position counter from pos to pos + 1, unless another thread did*/
+static inline bool
+claim(uint32_t *counter, uint32_t *pos)
+{
+	return __atomic_compare_exchange_n(counter, pos, *pos + 1, true,
+	                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+int
+osdlp_mpmc_queue_init(struct osdlp_mpmc_queue *q, uint8_t *storage,
+                      uint32_t ncells, uint32_t slot_len, uint32_t vc_limit)
+{
+	if (!q || !storage || ncells < 2 || (ncells & (ncells - 1))
+	    || slot_len == 0) {
+		return -1;
+	}
+	memset(q, 0, sizeof(struct osdlp_mpmc_queue));
+	q->storage = storage;
+	q->mask = ncells - 1;
+	q->stride = MPMC_QUEUE_STRIDE(slot_len);
+	q->slot_len = slot_len;
+	q->vc_limit = vc_limit;
+	for (uint32_t i = 0; i < ncells; i++) {
+		*cell_field(cell(q, i), CELL_SEQ) = i;
+	}
+	return 0;
+}
+
+int
+osdlp_mpmc_queue_enqueue(struct osdlp_mpmc_queue *q, const uint8_t *frame,
+                         uint32_t length, uint16_t vcid)
+{
+	uint32_t *count;
+	uint32_t pos;
+	uint32_t seq;
+	int32_t diff;
+	uint8_t *c;
+
+	if (length > q->slot_len || vcid >= MPMC_QUEUE_MAX_VCS) {
+		return -1;
+	}
+	count = &q->vc_count[vcid];
+	if (__atomic_fetch_add(count, 1, __ATOMIC_RELAXED) >= q->vc_limit
+	    && q->vc_limit) {
+		__atomic_fetch_sub(count, 1, __ATOMIC_RELAXED);
+		return -1;
+	}
+	pos = __atomic_load_n(&q->enqueue_pos, __ATOMIC_RELAXED);
+	while (1) {
+		c = cell(q, pos);
+		seq = cell_seq(c);
+		diff = (int32_t)(seq - pos);
+		if (diff == 0) {
+			if (claim(&q->enqueue_pos, &pos)) {
+				break;
+			}
+		} else if (diff < 0) {
+			/* The cell still holds the frame of the previous lap*/
+			__atomic_fetch_sub(count, 1, __ATOMIC_RELAXED);
+			return -1;
+		} else {
+			pos = __atomic_load_n(&q->enqueue_pos,
+			                      __ATOMIC_RELAXED);
+		}
+	}
+	memcpy(c + MPMC_QUEUE_CELL_HDR, frame, length);
+	*cell_field(c, CELL_LEN) = length;
+	*cell_field(c, CELL_VCID) = vcid;
+	__atomic_store_n(cell_field(c, CELL_SEQ), pos + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+int
+osdlp_mpmc_queue_dequeue(struct osdlp_mpmc_queue *q, uint8_t *frame,
+                         uint32_t *length, uint16_t *vcid)
+{
+	uint32_t pos;
+	uint32_t seq;
+	uint32_t vc;
+	int32_t diff;
+	uint8_t *c;
+
+	pos = __atomic_load_n(&q->dequeue_pos, __ATOMIC_RELAXED);
+	while (1) {
+		c = cell(q, pos);
+		seq = cell_seq(c);
+		diff = (int32_t)(seq - (pos + 1));
+		if (diff == 0) {
+			if (claim(&q->dequeue_pos, &pos)) {
+				break;
+			}
+		} else if (diff < 0) {
+			return -1;
+		} else {
+			pos = __atomic_load_n(&q->dequeue_pos,
+			                      __ATOMIC_RELAXED);
+		}
+	}
+	*length = *cell_field(c, CELL_LEN);
+	vc = *cell_field(c, CELL_VCID);
+	memcpy(frame, c + MPMC_QUEUE_CELL_HDR, *length);
+	__atomic_store_n(cell_field(c, CELL_SEQ), pos + q->mask + 1,
+	                 __ATOMIC_RELEASE);
+	__atomic_fetch_sub(&q->vc_count[vc], 1, __ATOMIC_RELAXED);
+	if (vcid) {
+		*vcid = vc;
+	}
+	return 0;
+}
+
+bool
+osdlp_mpmc_queue_full(struct osdlp_mpmc_queue *q, uint16_t vcid)
+{
+	/* Dequeue first, so that it can not overtake the enqueue position*/
+	uint32_t deq = __atomic_load_n(&q->dequeue_pos, __ATOMIC_ACQUIRE);
+	uint32_t enq = __atomic_load_n(&q->enqueue_pos, __ATOMIC_ACQUIRE);
+	if (q->vc_limit && osdlp_mpmc_queue_count(q, vcid) >= q->vc_limit) {
+		return true;
+	}
+	return enq - deq > q->mask;
+}
+
+uint32_t
+osdlp_mpmc_queue_count(struct osdlp_mpmc_queue *q, uint16_t vcid)
+{
+	if (vcid >= MPMC_QUEUE_MAX_VCS) {
+		return 0;
+	}
+	return __atomic_load_n(&q->vc_count[vcid], __ATOMIC_RELAXED);
+}
+
+int
+osdlp_mpmc_queue_attach(struct tc_transfer_frame *tc_tf,
+                        struct osdlp_mpmc_queue *q)
+{
+	if (q && q->slot_len < tc_tf->mission.max_frame_len) {
+		return -1;
+	}
+	tc_tf->uplink = q;
+	return 0;
+}
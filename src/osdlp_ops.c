@@ -0,0 +1,238 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osdlp_ops.h"
+#include "osdlp_cop.h"
+#include "osdlp_tm.h"
+
+/* Adapters from the operations to the global hooks */
+
+static int
+tc_wait_queue_enqueue(void *user, void *item, uint16_t vcid)
+{
+	return osdlp_tc_wait_queue_enqueue(item, vcid);
+}
+
+static int
+tc_wait_queue_dequeue(void *user, void *item, uint16_t vcid)
+{
+	return osdlp_tc_wait_queue_dequeue(item, vcid);
+}
+
+static bool
+tc_wait_queue_empty(void *user, uint16_t vcid)
+{
+	return osdlp_tc_wait_queue_empty(vcid);
+}
+
+static int
+tc_wait_queue_clear(void *user, uint16_t vcid)
+{
+	return osdlp_tc_wait_queue_clear(vcid);
+}
+
+static int
+tc_sent_queue_enqueue(void *user, struct queue_item *item, uint16_t vcid)
+{
+	return osdlp_tc_sent_queue_enqueue(item, vcid);
+}
+
+static int
+tc_sent_queue_dequeue(void *user, struct queue_item *item, uint16_t vcid)
+{
+	return osdlp_tc_sent_queue_dequeue(item, vcid);
+}
+
+static bool
+tc_sent_queue_empty(void *user, uint16_t vcid)
+{
+	return osdlp_tc_sent_queue_empty(vcid);
+}
+
+static int
+tc_sent_queue_clear(void *user, uint16_t vcid)
+{
+	return osdlp_tc_sent_queue_clear(vcid);
+}
+
+static int
+tc_sent_queue_head(void *user, struct queue_item *item, uint16_t vcid)
+{
+	return osdlp_tc_sent_queue_head(item, vcid);
+}
+
+static int
+tc_mark_ad_as_rt(void *user, uint16_t vcid)
+{
+	return osdlp_mark_ad_as_rt(vcid);
+}
+
+static int
+tc_mark_bc_as_rt(void *user, uint16_t vcid)
+{
+	return osdlp_mark_bc_as_rt(vcid);
+}
+
+static int
+tc_reset_rt_frame(void *user, struct queue_item *item, uint16_t vcid)
+{
+	return osdlp_reset_rt_frame(item, vcid);
+}
+
+static int
+tc_get_first_ad_rt_frame(void *user, struct queue_item *item, uint16_t vcid)
+{
+	return osdlp_get_first_ad_rt_frame(item, vcid);
+}
+
+static bool
+tc_tx_queue_full(void *user, uint16_t vcid)
+{
+	return osdlp_tc_tx_queue_full(vcid);
+}
+
+static int
+tc_tx_queue_enqueue(void *user, uint8_t *buffer, uint16_t vcid)
+{
+	return osdlp_tc_tx_queue_enqueue(buffer, vcid);
+}
+
+static int
+tc_cancel_lower_ops(void *user, uint16_t vcid)
+{
+	return osdlp_cancel_lower_ops();
+}
+
+static int
+tc_timer_start(void *user, uint16_t vcid)
+{
+	return osdlp_timer_start(vcid);
+}
+
+static int
+tc_timer_cancel(void *user, uint16_t vcid)
+{
+	return osdlp_timer_cancel(vcid);
+}
+
+static bool
+tc_rx_queue_full(void *user, uint16_t vcid)
+{
+	return osdlp_tc_rx_queue_full(vcid);
+}
+
+static int
+tc_rx_queue_enqueue(void *user, uint8_t *buffer, uint32_t length,
+                    uint16_t vcid)
+{
+	return osdlp_tc_rx_queue_enqueue(buffer, length, vcid);
+}
+
+static int
+tc_rx_queue_enqueue_now(void *user, uint8_t *buffer, uint32_t length,
+                        uint16_t vcid)
+{
+	return osdlp_tc_rx_queue_enqueue_now(buffer, length, vcid);
+}
+
+const struct osdlp_tc_ops osdlp_tc_default_ops = {
+	.wait_queue_enqueue     = tc_wait_queue_enqueue,
+	.wait_queue_dequeue     = tc_wait_queue_dequeue,
+	.wait_queue_empty       = tc_wait_queue_empty,
+	.wait_queue_clear       = tc_wait_queue_clear,
+	.sent_queue_enqueue     = tc_sent_queue_enqueue,
+	.sent_queue_dequeue     = tc_sent_queue_dequeue,
+	.sent_queue_empty       = tc_sent_queue_empty,
+	.sent_queue_clear       = tc_sent_queue_clear,
+	.sent_queue_head        = tc_sent_queue_head,
+	.mark_ad_as_rt          = tc_mark_ad_as_rt,
+	.mark_bc_as_rt          = tc_mark_bc_as_rt,
+	.reset_rt_frame         = tc_reset_rt_frame,
+	.get_first_ad_rt_frame  = tc_get_first_ad_rt_frame,
+	.tx_queue_full          = tc_tx_queue_full,
+	.tx_queue_enqueue       = tc_tx_queue_enqueue,
+	.cancel_lower_ops       = tc_cancel_lower_ops,
+	.timer_start            = tc_timer_start,
+	.timer_cancel           = tc_timer_cancel,
+	.rx_queue_full          = tc_rx_queue_full,
+	.rx_queue_enqueue       = tc_rx_queue_enqueue,
+	.rx_queue_enqueue_now   = tc_rx_queue_enqueue_now
+};
+
+static bool
+tm_tx_queue_empty(void *user, uint8_t vcid)
+{
+	return osdlp_tm_tx_queue_empty(vcid);
+}
+
+static int
+tm_tx_queue_back(void *user, uint8_t **pkt, uint8_t vcid)
+{
+	return osdlp_tm_tx_queue_back(pkt, vcid);
+}
+
+static void
+tm_tx_commit_back(void *user, uint8_t vcid)
+{
+	osdlp_tm_tx_commit_back(vcid);
+}
+
+static int
+tm_tx_queue_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	return osdlp_tm_tx_queue_enqueue(pkt, vcid);
+}
+
+static int
+tm_rx_queue_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	return osdlp_tm_rx_queue_enqueue(pkt, vcid);
+}
+
+static int
+tm_get_packet_len(void *user, osdlp_sdu_len_t *length, uint8_t *pkt,
+                  osdlp_sdu_len_t mem_len)
+{
+	return osdlp_tm_get_packet_len(length, pkt, mem_len);
+}
+
+const struct osdlp_tm_ops osdlp_tm_default_ops = {
+	.tx_queue_empty     = tm_tx_queue_empty,
+	.tx_queue_back      = tm_tx_queue_back,
+	.tx_commit_back     = tm_tx_commit_back,
+	.tx_queue_enqueue   = tm_tx_queue_enqueue,
+	.rx_queue_enqueue   = tm_rx_queue_enqueue,
+	.get_packet_len     = tm_get_packet_len
+};
+
+void
+osdlp_tc_set_ops(struct tc_transfer_frame *tc_tf,
+                 const struct osdlp_tc_ops *ops, void *user)
+{
+	tc_tf->ops = ops ? ops : &osdlp_tc_default_ops;
+	tc_tf->user = user;
+}
+
+void
+osdlp_tm_set_ops(struct tm_transfer_frame *tm_tf,
+                 const struct osdlp_tm_ops *ops, void *user)
+{
+	tm_tf->ops = ops ? ops : &osdlp_tm_default_ops;
+	tm_tf->user = user;
+}
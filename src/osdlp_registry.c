@@ -0,0 +1,228 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "osdlp_cop.h"
+#include "osdlp_registry.h"
+
+static inline uint16_t
+registry_key(uint16_t scid, uint8_t vcid)
+{
+	return ((scid & 0x03ff) << 6) | (vcid & 0x3f);
+}
+
+/* Fibonacci hashing, keeps consecutive SCIDs apart */
+static inline uint32_t
+registry_hash(const struct tc_registry *reg, uint16_t key)
+{
+	return (uint32_t)(key * 2654435769u) >> reg->shift;
+}
+
+/**
+ * Returns the index of the slot holding the key, or the index of the first
+ * empty slot of its probe sequence
+ */
+static uint32_t
+registry_probe(const struct tc_registry *reg, uint16_t key)
+{
+	uint32_t i = registry_hash(reg, key);
+	while (reg->slots[i].tc_tf && reg->slots[i].key != key) {
+		i = (i + 1) & reg->mask;
+	}
+	return i;
+}
+
+int
+osdlp_tc_registry_init(struct tc_registry *reg, struct tc_registry_slot *slots,
+                       uint32_t nslots)
+{
+	uint8_t bits = 0;
+	if (nslots < 2 || (nslots & (nslots - 1))) {
+		return -1;
+	}
+	while ((1u << bits) < nslots) {
+		bits++;
+	}
+	memset(slots, 0, nslots * sizeof(struct tc_registry_slot));
+	reg->slots = slots;
+	reg->mask = nslots - 1;
+	reg->count = 0;
+	reg->shift = 32 - bits;
+	return 0;
+}
+
+int
+osdlp_tc_registry_add(struct tc_registry *reg, struct tc_transfer_frame *tc_tf)
+{
+	uint16_t key = registry_key(tc_tf->mission.spacecraft_id,
+	                            tc_tf->mission.vcid);
+	uint32_t i;
+	/* Keep the load factor below 3/4 so that probe sequences stay short */
+	if ((reg->count + 1) * 4 > (reg->mask + 1) * 3) {
+		return -1;
+	}
+	i = registry_probe(reg, key);
+	if (reg->slots[i].tc_tf) {
+		return -1;
+	}
+	reg->slots[i].key = key;
+	reg->slots[i].tc_tf = tc_tf;
+	reg->count++;
+	return 0;
+}
+
+int
+osdlp_tc_registry_remove(struct tc_registry *reg, uint16_t scid, uint8_t vcid)
+{
+	uint32_t i = registry_probe(reg, registry_key(scid, vcid));
+	uint32_t j;
+	uint32_t home;
+	if (!reg->slots[i].tc_tf) {
+		return -1;
+	}
+	/*
+	 * Backward shift deletion. Entries following the removed one are moved
+	 * back if their home slot does not lie cyclically in (i, j], so that
+	 * no tombstones are needed
+	 */
+	j = i;
+	while (1) {
+		reg->slots[i].tc_tf = NULL;
+		do {
+			j = (j + 1) & reg->mask;
+			if (!reg->slots[j].tc_tf) {
+				reg->count--;
+				return 0;
+			}
+			home = registry_hash(reg, reg->slots[j].key);
+		} while (((j - home) & reg->mask) < ((j - i) & reg->mask));
+		reg->slots[i] = reg->slots[j];
+		i = j;
+	}
+}
+
+struct tc_transfer_frame *
+osdlp_tc_registry_lookup(struct tc_registry *reg, uint16_t scid, uint8_t vcid)
+{
+	return reg->slots[registry_probe(reg, registry_key(scid, vcid))].tc_tf;
+}
+
+void
+osdlp_tc_registry_foreach(struct tc_registry *reg,
+                          void (*fn)(struct tc_transfer_frame *, void *),
+                          void *arg)
+{
+	for (uint32_t i = 0; i <= reg->mask; i++) {
+		if (reg->slots[i].tc_tf) {
+			fn(reg->slots[i].tc_tf, arg);
+		}
+	}
+}
+
+int
+osdlp_tc_registry_receive(struct tc_registry *reg, uint8_t *rx_buffer,
+                          uint32_t length, struct tc_transfer_frame **tc_tf)
+{
+	int ret;
+	uint16_t scid;
+	struct tc_transfer_frame *tf;
+	if (length < 3) {
+		return -TC_RX_FRAME_LEN_ERR;
+	}
+	scid = ((rx_buffer[0] & 0x03) << 8) | rx_buffer[1];
+	tf = osdlp_tc_registry_lookup(reg, scid, rx_buffer[2] >> 2);
+	if (tc_tf) {
+		*tc_tf = tf;
+	}
+	if (!tf) {
+		return -TC_RX_CONFIG_ERR;
+	}
+	ret = osdlp_tc_rx_validate(tf, rx_buffer, length);
+	if (ret < 0) {
+		return ret;
+	}
+	return osdlp_tc_rx_process(tf);
+}
+
+notification_t
+osdlp_tc_registry_handle_clcw(struct tc_registry *reg, uint16_t scid,
+                              uint8_t *ocf_buffer)
+{
+	struct tc_transfer_frame *tc_tf;
+	tc_tf = osdlp_tc_registry_lookup(reg, scid, ocf_buffer[1] >> 2);
+	if (!tc_tf) {
+		return UNDEF_ERROR;
+	}
+	return osdlp_handle_clcw(tc_tf, ocf_buffer);
+}
+
+/* A CLCW that only acknowledges frames */
+static inline bool
+clcw_plain(const uint8_t *ocf)
+{
+	return (ocf[2] & 0x38) == 0;
+}
+
+static uint32_t
+clcw_process(struct tc_registry *reg, uint16_t scid, uint8_t *ocf)
+{
+	struct tc_transfer_frame *tc_tf;
+	bool handled;
+	tc_tf = osdlp_tc_registry_lookup(reg, scid, ocf[1] >> 2);
+	if (!tc_tf) {
+		return 0;
+	}
+	osdlp_handle_clcw_once(tc_tf, ocf, &handled);
+	return handled ? 1 : 0;
+}
+
+uint32_t
+osdlp_tc_registry_handle_clcw_batch(struct tc_registry *reg, uint16_t scid,
+                                    uint8_t *ocf_buffers, uint32_t count)
+{
+	/* The CLCW of each VC that is waiting to be processed */
+	uint8_t *pending[64] = {NULL};
+	uint8_t *ocf;
+	uint8_t *prev;
+	uint32_t n = 0;
+	uint8_t vcid;
+
+	for (uint32_t i = 0; i < count; i++) {
+		ocf = ocf_buffers + 4 * i;
+		vcid = ocf[1] >> 2;
+		prev = pending[vcid];
+		pending[vcid] = ocf;
+		if (!prev) {
+			continue;
+		}
+		if (clcw_plain(prev) && clcw_plain(ocf)
+		    && (uint8_t)(ocf[3] - prev[3]) < 128) {
+			continue;
+		}
+		n += clcw_process(reg, scid, prev);
+	}
+	for (uint8_t v = 0; v < 64; v++) {
+		if (pending[v]) {
+			n += clcw_process(reg, scid, pending[v]);
+		}
+	}
+	return n;
+}
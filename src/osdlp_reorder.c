@@ -0,0 +1,95 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "osdlp_reorder.h"
+#include "osdlp_randomizer.h"
+#include "osdlp_tm.h"
+
+int
+osdlp_reorder_init(struct osdlp_reorder *r, struct tm_transfer_frame *tm_tf,
+                   struct osdlp_rx_job *jobs, uint8_t *storage,
+                   uint32_t nslots, bool derandomize)
+{
+	if (!r || !tm_tf || !jobs || !storage || nslots == 0
+	    || (nslots & (nslots - 1))) {
+		return -1;
+	}
+	r->head = 0;
+	r->tail = 0;
+	r->errors = 0;
+	r->jobs = jobs;
+	r->mask = nslots - 1;
+	r->derandomize = derandomize;
+	r->tm_tf = tm_tf;
+	for (uint32_t i = 0; i < nslots; i++) {
+		jobs[i].owner = r;
+		jobs[i].frame = storage + i * TM_FRAME_SIZE(tm_tf);
+		jobs[i].status = 0;
+		jobs[i].done = 0;
+	}
+	return 0;
+}
+
+struct osdlp_rx_job *
+osdlp_reorder_reserve(struct osdlp_reorder *r)
+{
+	uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+	if (r->head - tail > r->mask) {
+		return NULL;
+	}
+	return &r->jobs[r->head++ & r->mask];
+}
+
+void
+osdlp_rx_job_run(struct osdlp_rx_job *job)
+{
+	struct osdlp_reorder *r = job->owner;
+	if (r->derandomize) {
+		osdlp_tm_randomize(job->frame, TM_FRAME_SIZE(r->tm_tf));
+	}
+	job->status = osdlp_tm_rx_verify(r->tm_tf, job->frame);
+	__atomic_store_n(&job->done, 1, __ATOMIC_RELEASE);
+}
+
+uint32_t
+osdlp_reorder_drain(struct osdlp_reorder *r, uint32_t max)
+{
+	struct osdlp_rx_job *job;
+	uint32_t n = 0;
+	int ret;
+
+	while (n < max) {
+		job = &r->jobs[r->tail & r->mask];
+		if (!__atomic_load_n(&job->done, __ATOMIC_ACQUIRE)) {
+			break;
+		}
+		ret = job->status;
+		if (ret == 0) {
+			ret = osdlp_tm_rx_verified(r->tm_tf, job->frame);
+		}
+		if (ret < 0 && ret != -TM_RX_PENDING) {
+			r->errors++;
+		}
+		job->done = 0;
+		__atomic_store_n(&r->tail, r->tail + 1, __ATOMIC_RELEASE);
+		n++;
+	}
+	return n;
+}
@@ -0,0 +1,165 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_rx_pipeline.h"
+#include "osdlp_tc.h"
+#include "osdlp_tm.h"
+
+static inline int
+frame_vcid(const struct osdlp_rx_pipeline *p, const uint8_t *frame,
+           uint32_t length)
+{
+	int vcid;
+	if (p->type == OSDLP_RX_PIPELINE_TC) {
+		vcid = length < 3 ? -1 : (frame[2] >> 2) & 0x3f;
+	} else {
+		vcid = length < 2 ? -1 : (frame[1] >> 1) & 0x07;
+	}
+	return vcid < RX_PIPELINE_MAX_VCS ? vcid : -1;
+}
+
+int
+osdlp_rx_pipeline_init(struct osdlp_rx_pipeline *p,
+                       osdlp_rx_pipeline_type_t type,
+                       struct osdlp_rx_lane *lanes, uint8_t nlanes)
+{
+	if (!p || !lanes || nlanes == 0 || nlanes == RX_PIPELINE_NO_LANE) {
+		return -1;
+	}
+	p->type = type;
+	p->nlanes = nlanes;
+	memset(p->lane_of, RX_PIPELINE_NO_LANE, sizeof(p->lane_of));
+	memset(p->ctx, 0, sizeof(p->ctx));
+	memset(lanes, 0, nlanes * sizeof(struct osdlp_rx_lane));
+	p->lanes = lanes;
+	p->unknown = 0;
+	return 0;
+}
+
+int
+osdlp_rx_pipeline_lane_init(struct osdlp_rx_pipeline *p, uint8_t lane,
+                            uint8_t *storage, uint32_t nslots,
+                            uint32_t slot_len)
+{
+	if (lane >= p->nlanes) {
+		return -1;
+	}
+	return osdlp_spsc_ring_init(&p->lanes[lane].ring, storage, nslots,
+	                            slot_len);
+}
+
+static int
+add_vc(struct osdlp_rx_pipeline *p, uint8_t lane, uint8_t vcid, void *ctx,
+       uint32_t frame_len)
+{
+	if (lane >= p->nlanes || vcid >= RX_PIPELINE_MAX_VCS
+	    || p->lanes[lane].ring.slot_len < frame_len) {
+		return -1;
+	}
+	p->ctx[vcid] = ctx;
+	p->lane_of[vcid] = lane;
+	return 0;
+}
+
+int
+osdlp_rx_pipeline_add_tc(struct osdlp_rx_pipeline *p, uint8_t lane,
+                         struct tc_transfer_frame *tc_tf)
+{
+	if (p->type != OSDLP_RX_PIPELINE_TC) {
+		return -1;
+	}
+	return add_vc(p, lane, tc_tf->mission.vcid, tc_tf,
+	              tc_tf->mission.max_frame_len);
+}
+
+int
+osdlp_rx_pipeline_add_tm(struct osdlp_rx_pipeline *p, uint8_t lane,
+                         struct tm_transfer_frame *tm_tf)
+{
+	if (p->type != OSDLP_RX_PIPELINE_TM) {
+		return -1;
+	}
+	return add_vc(p, lane, tm_tf->mission.vcid, tm_tf,
+	              TM_FRAME_SIZE(tm_tf));
+}
+
+int
+osdlp_rx_pipeline_dispatch(struct osdlp_rx_pipeline *p, const uint8_t *frame,
+                           uint32_t length)
+{
+	struct osdlp_rx_lane *lane;
+	int vcid = frame_vcid(p, frame, length);
+	if (vcid < 0 || p->lane_of[vcid] == RX_PIPELINE_NO_LANE) {
+		p->unknown++;
+		return -1;
+	}
+	lane = &p->lanes[p->lane_of[vcid]];
+	if (osdlp_spsc_ring_push(&lane->ring, frame, length) < 0) {
+		lane->dropped++;
+		return -1;
+	}
+	return 0;
+}
+
+/* Runs the receive logic of the virtual channel of a frame */
+static int
+receive(struct osdlp_rx_pipeline *p, uint8_t *frame, uint32_t length)
+{
+	struct tm_transfer_frame *tm_tf;
+	struct tc_transfer_frame *tc_tf;
+	int vcid = frame_vcid(p, frame, length);
+	int ret;
+	if (p->type == OSDLP_RX_PIPELINE_TM) {
+		tm_tf = p->ctx[vcid];
+		/* A short frame would be completed with stale slot data */
+		if (length != TM_FRAME_SIZE(tm_tf)) {
+			return -TM_RX_ERROR;
+		}
+		return osdlp_tm_rx_frame(tm_tf, frame);
+	}
+	tc_tf = p->ctx[vcid];
+	ret = osdlp_tc_rx_validate(tc_tf, frame, length);
+	if (ret < 0) {
+		return ret;
+	}
+	return osdlp_tc_rx_process(tc_tf);
+}
+
+uint32_t
+osdlp_rx_pipeline_work(struct osdlp_rx_pipeline *p, uint8_t lane,
+                       uint32_t max)
+{
+	struct osdlp_rx_lane *l = &p->lanes[lane];
+	uint32_t length;
+	uint32_t n = 0;
+	uint8_t *frame;
+	while (n < max) {
+		frame = osdlp_spsc_ring_peek(&l->ring, &length);
+		if (!frame) {
+			break;
+		}
+		if (receive(p, frame, length) < 0) {
+			l->errors++;
+		}
+		osdlp_spsc_ring_release(&l->ring);
+		n++;
+	}
+	return n;
+}
@@ -0,0 +1,315 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_frame_pool.h"
+#include "osdlp_sent_ring.h"
+
+static uint16_t
+fdu_len(const struct tc_sent_ring *ring, const uint8_t *fdu)
+{
+	uint16_t len = (((fdu[2] & 0x03) << 8) | fdu[3]) + 1;
+	return len > ring->slot_len ? ring->slot_len : len;
+}
+
+static inline uint8_t *
+slot_fdu(const struct tc_sent_ring *ring, uint16_t slot)
+{
+	if (ring->pool) {
+		return ring->refs[slot];
+	}
+	return ring->storage + (uint32_t)slot * ring->slot_len;
+}
+
+/* Copies the frame into a slot or, for a shared ring, references it */
+static int
+slot_store(struct tc_sent_ring *ring, uint16_t slot, uint8_t *fdu)
+{
+	if (!ring->pool) {
+		memcpy(slot_fdu(ring, slot), fdu, fdu_len(ring, fdu));
+		return 0;
+	}
+	if (!osdlp_frame_pool_owns(ring->pool, fdu)) {
+		return -1;
+	}
+	osdlp_frame_pool_ref(ring->pool, fdu);
+	ring->refs[slot] = fdu;
+	return 0;
+}
+
+static inline void
+slot_drop(struct tc_sent_ring *ring, uint16_t slot)
+{
+	if (ring->pool) {
+		osdlp_frame_pool_unref(ring->pool, ring->refs[slot]);
+	}
+}
+
+/* Sets or clears n bits of the bitmap starting at bit from. No wrap around */
+static void
+rt_update(struct tc_sent_ring *ring, uint16_t from, uint16_t n, bool set)
+{
+	uint16_t off;
+	uint16_t k;
+	uint64_t m;
+	while (n > 0) {
+		off = from & 63;
+		k = 64 - off;
+		if (k > n) {
+			k = n;
+		}
+		m = (k == 64 ? ~0ULL : ((1ULL << k) - 1)) << off;
+		if (set) {
+			ring->rt[from >> 6] |= m;
+		} else {
+			ring->rt[from >> 6] &= ~m;
+		}
+		from += k;
+		n -= k;
+	}
+}
+
+/* Same as rt_update() but wraps around the end of the ring */
+static void
+rt_update_cyclic(struct tc_sent_ring *ring, uint16_t from, uint16_t n,
+                 bool set)
+{
+	uint16_t nslots = ring->mask + 1;
+	if (from + n > nslots) {
+		rt_update(ring, from, nslots - from, set);
+		rt_update(ring, 0, from + n - nslots, set);
+	} else {
+		rt_update(ring, from, n, set);
+	}
+}
+
+/* Returns the first set bit in [from, to) or -1 */
+static int
+rt_find(const struct tc_sent_ring *ring, uint16_t from, uint16_t to)
+{
+	uint64_t w;
+	uint16_t pos;
+	while (from < to) {
+		w = ring->rt[from >> 6] & (~0ULL << (from & 63));
+		if (w) {
+			pos = (from & ~63) + __builtin_ctzll(w);
+			return pos < to ? pos : -1;
+		}
+		from = (from & ~63) + 64;
+	}
+	return -1;
+}
+
+int
+osdlp_sent_ring_init(struct tc_sent_ring *ring, uint8_t *storage,
+                     uint16_t nslots, uint16_t slot_len)
+{
+	if (nslots == 0 || nslots > SENT_RING_MAX_SLOTS
+	    || (nslots & (nslots - 1))) {
+		return -1;
+	}
+	ring->storage = storage;
+	ring->pool = NULL;
+	ring->refs = NULL;
+	ring->slot_len = slot_len;
+	ring->mask = nslots - 1;
+	ring->count = 0;
+	ring->bc_held = 0;
+	osdlp_sent_ring_clear(ring);
+	return 0;
+}
+
+int
+osdlp_sent_ring_init_shared(struct tc_sent_ring *ring,
+                            struct tc_frame_pool *pool, uint8_t **refs,
+                            uint16_t nslots)
+{
+	if (!pool || !refs) {
+		return -1;
+	}
+	if (osdlp_sent_ring_init(ring, NULL, nslots, pool->frame_len)) {
+		return -1;
+	}
+	ring->pool = pool;
+	ring->refs = refs;
+	return 0;
+}
+
+int
+osdlp_sent_ring_enqueue(struct tc_sent_ring *ring, struct queue_item *item)
+{
+	uint16_t slot;
+	if (item->type == TYPE_B) {
+		if (ring->bc_held) {
+			return -1;
+		}
+		if (slot_store(ring, ring->mask + 1, item->fdu)) {
+			return -1;
+		}
+		ring->bc_held = 1;
+		ring->bc_rt = item->rt_flag;
+		ring->bc_seq_num = item->seq_num;
+		return 0;
+	}
+	if (ring->count > ring->mask) {
+		return -1;
+	}
+	slot = item->seq_num & ring->mask;
+	if (slot_store(ring, slot, item->fdu)) {
+		return -1;
+	}
+	if (ring->count == 0) {
+		ring->head = item->seq_num;
+	}
+	rt_update(ring, slot, 1, item->rt_flag == RT_FLAG_ON);
+	ring->count++;
+	return 0;
+}
+
+int
+osdlp_sent_ring_head(struct tc_sent_ring *ring, struct queue_item *item)
+{
+	if (ring->bc_held) {
+		item->fdu = slot_fdu(ring, ring->mask + 1);
+		item->rt_flag = ring->bc_rt;
+		item->seq_num = ring->bc_seq_num;
+		item->type = TYPE_B;
+		return 0;
+	}
+	if (ring->count == 0) {
+		return -1;
+	}
+	item->fdu = slot_fdu(ring, ring->head & ring->mask);
+	item->rt_flag = rt_find(ring, ring->head & ring->mask,
+	                        (ring->head & ring->mask) + 1) >= 0;
+	item->seq_num = ring->head;
+	item->type = TYPE_A;
+	return 0;
+}
+
+int
+osdlp_sent_ring_dequeue(struct tc_sent_ring *ring)
+{
+	if (ring->bc_held) {
+		slot_drop(ring, ring->mask + 1);
+		ring->bc_held = 0;
+		ring->bc_rt = RT_FLAG_OFF;
+		return 0;
+	}
+	if (ring->count == 0) {
+		return -1;
+	}
+	osdlp_sent_ring_release(ring, ring->head + 1, 1);
+	return 0;
+}
+
+uint16_t
+osdlp_sent_ring_release(struct tc_sent_ring *ring, uint8_t nr, uint16_t max)
+{
+	uint16_t n = (uint8_t)(nr - ring->head);
+	if (n > ring->count) {
+		n = ring->count;
+	}
+	if (n > max) {
+		n = max;
+	}
+	rt_update_cyclic(ring, ring->head & ring->mask, n, false);
+	if (ring->pool) {
+		for (uint16_t i = 0; i < n; i++) {
+			slot_drop(ring, (ring->head + i) & ring->mask);
+		}
+	}
+	ring->head += n;
+	ring->count -= n;
+	return n;
+}
+
+bool
+osdlp_sent_ring_empty(struct tc_sent_ring *ring)
+{
+	return ring->count == 0 && !ring->bc_held;
+}
+
+void
+osdlp_sent_ring_clear(struct tc_sent_ring *ring)
+{
+	for (uint16_t i = 0; ring->pool && i < ring->count; i++) {
+		slot_drop(ring, (ring->head + i) & ring->mask);
+	}
+	if (ring->bc_held) {
+		slot_drop(ring, ring->mask + 1);
+	}
+	ring->count = 0;
+	ring->head = 0;
+	ring->bc_held = 0;
+	ring->bc_rt = RT_FLAG_OFF;
+	ring->bc_seq_num = 0;
+	memset(ring->rt, 0, sizeof(ring->rt));
+}
+
+void
+osdlp_sent_ring_mark_ad_as_rt(struct tc_sent_ring *ring)
+{
+	rt_update_cyclic(ring, ring->head & ring->mask, ring->count, true);
+}
+
+int
+osdlp_sent_ring_mark_bc_as_rt(struct tc_sent_ring *ring)
+{
+	if (!ring->bc_held) {
+		return -1;
+	}
+	ring->bc_rt = RT_FLAG_ON;
+	return 0;
+}
+
+int
+osdlp_sent_ring_first_ad_rt(struct tc_sent_ring *ring, struct queue_item *item)
+{
+	uint16_t start = ring->head & ring->mask;
+	int slot = rt_find(ring, start, ring->mask + 1);
+	if (slot < 0) {
+		slot = rt_find(ring, 0, start);
+	}
+	if (slot < 0) {
+		return -1;
+	}
+	item->fdu = slot_fdu(ring, slot);
+	item->rt_flag = RT_FLAG_ON;
+	item->seq_num = ring->head + ((slot - start) & ring->mask);
+	item->type = TYPE_A;
+	return 0;
+}
+
+void
+osdlp_sent_ring_reset_rt(struct tc_sent_ring *ring, struct queue_item *item)
+{
+	if (item->type == TYPE_B) {
+		ring->bc_rt = RT_FLAG_OFF;
+	} else {
+		rt_update(ring, item->seq_num & ring->mask, 1, false);
+	}
+}
+
+void
+osdlp_sent_ring_attach(struct tc_transfer_frame *tc_tf,
+                       struct tc_sent_ring *ring)
+{
+	tc_tf->sent_ring = ring;
+}
@@ -0,0 +1,155 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "osdlp_spsc_ring.h"
+#include "osdlp_tc.h"
+#include "osdlp_tm.h"
+
+static inline uint8_t *
+slot(const struct osdlp_spsc_ring *ring, uint32_t idx)
+{
+	return ring->storage + (idx & ring->mask) * ring->stride;
+}
+
+int
+osdlp_spsc_ring_init(struct osdlp_spsc_ring *ring, uint8_t *storage,
+                     uint32_t nslots, uint32_t slot_len)
+{
+	if (!ring || !storage || nslots == 0 || (nslots & (nslots - 1))
+	    || slot_len == 0) {
+		return -1;
+	}
+	memset(ring, 0, sizeof(struct osdlp_spsc_ring));
+	ring->storage = storage;
+	ring->mask = nslots - 1;
+	ring->stride = SPSC_RING_STRIDE(slot_len);
+	ring->slot_len = slot_len;
+	return 0;
+}
+
+uint8_t *
+osdlp_spsc_ring_reserve(struct osdlp_spsc_ring *ring)
+{
+	uint32_t tail = ring->tail;
+	if (tail - ring->head_cache > ring->mask) {
+		ring->head_cache = __atomic_load_n(&ring->head,
+		                                   __ATOMIC_ACQUIRE);
+		if (tail - ring->head_cache > ring->mask) {
+			return NULL;
+		}
+	}
+	return slot(ring, tail) + sizeof(uint32_t);
+}
+
+void
+osdlp_spsc_ring_commit(struct osdlp_spsc_ring *ring, uint32_t length)
+{
+	uint32_t tail = ring->tail;
+	*(uint32_t *)slot(ring, tail) = length;
+	__atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+uint8_t *
+osdlp_spsc_ring_peek(struct osdlp_spsc_ring *ring, uint32_t *length)
+{
+	uint32_t head = ring->head;
+	uint8_t *s;
+	if (head == ring->tail_cache) {
+		ring->tail_cache = __atomic_load_n(&ring->tail,
+		                                   __ATOMIC_ACQUIRE);
+		if (head == ring->tail_cache) {
+			return NULL;
+		}
+	}
+	s = slot(ring, head);
+	*length = *(uint32_t *)s;
+	return s + sizeof(uint32_t);
+}
+
+void
+osdlp_spsc_ring_release(struct osdlp_spsc_ring *ring)
+{
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+int
+osdlp_spsc_ring_push(struct osdlp_spsc_ring *ring, const uint8_t *frame,
+                     uint32_t length)
+{
+	uint8_t *s;
+	if (length > ring->slot_len) {
+		return -1;
+	}
+	s = osdlp_spsc_ring_reserve(ring);
+	if (!s) {
+		return -1;
+	}
+	memcpy(s, frame, length);
+	osdlp_spsc_ring_commit(ring, length);
+	return 0;
+}
+
+int
+osdlp_spsc_ring_pop(struct osdlp_spsc_ring *ring, uint8_t *frame,
+                    uint32_t *length)
+{
+	uint8_t *s = osdlp_spsc_ring_peek(ring, length);
+	if (!s) {
+		return -1;
+	}
+	memcpy(frame, s, *length);
+	osdlp_spsc_ring_release(ring);
+	return 0;
+}
+
+bool
+osdlp_spsc_ring_full(struct osdlp_spsc_ring *ring)
+{
+	return ring->tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)
+	       > ring->mask;
+}
+
+bool
+osdlp_spsc_ring_empty(struct osdlp_spsc_ring *ring)
+{
+	return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == ring->head;
+}
+
+int
+osdlp_spsc_ring_attach_tc_rx(struct tc_transfer_frame *tc_tf,
+                             struct osdlp_spsc_ring *ring)
+{
+	if (ring && ring->slot_len < tc_tf->mission.max_sdu_len) {
+		return -1;
+	}
+	tc_tf->rx_ring = ring;
+	return 0;
+}
+
+int
+osdlp_spsc_ring_attach_tm_tx(struct tm_transfer_frame *tm_tf,
+                             struct osdlp_spsc_ring *ring)
+{
+	if (ring && ring->slot_len < TM_FRAME_SIZE(tm_tf)) {
+		return -1;
+	}
+	tm_tf->tx_ring = ring;
+	return 0;
+}
@@ -17,20 +17,34 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include "osdlp_clcw.h"
 #include "osdlp_cop.h"
+#include "osdlp_cop_priv.h"
 #include "osdlp_crc.h"
+#include "osdlp_ops.h"
+#include "osdlp_mpmc_queue.h"
+#include "osdlp_spsc_ring.h"
 #include "osdlp_tc.h"
+#include "osdlp_trace.h"
 
-#define	TC_TRANSFER_FRAME_PRIMARY_HEADER		5
+#define	TC_TRANSFER_FRAME_PRIMARY_HEADER		TC_PRIMARY_HDR_LEN
+
+/* The per-frame state fits in the first cache line, the pointers in the next*/
+OSDLP_STATIC_ASSERT(offsetof(struct tc_transfer_frame, cop_cfg)
+                    + sizeof(struct cop_config) <= OSDLP_CACHE_LINE,
+                    tc_hot_state);
+OSDLP_STATIC_ASSERT(offsetof(struct tc_transfer_frame, uplink)
+                    + sizeof(void *) <= 2 * OSDLP_CACHE_LINE,
+                    tc_hot_pointers);
 
 int
 osdlp_tc_init(struct tc_transfer_frame *tc_tf,
               uint16_t scid,
-              uint16_t max_sdu_len,
+              osdlp_sdu_len_t max_sdu_len,
               uint16_t max_frame_len,
               uint16_t rx_fifo_size,
               uint8_t vcid,
@@ -45,10 +59,20 @@ osdlp_tc_init(struct tc_transfer_frame *tc_tf,
 	if (max_frame_len <= TC_TRANSFER_FRAME_PRIMARY_HEADER) {
 		return -1;
 	}
+#ifdef OSDLP_TC_CRC
+	if (crc_flag != OSDLP_TC_CRC) {
+		return -1;
+	}
+#endif
+#ifdef OSDLP_TC_SEG_HDR
+	if (seg_hdr_flag != OSDLP_TC_SEG_HDR) {
+		return -1;
+	}
+#endif
 	struct tc_mission_params m;
 	tc_tf->primary_hdr.version_num          = TC_VERSION_NUMBER;
 	tc_tf->primary_hdr.spacecraft_id        = scid & 0x03ff;
-	tc_tf->primary_hdr.vcid                 = vcid;
+	tc_tf->primary_hdr.vcid                 = vcid & 0x3f;
 	tc_tf->primary_hdr.bypass               = bypass;
 	tc_tf->primary_hdr.ctrl_cmd             = ctrl_cmd;
 	tc_tf->primary_hdr.frame_len            = 0;
@@ -84,9 +108,28 @@ osdlp_tc_init(struct tc_transfer_frame *tc_tf,
 	tc_tf->cop_cfg                          = cop;
 	tc_tf->seg_status.flag                  = SEG_ENDED;
 	tc_tf->seg_status.octets_txed           = 0;
+	tc_tf->sent_ring                        = NULL;
+	tc_tf->frame_pool                       = NULL;
+	tc_tf->timer_wheel                      = NULL;
+	tc_tf->timer                            = NULL;
+	tc_tf->ops                              = &osdlp_tc_default_ops;
+	tc_tf->user                             = NULL;
+	tc_tf->rx_ring                          = NULL;
+	tc_tf->uplink                           = NULL;
+	tc_tf->notify                           = NULL;
+	tc_tf->notify_arg                       = NULL;
+	tc_tf->notify_cnt                       = 0;
 	return 0;
 }
 
+void
+osdlp_tc_set_notify(struct tc_transfer_frame *tc_tf,
+                    osdlp_tc_notify_t notify, void *arg)
+{
+	tc_tf->notify = notify;
+	tc_tf->notify_arg = arg;
+}
+
 void
 osdlp_tc_unpack(struct tc_transfer_frame *tc_tf,  uint8_t *pkt_in)
 {
@@ -104,9 +147,9 @@ osdlp_tc_unpack(struct tc_transfer_frame *tc_tf,  uint8_t *pkt_in)
 	tc_tf->primary_hdr      = tc_p_hdr;
 
 	tc_tf->frame_data.data_len = tc_p_hdr.frame_len + 1 -
-	                             tc_tf->mission.fixed_overhead_len;
+	                             TC_OVERHEAD_LEN(tc_tf);
 
-	if (tc_tf->mission.seg_hdr_flag) {
+	if (TC_SEG_HDR_FLAG(tc_tf)) {
 		tc_tf->frame_data.seg_hdr.seq_flag  = (pkt_in[5] >> 6) & 0x03;
 		tc_tf->frame_data.seg_hdr.map_id    = pkt_in[5] & 0x3f;
 		tc_tf->frame_data.data = &pkt_in[6];
@@ -114,7 +157,7 @@ osdlp_tc_unpack(struct tc_transfer_frame *tc_tf,  uint8_t *pkt_in)
 	} else {
 		tc_tf->frame_data.data = &pkt_in[5];
 	}
-	if (tc_tf->mission.crc_flag == TC_CRC_PRESENT) {
+	if (TC_CRC_FLAG(tc_tf) == TC_CRC_PRESENT) {
 		tc_tf->crc = pkt_in[tc_p_hdr.frame_len - 1] << 8;
 		tc_tf->crc |= pkt_in[tc_p_hdr.frame_len];
 	}
@@ -123,12 +166,28 @@ osdlp_tc_unpack(struct tc_transfer_frame *tc_tf,  uint8_t *pkt_in)
 void
 osdlp_tc_pack(struct tc_transfer_frame *tc_tf, uint8_t *pkt_out,
               uint8_t *data_in, uint16_t length)
+{
+	struct tc_frame_work work;
+	work.bypass = tc_tf->primary_hdr.bypass;
+	work.ctrl_cmd = tc_tf->primary_hdr.ctrl_cmd;
+	work.seq_num = tc_tf->cop_cfg.fop.vs;
+	work.seq_flag = tc_tf->frame_data.seg_hdr.seq_flag;
+	osdlp_tc_pack_frame(tc_tf, &work, pkt_out, data_in, length);
+	if (TC_CRC_FLAG(tc_tf) == TC_CRC_PRESENT) {
+		tc_tf->crc = work.crc;
+	}
+}
+
+void
+osdlp_tc_pack_frame(const struct tc_transfer_frame *tc_tf,
+                    struct tc_frame_work *work, uint8_t *pkt_out,
+                    const uint8_t *data_in, uint16_t length)
 {
 	uint16_t crc = 0;
-	uint16_t packet_len = tc_tf->mission.fixed_overhead_len + length - 1;
+	uint16_t packet_len = TC_OVERHEAD_LEN(tc_tf) + length - 1;
 	pkt_out[0] = ((tc_tf->primary_hdr.version_num & 0x03) << 6);
-	pkt_out[0] |= ((tc_tf->primary_hdr.bypass & 0x01) << 5);
-	pkt_out[0] |= ((tc_tf->primary_hdr.ctrl_cmd & 0x01) << 4);
+	pkt_out[0] |= ((work->bypass & 0x01) << 5);
+	pkt_out[0] |= ((work->ctrl_cmd & 0x01) << 4);
 	pkt_out[0] |= ((tc_tf->primary_hdr.rsvd_spare & 0x03) << 2);
 	pkt_out[0] |= ((tc_tf->primary_hdr.spacecraft_id >> 8) & 0x03);
 
@@ -139,24 +198,24 @@ osdlp_tc_pack(struct tc_transfer_frame *tc_tf, uint8_t *pkt_out,
 	pkt_out[2] |= ((packet_len >> 8) & 0x03);
 	pkt_out[3] = packet_len & 0xff;
 
-	if (tc_tf->primary_hdr.bypass == TYPE_A) {
-		pkt_out[4] = tc_tf->cop_cfg.fop.vs & 0xff;
+	if (work->bypass == TYPE_A) {
+		pkt_out[4] = work->seq_num;
 	} else {
 		pkt_out[4] = 0;
 	}
-	if (tc_tf->mission.seg_hdr_flag) {
-		pkt_out[5] = ((tc_tf->frame_data.seg_hdr.seq_flag & 0x03) << 6);
+	if (TC_SEG_HDR_FLAG(tc_tf)) {
+		pkt_out[5] = ((work->seq_flag & 0x03) << 6);
 		pkt_out[5] |= (tc_tf->frame_data.seg_hdr.map_id & 0x3f);
 		memcpy(&pkt_out[6], data_in, length * sizeof(uint8_t));
 	} else {
 		memcpy(&pkt_out[5], data_in, length * sizeof(uint8_t));
 	}
-	if (tc_tf->mission.crc_flag == TC_CRC_PRESENT) {
+	if (TC_CRC_FLAG(tc_tf) == TC_CRC_PRESENT) {
 		crc = osdlp_calc_crc(pkt_out, packet_len - 1);
 		pkt_out[packet_len - 1] = (crc >> 8) & 0xff;
 		pkt_out[packet_len] = crc & 0xff;
-		tc_tf->crc = crc;
 	}
+	work->crc = crc;
 }
 
 int
@@ -169,7 +228,7 @@ osdlp_frame_validation_check(struct tc_transfer_frame *tc_tf,
 	if (tc_tf->mission.spacecraft_id != tc_tf->primary_hdr.spacecraft_id) {
 		return -1;
 	}
-	if (tc_tf->mission.crc_flag) {
+	if (TC_CRC_FLAG(tc_tf)) {
 		uint16_t crc = osdlp_calc_crc(rx_buffer, tc_tf->primary_hdr.frame_len - 1);
 		uint16_t rx_crc;
 		rx_crc = (rx_buffer[tc_tf->primary_hdr.frame_len - 1] & 0xff) << 8;
@@ -181,38 +240,160 @@ osdlp_frame_validation_check(struct tc_transfer_frame *tc_tf,
 	return 0;
 }
 
+/**
+ * Validates the frame against the configuration of its virtual channel and
+ * fills only the fields needed by the FARM-1 and the reassembly logic.
+ * The version number and the spacecraft ID are checked with a single compare
+ * on the header word, so that foreign frames are rejected before the data
+ * field or the CRC are touched.
+ */
+static int
+tc_rx_decode(struct tc_transfer_frame *tc_tf, uint32_t hdr,
+             uint8_t *rx_buffer)
+{
+	uint32_t mcid = ((tc_tf->mission.version_num & 0x03) << 14)
+	                | (tc_tf->mission.spacecraft_id & 0x03ff);
+	uint16_t frame_len = hdr & 0x03ff;
+	if (((hdr >> 16) & 0xc3ff) != mcid) {
+		return -TC_RX_FRAME_VAL_ERR;
+	}
+	if (frame_len + 1 < TC_OVERHEAD_LEN(tc_tf)) {
+		return -TC_RX_FRAME_LEN_ERR;
+	}
+	if (TC_CRC_FLAG(tc_tf) == TC_CRC_PRESENT) {
+		uint16_t rx_crc = (rx_buffer[frame_len - 1] << 8)
+		                  | rx_buffer[frame_len];
+		if (osdlp_calc_crc(rx_buffer, frame_len - 1) != rx_crc) {
+			return -TC_RX_FRAME_VAL_ERR;
+		}
+		tc_tf->crc = rx_crc;
+	}
+	tc_tf->primary_hdr.bypass           = (hdr >> 29) & 0x01;
+	tc_tf->primary_hdr.ctrl_cmd         = (hdr >> 28) & 0x01;
+	tc_tf->primary_hdr.vcid             = (hdr >> 10) & 0x3f;
+	tc_tf->primary_hdr.frame_len        = frame_len;
+	tc_tf->primary_hdr.frame_seq_num    = rx_buffer[4];
+
+	tc_tf->frame_data.data_len = frame_len + 1 -
+	                             TC_OVERHEAD_LEN(tc_tf);
+	if (TC_SEG_HDR_FLAG(tc_tf)) {
+		tc_tf->frame_data.seg_hdr.seq_flag = (rx_buffer[5] >> 6) & 0x03;
+		tc_tf->frame_data.seg_hdr.map_id = rx_buffer[5] & 0x3f;
+		tc_tf->frame_data.data = &rx_buffer[6];
+	} else {
+		tc_tf->frame_data.data = &rx_buffer[5];
+	}
+	return 0;
+}
+
+/**
+ * Delimits the frame and loads the first four octets of the primary header
+ * in a single word
+ */
+static int
+tc_rx_delimit(uint32_t *hdr, uint8_t *rx_buffer, uint32_t length)
+{
+	if (length < TC_TRANSFER_FRAME_PRIMARY_HEADER) {
+		return -TC_RX_FRAME_LEN_ERR;
+	}
+	*hdr = ((uint32_t)rx_buffer[0] << 24) | ((uint32_t)rx_buffer[1] << 16)
+	       | ((uint32_t)rx_buffer[2] << 8) | rx_buffer[3];
+	if ((*hdr & 0x03ff) + 1 > length) {
+		return -TC_RX_FRAME_LEN_ERR;
+	}
+	return 0;
+}
+
 int
-osdlp_tc_receive(uint8_t *rx_buffer, uint32_t length)
+osdlp_tc_rx_decode(struct tc_transfer_frame **tc_tf, uint8_t *rx_buffer,
+                   uint32_t length)
 {
 	int ret;
-	farm_result_t farm_ret;
+	uint32_t hdr;
 	/* Delimiting */
-	uint16_t frame_len = (rx_buffer[2] & 0x03) << 8;
-	frame_len |= (rx_buffer[3] & 0xff);
-	if (((frame_len + 1) > length) || (length < TC_TRANSFER_FRAME_PRIMARY_HEADER)) {
-		return -TC_RX_FRAME_LEN_ERR;
+	ret = tc_rx_delimit(&hdr, rx_buffer, length);
+	if (ret < 0) {
+		return ret;
 	}
 
 	/* Frame Validation Checks */
-	uint8_t vcid = ((rx_buffer[2] >> 2) & 0x3f);
-	struct tc_transfer_frame *tc_tf;
-	ret = osdlp_tc_get_rx_config(&tc_tf, vcid);
+	ret = osdlp_tc_get_rx_config(tc_tf, (hdr >> 10) & 0x3f);
 	if (ret < 0) {
 		return -TC_RX_CONFIG_ERR;
 	}
+	return tc_rx_decode(*tc_tf, hdr, rx_buffer);
+}
 
-	osdlp_tc_unpack(tc_tf, rx_buffer);
+int
+osdlp_tc_rx_validate(struct tc_transfer_frame *tc_tf, uint8_t *rx_buffer,
+                     uint32_t length)
+{
+	int ret;
+	uint32_t hdr;
+	ret = tc_rx_delimit(&hdr, rx_buffer, length);
+	if (ret < 0) {
+		return ret;
+	}
+	if (((hdr >> 10) & 0x3f) != tc_tf->mission.vcid) {
+		return -TC_RX_CONFIG_ERR;
+	}
+	return tc_rx_decode(tc_tf, hdr, rx_buffer);
+}
 
-	ret = osdlp_frame_validation_check(tc_tf, rx_buffer);
+int
+osdlp_tc_receive(uint8_t *rx_buffer, uint32_t length)
+{
+	int ret;
+	struct tc_transfer_frame *tc_tf;
+	ret = osdlp_tc_rx_decode(&tc_tf, rx_buffer, length);
 	if (ret < 0) {
-		return -TC_RX_FRAME_VAL_ERR;
+		osdlp_trace_record(OSDLP_TRACE_TC_RX,
+		                   length > 2 ? rx_buffer[2] >> 2 : 0xff, -ret,
+		                   0, 0, 0, 0, 0);
+		return ret;
 	}
+	return osdlp_tc_rx_process(tc_tf);
+}
+
+static inline bool
+tx_queue_full(struct tc_transfer_frame *tc_tf)
+{
+	if (tc_tf->uplink) {
+		return osdlp_mpmc_queue_full(tc_tf->uplink,
+		                             tc_tf->primary_hdr.vcid);
+	}
+	return tc_tf->ops->tx_queue_full(tc_tf->user, tc_tf->primary_hdr.vcid);
+}
+
+/* Passes a received SDU to the higher layers */
+static int
+rx_queue_enqueue(struct tc_transfer_frame *tc_tf, farm_result_t farm_ret,
+                 uint32_t length)
+{
+	const struct osdlp_tc_ops *ops = tc_tf->ops;
+	uint8_t *sdu = tc_tf->mission.util.buffer;
+	if (tc_tf->rx_ring) {
+		return osdlp_spsc_ring_push(tc_tf->rx_ring, sdu, length);
+	}
+	if (farm_ret == COP_ENQ) {
+		return ops->rx_queue_enqueue(tc_tf->user, sdu, length,
+		                             tc_tf->primary_hdr.vcid);
+	}
+	return ops->rx_queue_enqueue_now(tc_tf->user, sdu, length,
+	                                 tc_tf->primary_hdr.vcid);
+}
+
+int
+osdlp_tc_rx_process(struct tc_transfer_frame *tc_tf)
+{
+	int ret;
+	farm_result_t farm_ret;
 
 	/* Perform FARM-1 */
 	farm_ret = osdlp_farm_1(tc_tf);
 	if (farm_ret == COP_ENQ || farm_ret == COP_PRIORITY_ENQ) {
 		/* Handle segmentation */
-		if (tc_tf->mission.seg_hdr_flag) {
+		if (TC_SEG_HDR_FLAG(tc_tf)) {
 			switch (tc_tf->frame_data.seg_hdr.seq_flag) {
 				case TC_UNSEG:
 					if (tc_tf->frame_data.data_len > tc_tf->mission.max_data_len) {
@@ -221,15 +402,8 @@ osdlp_tc_receive(uint8_t *rx_buffer, uint32_t length)
 					memcpy(tc_tf->mission.util.buffer,
 					       tc_tf->frame_data.data,
 					       tc_tf->frame_data.data_len * sizeof(uint8_t));
-					if (farm_ret == COP_ENQ) {
-						ret = osdlp_tc_rx_queue_enqueue(tc_tf->mission.util.buffer,
-						                                tc_tf->frame_data.data_len,
-						                                vcid);
-					} else {
-						ret = osdlp_tc_rx_queue_enqueue_now(tc_tf->mission.util.buffer,
-						                                    tc_tf->frame_data.data_len,
-						                                    vcid);
-					}
+					ret = rx_queue_enqueue(tc_tf, farm_ret,
+					                       tc_tf->frame_data.data_len);
 					tc_tf->mission.util.buffered_length = 0;
 					tc_tf->mission.util.loop_state = TC_LOOP_CLOSED;
 					if (ret < 0) {
@@ -267,15 +441,9 @@ osdlp_tc_receive(uint8_t *rx_buffer, uint32_t length)
 					memcpy(&tc_tf->mission.util.buffer[tc_tf->mission.util.buffered_length],
 					       tc_tf->frame_data.data,
 					       tc_tf->frame_data.data_len * sizeof(uint8_t));
-					if (farm_ret == COP_ENQ) {
-						ret = osdlp_tc_rx_queue_enqueue(tc_tf->mission.util.buffer,
-						                                tc_tf->mission.util.buffered_length + tc_tf->frame_data.data_len,
-						                                vcid);
-					} else {
-						ret = osdlp_tc_rx_queue_enqueue_now(tc_tf->mission.util.buffer,
-						                                    tc_tf->mission.util.buffered_length + tc_tf->frame_data.data_len,
-						                                    vcid);
-					}
+					ret = rx_queue_enqueue(tc_tf, farm_ret,
+					                       tc_tf->mission.util.buffered_length
+					                       + tc_tf->frame_data.data_len);
 					tc_tf->mission.util.loop_state = TC_LOOP_CLOSED;
 					if (ret < 0) {
 						return -TC_RX_QUEUE_ERR;
@@ -310,15 +478,8 @@ osdlp_tc_receive(uint8_t *rx_buffer, uint32_t length)
 			memcpy(tc_tf->mission.util.buffer,
 			       tc_tf->frame_data.data,
 			       tc_tf->frame_data.data_len * sizeof(uint8_t));
-			if (farm_ret == COP_ENQ) {
-				ret = osdlp_tc_rx_queue_enqueue(tc_tf->mission.util.buffer,
-				                                tc_tf->frame_data.data_len,
-				                                vcid);
-			} else {
-				ret = osdlp_tc_rx_queue_enqueue_now(tc_tf->mission.util.buffer,
-				                                    tc_tf->frame_data.data_len,
-				                                    vcid);
-			}
+			ret = rx_queue_enqueue(tc_tf, farm_ret,
+			                       tc_tf->frame_data.data_len);
 			tc_tf->mission.util.buffered_length = 0;
 			tc_tf->mission.util.loop_state = TC_LOOP_CLOSED;
 			if (ret < 0) {
@@ -343,9 +504,12 @@ int
 osdlp_tc_transmit(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
                   uint32_t length)
 {
-	uint16_t remaining = length;
+	uint32_t remaining = length;
 	uint16_t bytes_avail = 0;
 	notification_t notif;
+	struct fop_config *fop = &tc_tf->cop_cfg.fop;
+	uint32_t cnt = tc_tf->notify_cnt;
+	uint8_t fop_state;
 	if (tc_tf->seg_status.flag) {
 		remaining = length - tc_tf->seg_status.octets_txed;
 	}
@@ -371,15 +535,21 @@ osdlp_tc_transmit(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
 			}
 		}
 
-		tc_tf->primary_hdr.frame_len = tc_tf->mission.fixed_overhead_len + bytes_avail -
+		tc_tf->primary_hdr.frame_len = TC_OVERHEAD_LEN(tc_tf) + bytes_avail -
 		                               1;
 		tc_tf->frame_data.data_len = bytes_avail;
 		tc_tf->frame_data.data = buffer + (length - remaining);
 
-		if (!osdlp_tc_tx_queue_full(tc_tf->primary_hdr.vcid)) {
+		if (!tx_queue_full(tc_tf)) {
+			fop_state = fop->state;
+			cnt = tc_tf->notify_cnt;
 			notif = osdlp_req_transfer_fdu(tc_tf);
+			osdlp_trace_record(OSDLP_TRACE_TC_TX,
+			                   tc_tf->primary_hdr.vcid, notif,
+			                   fop_state, fop->state, fop->vs,
+			                   fop->nnr, 0);
 		} else {
-			tc_tf->cop_cfg.fop.signal = REJECT_TX;
+			fop_signal(tc_tf, REJECT_TX);
 			return -TC_TX_COP_ERR;
 		}
 		remaining -= bytes_avail;
@@ -388,7 +558,7 @@ osdlp_tc_transmit(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
 			case REJECT_TX:
 				tc_tf->seg_status.flag = SEG_ENDED;
 				tc_tf->seg_status.octets_txed = 0;
-				tc_tf->cop_cfg.fop.signal = REJECT_TX;
+				fop_forward(tc_tf, REJECT_TX, cnt);
 				return -TC_TX_COP_ERR;
 			case DELAY_RESP:
 				if (remaining > 0) {
@@ -412,16 +582,16 @@ osdlp_tc_transmit(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
 			case UNDEF_ERROR:
 				tc_tf->seg_status.flag = SEG_ENDED;
 				tc_tf->seg_status.octets_txed = 0;
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_forward(tc_tf, UNDEF_ERROR, cnt);
 				return -TC_TX_COP_ERR;
 			default:
 				tc_tf->seg_status.flag = SEG_ENDED;
 				tc_tf->seg_status.octets_txed = 0;
-				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				fop_forward(tc_tf, UNDEF_ERROR, cnt);
 				return -TC_TX_COP_ERR;
 		}
 	}
-	tc_tf->cop_cfg.fop.signal = ACCEPT_TX;
+	fop_forward(tc_tf, ACCEPT_TX, cnt);
 	return TC_TX_OK;
 }
 
@@ -433,7 +603,7 @@ osdlp_prepare_typea_data_frame(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
 	tc_tf->primary_hdr.ctrl_cmd = TC_DATA;
 	tc_tf->frame_data.data = buffer;
 	tc_tf->frame_data.data_len = len;
-	tc_tf->frame_data.seg_hdr.map_id = mapid;
+	tc_tf->frame_data.seg_hdr.map_id = mapid & 0x3f;
 }
 
 void
@@ -444,7 +614,7 @@ osdlp_prepare_typeb_data_frame(struct tc_transfer_frame *tc_tf, uint8_t *buffer,
 	tc_tf->primary_hdr.ctrl_cmd = TC_DATA;
 	tc_tf->frame_data.data = buffer;
 	tc_tf->frame_data.data_len = len;
-	tc_tf->frame_data.seg_hdr.map_id = mapid;
+	tc_tf->frame_data.seg_hdr.map_id = mapid & 0x3f;
 }
 
 void
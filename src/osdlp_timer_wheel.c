@@ -0,0 +1,143 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "osdlp_cop.h"
+#include "osdlp_timer_wheel.h"
+
+static inline void
+timer_link(struct tc_timer **head, struct tc_timer *timer)
+{
+	timer->next = *head;
+	if (timer->next) {
+		timer->next->pprev = &timer->next;
+	}
+	timer->pprev = head;
+	*head = timer;
+}
+
+static inline void
+timer_unlink(struct tc_timer *timer)
+{
+	*timer->pprev = timer->next;
+	if (timer->next) {
+		timer->next->pprev = timer->pprev;
+	}
+	timer->next = NULL;
+	timer->pprev = NULL;
+}
+
+int
+osdlp_timer_wheel_init(struct tc_timer_wheel *wheel, struct tc_timer **slots,
+                       uint32_t nslots)
+{
+	if (nslots == 0 || (nslots & (nslots - 1))) {
+		return -1;
+	}
+	memset(slots, 0, nslots * sizeof(struct tc_timer *));
+	wheel->slots = slots;
+	wheel->mask = nslots - 1;
+	wheel->now = 0;
+	wheel->running = 0;
+	return 0;
+}
+
+void
+osdlp_timer_wheel_attach(struct tc_transfer_frame *tc_tf,
+                         struct tc_timer_wheel *wheel, struct tc_timer *timer)
+{
+	if (tc_tf->timer_wheel && tc_tf->timer) {
+		osdlp_timer_wheel_cancel(tc_tf->timer_wheel, tc_tf->timer);
+	}
+	tc_tf->timer_wheel = wheel;
+	tc_tf->timer = wheel ? timer : NULL;
+	if (tc_tf->timer) {
+		timer->next = NULL;
+		timer->pprev = NULL;
+		timer->tc_tf = tc_tf;
+	}
+}
+
+void
+osdlp_timer_wheel_start(struct tc_timer_wheel *wheel, struct tc_timer *timer,
+                        uint32_t ticks)
+{
+	osdlp_timer_wheel_cancel(wheel, timer);
+	if (ticks == 0) {
+		ticks = 1;
+	}
+	timer->expires = wheel->now + ticks;
+	timer_link(&wheel->slots[timer->expires & wheel->mask], timer);
+	wheel->running++;
+}
+
+void
+osdlp_timer_wheel_cancel(struct tc_timer_wheel *wheel, struct tc_timer *timer)
+{
+	if (timer->pprev) {
+		timer_unlink(timer);
+		wheel->running--;
+	}
+}
+
+bool
+osdlp_timer_wheel_running(const struct tc_timer *timer)
+{
+	return timer->pprev != NULL;
+}
+
+uint32_t
+osdlp_timer_wheel_advance(struct tc_timer_wheel *wheel, uint32_t ticks)
+{
+	struct tc_timer *expired = NULL;
+	struct tc_timer *timer;
+	struct tc_timer *next;
+	uint32_t n = 0;
+
+	while (ticks-- > 0) {
+		wheel->now++;
+		if (wheel->running == 0) {
+			wheel->now += ticks;
+			break;
+		}
+		timer = wheel->slots[wheel->now & wheel->mask];
+		while (timer) {
+			next = timer->next;
+			if (timer->expires == wheel->now) {
+				timer_unlink(timer);
+				timer_link(&expired, timer);
+			}
+			timer = next;
+		}
+	}
+
+	/*
+	 * The expired timers are still linked, so that a handler cancelling
+	 * or restarting one of them takes it off the list
+	 */
+	while (expired) {
+		timer = expired;
+		timer_unlink(timer);
+		wheel->running--;
+		osdlp_handle_timer_expired(timer->tc_tf);
+		n++;
+	}
+	return n;
+}
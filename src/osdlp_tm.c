@@ -17,10 +17,17 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include "osdlp_ops.h"
+#include "osdlp_spsc_ring.h"
 #include "osdlp_tm.h"
 
+/* The fields used for every frame fit in the first cache line*/
+OSDLP_STATIC_ASSERT(offsetof(struct tm_transfer_frame, tx_ring)
+                    + sizeof(void *) <= OSDLP_CACHE_LINE, tm_hot_fields);
+
 int
 osdlp_tm_init(struct tm_transfer_frame *tm_tf,
               uint16_t spacecraft_id,
@@ -34,7 +41,7 @@ osdlp_tm_init(struct tm_transfer_frame *tm_tf,
               uint8_t *sec_hdr,
               tm_crc_flag_t crc_flag,
               uint16_t frame_size,
-              uint16_t max_sdu_len,
+              osdlp_sdu_len_t max_sdu_len,
               uint16_t max_vcs,
               uint16_t max_fifo_size,
               tm_stuff_state_t stuffing,
@@ -43,13 +50,34 @@ osdlp_tm_init(struct tm_transfer_frame *tm_tf,
 	if (frame_size <= TM_PRIMARY_HDR_LEN) {
 		return -1;
 	}
+#ifdef OSDLP_TM_CRC
+	if (crc_flag != OSDLP_TM_CRC) {
+		return -1;
+	}
+#endif
+#ifdef OSDLP_TM_OCF
+	if (ocf_flag != OSDLP_TM_OCF) {
+		return -1;
+	}
+#endif
+#ifdef OSDLP_TM_STUFFING
+	if (stuffing != OSDLP_TM_STUFFING) {
+		return -1;
+	}
+#endif
+#ifdef OSDLP_TM_FRAME_LEN
+	if (frame_size != OSDLP_TM_FRAME_LEN) {
+		return -1;
+	}
+#endif
 	struct tm_mission_params m;
 	tm_tf->primary_hdr.mcid.version_num 	= TM_VERSION_NUMBER;
 	tm_tf->primary_hdr.mcid.spacecraft_id 	= spacecraft_id & 0x03ff;
-	tm_tf->primary_hdr.vcid 				= vcid;
+	tm_tf->primary_hdr.vcid 				= vcid & 0x07;
 	tm_tf->primary_hdr.ocf 					= ocf_flag & 0x01;
 	tm_tf->primary_hdr.mc_frame_cnt			= mc_count;
 	tm_tf->primary_hdr.vc_frame_cnt 		= 0;
+	tm_tf->claim_lock                       = 0;
 	tm_tf->primary_hdr.status.sec_hdr 		= sec_hdr_fleg & 0x01;
 	tm_tf->primary_hdr.status.sync 			= sync_flag & 0x01;
 	tm_tf->primary_hdr.status.pkt_order		= 0;
@@ -80,7 +108,7 @@ osdlp_tm_init(struct tm_transfer_frame *tm_tf,
 		occupied += tm_tf->secondary_hdr.sec_hdr_id.length + 1;
 		occupied_header = occupied;
 	}
-	if (tm_tf->primary_hdr.ocf == TM_OCF_PRESENT) {
+	if (TM_OCF_FLAG(tm_tf) == TM_OCF_PRESENT) {
 		occupied += TM_OCF_LENGTH;
 	}
 	if (m.crc_present == TM_CRC_PRESENT) {
@@ -90,6 +118,9 @@ osdlp_tm_init(struct tm_transfer_frame *tm_tf,
 	m.max_data_len = m.frame_len - occupied;
 	m.header_len = occupied_header;
 	tm_tf->mission = m;
+	tm_tf->ops = &osdlp_tm_default_ops;
+	tm_tf->user = NULL;
+	tm_tf->tx_ring = NULL;
 	return 0;
 }
 
@@ -97,21 +128,52 @@ void
 osdlp_tm_pack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_out,
               uint8_t *data_in, uint16_t length)
 {
+	struct tm_frame_work work;
+	work.mc_frame_cnt = *tm_tf->primary_hdr.mc_frame_cnt;
+	work.vc_frame_cnt = tm_tf->primary_hdr.vc_frame_cnt;
+	work.first_hdr_ptr = tm_tf->primary_hdr.status.first_hdr_ptr;
+	osdlp_tm_pack_frame(tm_tf, &work, pkt_out, data_in, length);
+	if (TM_CRC_FLAG(tm_tf) == TM_CRC_PRESENT) {
+		tm_tf->crc = work.crc;
+	}
+}
+
+void
+osdlp_tm_claim_frame(struct tm_transfer_frame *tm_tf,
+                     struct tm_frame_work *work, uint16_t first_hdr_ptr)
+{
+	uint8_t *mc_cnt = tm_tf->primary_hdr.mc_frame_cnt;
+	while (__atomic_test_and_set(&tm_tf->claim_lock, __ATOMIC_ACQUIRE)) {
+		/* Held for two increments only*/
+	}
+	/* The counters are octets, so they wrap around at 256 on their own*/
+	work->mc_frame_cnt = __atomic_add_fetch(mc_cnt, 1, __ATOMIC_RELAXED);
+	work->vc_frame_cnt = ++tm_tf->primary_hdr.vc_frame_cnt;
+	__atomic_clear(&tm_tf->claim_lock, __ATOMIC_RELEASE);
+	work->first_hdr_ptr = first_hdr_ptr;
+}
+
+void
+osdlp_tm_pack_frame(const struct tm_transfer_frame *tm_tf,
+                    struct tm_frame_work *work, uint8_t *pkt_out,
+                    const uint8_t *data_in, uint16_t length)
+{
+	uint16_t crc = 0;
 	pkt_out[0] = ((tm_tf->primary_hdr.mcid.version_num & 0x03) << 6);
 	pkt_out[0] |= ((tm_tf->primary_hdr.mcid.spacecraft_id >> 4) & 0x3f);
 	pkt_out[1] = ((tm_tf->primary_hdr.mcid.spacecraft_id & 0x0f) << 4);
 	pkt_out[1] |= ((tm_tf->primary_hdr.vcid & 0x07) << 1);
 	pkt_out[1] |= (tm_tf->primary_hdr.ocf & 0x01);
 
-	pkt_out[2] = (*tm_tf->primary_hdr.mc_frame_cnt & 0xff);
-	pkt_out[3] = (tm_tf->primary_hdr.vc_frame_cnt & 0xff);
+	pkt_out[2] = work->mc_frame_cnt;
+	pkt_out[3] = work->vc_frame_cnt;
 
 	pkt_out[4] = ((tm_tf->primary_hdr.status.sec_hdr & 0x01) << 7);
 	pkt_out[4] |= ((tm_tf->primary_hdr.status.sync & 0x01) << 6);
 	pkt_out[4] |= ((tm_tf->primary_hdr.status.pkt_order & 0x01) << 5);
 	pkt_out[4] |= ((tm_tf->primary_hdr.status.seg_len_id & 0x03) << 3);
-	pkt_out[4] |= ((tm_tf->primary_hdr.status.first_hdr_ptr >> 8) & 0x07);
-	pkt_out[5] = tm_tf->primary_hdr.status.first_hdr_ptr & 0xff;
+	pkt_out[4] |= ((work->first_hdr_ptr >> 8) & 0x07);
+	pkt_out[5] = work->first_hdr_ptr & 0xff;
 
 	if (tm_tf->primary_hdr.status.sec_hdr == TM_SEC_HDR_PRESENT) {
 		pkt_out[6] = ((tm_tf->secondary_hdr.sec_hdr_id.version_num &
@@ -125,7 +187,7 @@ osdlp_tm_pack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_out,
 		       data_in, length * sizeof(uint8_t));
 	}
 	/* Add OCF */
-	if (tm_tf->primary_hdr.ocf == TM_OCF_PRESENT) {
+	if (TM_OCF_FLAG(tm_tf) == TM_OCF_PRESENT) {
 		memcpy(&pkt_out[tm_tf->mission.header_len + tm_tf->mission.max_data_len],
 		       tm_tf->ocf, 4 * sizeof(uint8_t));
 	}
@@ -138,29 +200,30 @@ osdlp_tm_pack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_out,
 	}
 
 	/* Add CRC */
-	if (tm_tf->mission.crc_present == TM_CRC_PRESENT) {
-		uint16_t crc = 0;
-		pkt_out[tm_tf->mission.frame_len - 2] = 0;
-		pkt_out[tm_tf->mission.frame_len - 1] = 0;
-		crc = osdlp_calc_crc(pkt_out, tm_tf->mission.frame_len - 2);
+	if (TM_CRC_FLAG(tm_tf) == TM_CRC_PRESENT) {
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 2] = 0;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 1] = 0;
+		crc = osdlp_calc_crc(pkt_out, TM_FRAME_SIZE(tm_tf) - 2);
 
-		pkt_out[tm_tf->mission.frame_len - 2] = (crc >> 8) & 0xff;
-		pkt_out[tm_tf->mission.frame_len - 1] = crc & 0xff;
-		tm_tf->crc = crc;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 2] = (crc >> 8) & 0xff;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 1] = crc & 0xff;
 	}
-
-
+	work->crc = crc;
 }
 
-void
-osdlp_tm_unpack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_in)
+/*
+ * Unpacks the fields of a frame that belong to its virtual channel. The
+ * master channel frame count is shared by all the virtual channels, so it
+ * is left untouched and virtual channels can be received concurrently
+ */
+static void
+unpack_vc(struct tm_transfer_frame *tm_tf, uint8_t *pkt_in)
 {
 	tm_tf->primary_hdr.mcid.version_num 	= ((pkt_in[0] >> 6) && 0x03);
 	tm_tf->primary_hdr.mcid.spacecraft_id 	= ((pkt_in[0] & 0x3f) << 4) | ((
 	                        pkt_in[1] >> 4) & 0x0f);
 	tm_tf->primary_hdr.vcid 				= (pkt_in[1] >> 1) & 0x07;
 	tm_tf->primary_hdr.ocf	 				= pkt_in[1] & 0x01;
-	*tm_tf->primary_hdr.mc_frame_cnt 		= pkt_in[2];
 	tm_tf->primary_hdr.vc_frame_cnt 		= pkt_in[3];
 	tm_tf->primary_hdr.status.sec_hdr 		= (pkt_in[4] >> 7) & 0x01;
 	tm_tf->primary_hdr.status.sync 			= (pkt_in[4] >> 6) & 0x01;
@@ -174,29 +237,90 @@ osdlp_tm_unpack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_in)
 	}
 	tm_tf->data = &pkt_in[tm_tf->mission.header_len];
 
-	if (tm_tf->primary_hdr.ocf == TM_OCF_PRESENT) {
+	if (TM_OCF_FLAG(tm_tf) == TM_OCF_PRESENT) {
 		memcpy(tm_tf->ocf, &pkt_in[tm_tf->mission.header_len +
 		                                                     tm_tf->mission.max_data_len],
 		       4 * sizeof(uint8_t));
 	}
-	if (tm_tf->mission.crc_present == TM_CRC_PRESENT) {
+	if (TM_CRC_FLAG(tm_tf) == TM_CRC_PRESENT) {
 		//tm_tf->crc = calc_crc(pkt_)
-		tm_tf->crc = pkt_in[tm_tf->mission.frame_len - 2] << 8;
-		tm_tf->crc |= pkt_in[tm_tf->mission.frame_len - 1];
+		tm_tf->crc = pkt_in[TM_FRAME_SIZE(tm_tf) - 2] << 8;
+		tm_tf->crc |= pkt_in[TM_FRAME_SIZE(tm_tf) - 1];
+	}
+}
+
+void
+osdlp_tm_unpack(struct tm_transfer_frame *tm_tf, uint8_t *pkt_in)
+{
+	*tm_tf->primary_hdr.mc_frame_cnt = pkt_in[2];
+	unpack_vc(tm_tf, pkt_in);
+}
+
+/* Passes the reassembled packet of the util buffer to the higher layers */
+static inline int
+rx_queue_enqueue(struct tm_transfer_frame *tm_tf)
+{
+	return tm_tf->ops->rx_queue_enqueue(tm_tf->user,
+	                                    tm_tf->mission.util.buffer,
+	                                    tm_tf->mission.vcid);
+}
+
+/*
+ * TX frame buffers. With a ring attached frames are packed in place into
+ * its slots, otherwise in the util buffer.
+ */
+static inline uint8_t *
+tx_frame_alloc(struct tm_transfer_frame *tm_tf)
+{
+	if (tm_tf->tx_ring) {
+		return osdlp_spsc_ring_reserve(tm_tf->tx_ring);
+	}
+	return tm_tf->mission.util.buffer;
+}
+
+static inline int
+tx_queue_enqueue(struct tm_transfer_frame *tm_tf, uint8_t *frame,
+                 uint8_t vcid)
+{
+	uint32_t frame_len = TM_FRAME_SIZE(tm_tf);
+	if (!frame) {
+		return -1;
+	}
+	if (tm_tf->tx_ring) {
+		osdlp_spsc_ring_commit(tm_tf->tx_ring, frame_len);
+		return 0;
 	}
+	return tm_tf->ops->tx_queue_enqueue(tm_tf->user, frame, vcid);
+}
+
+/* Frames of a ring may be in use by the consumer, so they are never reused */
+static inline bool
+tx_queue_empty(struct tm_transfer_frame *tm_tf, uint8_t vcid)
+{
+	if (tm_tf->tx_ring) {
+		return true;
+	}
+	return tm_tf->ops->tx_queue_empty(tm_tf->user, vcid);
+}
+
+static inline int
+get_packet_len(struct tm_transfer_frame *tm_tf, osdlp_sdu_len_t *length,
+               uint8_t *pkt, osdlp_sdu_len_t mem_len)
+{
+	return tm_tf->ops->get_packet_len(tm_tf->user, length, pkt, mem_len);
 }
 
 static void
 pack_crc(struct tm_transfer_frame *tm_tf, uint8_t *pkt_out)
 {
-	if (tm_tf->mission.crc_present == TM_CRC_PRESENT) {
+	if (TM_CRC_FLAG(tm_tf) == TM_CRC_PRESENT) {
 		uint16_t crc = 0;
-		pkt_out[tm_tf->mission.frame_len - 2] = 0;
-		pkt_out[tm_tf->mission.frame_len - 1] = 0;
-		crc = osdlp_calc_crc(pkt_out, tm_tf->mission.frame_len - 2);
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 2] = 0;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 1] = 0;
+		crc = osdlp_calc_crc(pkt_out, TM_FRAME_SIZE(tm_tf) - 2);
 
-		pkt_out[tm_tf->mission.frame_len - 2] = (crc >> 8) & 0xff;
-		pkt_out[tm_tf->mission.frame_len - 1] = crc & 0xff;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 2] = (crc >> 8) & 0xff;
+		pkt_out[TM_FRAME_SIZE(tm_tf) - 1] = crc & 0xff;
 	}
 }
 
@@ -223,13 +347,13 @@ osdlp_enable_packet_stuffing(struct tm_transfer_frame *tm_tf)
  * Returns the number of useful bytes that already are stored in
  * a buffer
  */
-static uint16_t
+static osdlp_sdu_len_t
 eval_residue_len(struct tm_transfer_frame *tm_tf,
                  uint8_t *last_pkt, uint8_t vcid)
 {
 	int ret;
-	uint16_t residue_len = 0;
-	uint16_t pkt_len = 0;
+	osdlp_sdu_len_t residue_len = 0;
+	osdlp_sdu_len_t pkt_len = 0;
 	/*There is at least one packet in fifo*/
 	uint16_t first_hdr_ptr = ((last_pkt[4] & 0x07) << 8) | last_pkt[5];
 	if (first_hdr_ptr != TM_FIRST_HDR_PTR_NO_PKT_START &&
@@ -243,9 +367,9 @@ eval_residue_len(struct tm_transfer_frame *tm_tf,
 		} else {
 			residue_len += first_hdr_ptr;
 			while (residue_len <= tm_tf->mission.max_data_len) {
-				ret = osdlp_tm_get_packet_len(&pkt_len,
-				                              &last_pkt[tm_tf->mission.header_len + residue_len],
-				                              tm_tf->mission.max_data_len);
+				ret = get_packet_len(tm_tf, &pkt_len,
+				                     &last_pkt[tm_tf->mission.header_len + residue_len],
+				                     tm_tf->mission.max_data_len);
 				if (ret < 0) {
 					return 0;
 				}
@@ -272,9 +396,9 @@ eval_residue_len(struct tm_transfer_frame *tm_tf,
 
 static void
 handle_pkt_stuffing(struct tm_transfer_frame *tm_tf,
-                    uint16_t num_packets, uint8_t *last_pkt,
-                    uint8_t *data_in, uint16_t length,
-                    uint16_t *remaining_len, uint16_t residue_len)
+                    osdlp_sdu_len_t num_packets, uint8_t *last_pkt,
+                    uint8_t *data_in, osdlp_sdu_len_t length,
+                    osdlp_sdu_len_t *remaining_len, uint16_t residue_len)
 {
 	uint16_t chunk_size = 0;
 	/*There is room in the last packet so let's use it*/
@@ -305,15 +429,17 @@ handle_pkt_stuffing(struct tm_transfer_frame *tm_tf,
 
 int
 osdlp_tm_transmit(struct tm_transfer_frame *tm_tf,
-                  uint8_t *data_in, uint16_t length)
+                  uint8_t *data_in, osdlp_sdu_len_t length)
 {
 	int ret;
 	uint8_t vcid = tm_tf->mission.vcid;
-	uint16_t residue_len = 0;
+	osdlp_sdu_len_t residue_len = 0;
 	uint16_t bytes_avail = 0;
-	uint16_t num_packets = 0;
-	uint16_t remaining_len = 0;
+	osdlp_sdu_len_t num_packets = 0;
+	osdlp_sdu_len_t remaining_len = 0;
 	uint8_t *last_pkt = NULL;
+	uint8_t *frame;
+	struct tm_frame_work work;
 
 	if (tm_tf->mission.util.loop_state == TM_LOOP_OPEN) {
 		remaining_len = length - tm_tf->mission.util.buffered_length;
@@ -322,11 +448,11 @@ osdlp_tm_transmit(struct tm_transfer_frame *tm_tf,
 	}
 
 	/*Check if last packet in fifo has leftover space*/
-	if (!osdlp_tm_tx_queue_empty(vcid)
-	    && tm_tf->mission.stuff_state == TM_STUFFING_ON
+	if (!tx_queue_empty(tm_tf, vcid)
+	    && TM_STUFF_STATE(tm_tf) == TM_STUFFING_ON
 	    && tm_tf->mission.util.loop_state == TM_LOOP_CLOSED) {
-		ret = osdlp_tm_tx_queue_back(&last_pkt,
-		                             vcid);		// Get a pointer to the last packet in queue
+		ret = tm_tf->ops->tx_queue_back(tm_tf->user, &last_pkt,
+		                                vcid);		// Get a pointer to the last packet in queue
 		if (ret < 0) {
 			residue_len = tm_tf->mission.max_data_len;
 		} else {
@@ -353,7 +479,7 @@ osdlp_tm_transmit(struct tm_transfer_frame *tm_tf,
 			num_packets--;
 
 		}
-		osdlp_tm_tx_commit_back(vcid);
+		tm_tf->ops->tx_commit_back(tm_tf->user, vcid);
 	} else {
 		num_packets = (remaining_len) /
 		              tm_tf->mission.max_data_len;
@@ -383,24 +509,22 @@ osdlp_tm_transmit(struct tm_transfer_frame *tm_tf,
 		} else {
 			bytes_avail = tm_tf->mission.max_data_len;
 		}
-		/*Check for overflow on counters*/
-		if (*tm_tf->primary_hdr.mc_frame_cnt < 255) {
-			*tm_tf->primary_hdr.mc_frame_cnt =
-			        *tm_tf->primary_hdr.mc_frame_cnt + 1;
-		} else {
-			*tm_tf->primary_hdr.mc_frame_cnt = 0;
-		}
-		if (tm_tf->primary_hdr.vc_frame_cnt < 255) {
-			tm_tf->primary_hdr.vc_frame_cnt++;
-		} else {
-			tm_tf->primary_hdr.vc_frame_cnt = 0;
+		/* The master channel counter may be shared with other threads*/
+		osdlp_tm_claim_frame(tm_tf, &work,
+		                     tm_tf->primary_hdr.status.first_hdr_ptr);
+
+		frame = tx_frame_alloc(tm_tf);
+		if (frame) {
+			osdlp_tm_pack_frame(tm_tf, &work, frame,
+			                    &data_in[length - remaining_len],
+			                    bytes_avail);
+			if (TM_CRC_FLAG(tm_tf) == TM_CRC_PRESENT) {
+				tm_tf->crc = work.crc;
+			}
 		}
 
-		osdlp_tm_pack(tm_tf, tm_tf->mission.util.buffer,
-		              &data_in[length - remaining_len], bytes_avail);
-
 		num_packets--;
-		ret = osdlp_tm_tx_queue_enqueue(tm_tf->mission.util.buffer, vcid);
+		ret = tx_queue_enqueue(tm_tf, frame, vcid);
 		if (ret < 0) {
 			tm_tf->mission.util.loop_state = TM_LOOP_OPEN;
 			tm_tf->mission.util.buffered_length = length - remaining_len;
@@ -417,9 +541,9 @@ static tm_rx_result_t
 handle_ns_ptr_zero(struct tm_transfer_frame *tm_tf)
 {
 	int ret;
-	uint16_t length;
-	ret = osdlp_tm_get_packet_len(&length, tm_tf->data,
-	                              tm_tf->mission.max_data_len);
+	osdlp_sdu_len_t length;
+	ret = get_packet_len(tm_tf, &length, tm_tf->data,
+	                     tm_tf->mission.max_data_len);
 	if (ret < 0) {
 		return TM_RX_ERROR;
 	}
@@ -435,8 +559,7 @@ handle_ns_ptr_zero(struct tm_transfer_frame *tm_tf)
 		       sizeof(uint8_t));
 		tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 		tm_tf->mission.util.buffered_length = 0;
-		ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-		                                tm_tf->mission.vcid);
+		ret = rx_queue_enqueue(tm_tf);
 		if (ret < 0) {
 			return TM_RX_DENIED;
 		}
@@ -471,8 +594,7 @@ handle_ns_ptr_positive(struct tm_transfer_frame *tm_tf)
 		    == tm_tf->mission.util.expected_pkt_len) {
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
-			ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-			                                tm_tf->mission.vcid);
+			ret = rx_queue_enqueue(tm_tf);
 			if (ret < 0) {
 				return TM_RX_DENIED;
 			}
@@ -504,7 +626,7 @@ handle_rx_no_stuffing(struct tm_transfer_frame *tm_tf)
 static tm_rx_result_t
 handle_s_ptr_zero(struct tm_transfer_frame *tm_tf)
 {
-	uint16_t length;
+	osdlp_sdu_len_t length;
 	int ret;
 	bool more_pkts = true;
 	uint16_t bytes_explored = 0;
@@ -515,8 +637,8 @@ handle_s_ptr_zero(struct tm_transfer_frame *tm_tf)
 			tm_tf->mission.util.expected_pkt_len = 0;
 			return TM_RX_OK;
 		}
-		ret = osdlp_tm_get_packet_len(&length, &tm_tf->data[bytes_explored],
-		                              (tm_tf->mission.max_data_len - bytes_explored));
+		ret = get_packet_len(tm_tf, &length, &tm_tf->data[bytes_explored],
+		                     (tm_tf->mission.max_data_len - bytes_explored));
 		if (ret < 0) {
 			memcpy(tm_tf->mission.util.buffer, &tm_tf->data[bytes_explored],
 			       (tm_tf->mission.max_data_len - bytes_explored) * sizeof(uint8_t));
@@ -541,8 +663,7 @@ handle_s_ptr_zero(struct tm_transfer_frame *tm_tf)
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
 			tm_tf->mission.util.expected_pkt_len = 0;
-			ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-			                                tm_tf->mission.vcid);
+			ret = rx_queue_enqueue(tm_tf);
 			if (ret < 0) {
 				return TM_RX_DENIED;
 			}
@@ -558,7 +679,7 @@ handle_s_ptr_zero(struct tm_transfer_frame *tm_tf)
 static tm_rx_result_t
 handle_s_ptr_nopkt(struct tm_transfer_frame *tm_tf)
 {
-	uint16_t length;
+	osdlp_sdu_len_t length;
 	int ret;
 	if (tm_tf->mission.util.loop_state == TM_LOOP_CLOSED) { // A packet was lost
 		return TM_RX_ERROR;
@@ -571,9 +692,9 @@ handle_s_ptr_nopkt(struct tm_transfer_frame *tm_tf)
 		    tm_tf->mission.max_sdu_len) {
 			memcpy(&tm_tf->mission.util.buffer[tm_tf->mission.util.buffered_length],
 			       tm_tf->data, tm_tf->mission.max_data_len * sizeof(uint8_t));
-			ret = osdlp_tm_get_packet_len(&length, tm_tf->mission.util.buffer,
-			                              (tm_tf->mission.max_data_len
-			                               + tm_tf->mission.util.buffered_length));
+			ret = get_packet_len(tm_tf, &length, tm_tf->mission.util.buffer,
+			                     (tm_tf->mission.max_data_len
+			                      + tm_tf->mission.util.buffered_length));
 		} else {
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
@@ -588,8 +709,7 @@ handle_s_ptr_nopkt(struct tm_transfer_frame *tm_tf)
 				tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 				tm_tf->mission.util.buffered_length = 0;
 
-				ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-				                                tm_tf->mission.vcid);
+				ret = rx_queue_enqueue(tm_tf);
 				if (ret < 0) {
 					return TM_RX_DENIED;
 				}
@@ -614,8 +734,7 @@ handle_s_ptr_nopkt(struct tm_transfer_frame *tm_tf)
 		    == tm_tf->mission.util.expected_pkt_len) {
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
-			ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-			                                tm_tf->mission.vcid);
+			ret = rx_queue_enqueue(tm_tf);
 			if (ret < 0) {
 				return TM_RX_DENIED;
 			}
@@ -630,7 +749,7 @@ handle_s_ptr_nopkt(struct tm_transfer_frame *tm_tf)
 static tm_rx_result_t
 handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 {
-	uint16_t length;
+	osdlp_sdu_len_t length;
 	int ret;
 	bool more_pkts = true;
 	uint16_t bytes_explored = 0;
@@ -640,9 +759,9 @@ handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 		    tm_tf->primary_hdr.status.first_hdr_ptr < tm_tf->mission.max_sdu_len) {
 			memcpy(&tm_tf->mission.util.buffer[tm_tf->mission.util.buffered_length],
 			       tm_tf->data, tm_tf->primary_hdr.status.first_hdr_ptr * sizeof(uint8_t));
-			ret = osdlp_tm_get_packet_len(&length, tm_tf->mission.util.buffer,
-			                              (tm_tf->primary_hdr.status.first_hdr_ptr
-			                               + tm_tf->mission.util.buffered_length));
+			ret = get_packet_len(tm_tf, &length, tm_tf->mission.util.buffer,
+			                     (tm_tf->primary_hdr.status.first_hdr_ptr
+			                      + tm_tf->mission.util.buffered_length));
 		} else {
 			ret = -1;
 		}
@@ -651,8 +770,7 @@ handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 			    + tm_tf->mission.util.buffered_length == length) {
 				tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 				tm_tf->mission.util.buffered_length = 0;
-				ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-				                                tm_tf->mission.vcid);
+				ret = rx_queue_enqueue(tm_tf);
 				if (ret < 0) {
 					return TM_RX_DENIED;
 				}
@@ -671,8 +789,7 @@ handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 			       tm_tf->data, tm_tf->primary_hdr.status.first_hdr_ptr * sizeof(uint8_t));
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
-			ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-			                                tm_tf->mission.vcid);
+			ret = rx_queue_enqueue(tm_tf);
 			if (ret < 0) {
 				return TM_RX_DENIED;
 			}
@@ -686,8 +803,8 @@ handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 			tm_tf->mission.util.expected_pkt_len = 0;
 			return TM_RX_OK;
 		}
-		ret = osdlp_tm_get_packet_len(&length, &tm_tf->data[bytes_explored],
-		                              (tm_tf->mission.max_data_len - bytes_explored));
+		ret = get_packet_len(tm_tf, &length, &tm_tf->data[bytes_explored],
+		                     (tm_tf->mission.max_data_len - bytes_explored));
 		if (ret < 0) {
 			memcpy(tm_tf->mission.util.buffer, &tm_tf->data[bytes_explored],
 			       (tm_tf->mission.max_data_len - bytes_explored) * sizeof(uint8_t));
@@ -712,8 +829,7 @@ handle_s_ptr_positive(struct tm_transfer_frame *tm_tf)
 			tm_tf->mission.util.loop_state = TM_LOOP_CLOSED;
 			tm_tf->mission.util.buffered_length = 0;
 			tm_tf->mission.util.expected_pkt_len = 0;
-			ret = osdlp_tm_rx_queue_enqueue(tm_tf->mission.util.buffer,
-			                                tm_tf->mission.vcid);
+			ret = rx_queue_enqueue(tm_tf);
 			if (ret < 0) {
 				return TM_RX_DENIED;
 			}
@@ -748,22 +864,24 @@ handle_rx_stuffing(struct tm_transfer_frame *tm_tf)
 int
 osdlp_tm_receive(uint8_t *data_in)
 {
-	tm_rx_result_t notif;
 	uint8_t vcid = (data_in[1] >> 1) & 0x07;
 	struct tm_transfer_frame *tm_tf;
 	int ret = osdlp_tm_get_rx_config(&tm_tf, vcid);
 	if (ret < 0) {
 		return ret;
 	}
-	osdlp_tm_unpack(tm_tf, data_in);
-	uint16_t crc = osdlp_calc_crc(data_in, tm_tf->mission.frame_len - 2);
-	if (crc != tm_tf->crc) {
-		return -TM_RX_WRONG_CRC;
-	}
+	*tm_tf->primary_hdr.mc_frame_cnt = data_in[2];
+	return osdlp_tm_rx_frame(tm_tf, data_in);
+}
+
+static int
+rx_reassemble(struct tm_transfer_frame *tm_tf)
+{
+	tm_rx_result_t notif;
 	if (tm_tf->primary_hdr.status.first_hdr_ptr == TM_FIRST_HDR_PTR_OID) {
 		return TM_RX_OID;
 	}
-	if (tm_tf->mission.stuff_state == TM_STUFFING_OFF) {
+	if (TM_STUFF_STATE(tm_tf) == TM_STUFFING_OFF) {
 		notif = handle_rx_no_stuffing(tm_tf);
 	} else { // Stuffing on
 		notif = handle_rx_stuffing(tm_tf);
@@ -771,14 +889,50 @@ osdlp_tm_receive(uint8_t *data_in)
 	return -notif;
 }
 
+int
+osdlp_tm_rx_frame(struct tm_transfer_frame *tm_tf, uint8_t *data_in)
+{
+	unpack_vc(tm_tf, data_in);
+	uint16_t crc = osdlp_calc_crc(data_in, TM_FRAME_SIZE(tm_tf) - 2);
+	if (crc != tm_tf->crc) {
+		return -TM_RX_WRONG_CRC;
+	}
+	return rx_reassemble(tm_tf);
+}
+
+int
+osdlp_tm_rx_verify(const struct tm_transfer_frame *tm_tf,
+                   uint8_t *data_in)
+{
+	uint16_t len = TM_FRAME_SIZE(tm_tf);
+	uint16_t crc;
+	if (TM_CRC_FLAG(tm_tf) != TM_CRC_PRESENT) {
+		return 0;
+	}
+	crc = (data_in[len - 2] << 8) | data_in[len - 1];
+	if (osdlp_calc_crc(data_in, len - 2) != crc) {
+		return -TM_RX_WRONG_CRC;
+	}
+	return 0;
+}
+
+int
+osdlp_tm_rx_verified(struct tm_transfer_frame *tm_tf, uint8_t *data_in)
+{
+	unpack_vc(tm_tf, data_in);
+	return rx_reassemble(tm_tf);
+}
+
 int
 osdlp_tm_transmit_idle_fdu(struct tm_transfer_frame *tm_tf, uint8_t vcid)
 {
 	int ret;
+	uint8_t *frame = tx_frame_alloc(tm_tf);
 	tm_tf->primary_hdr.status.first_hdr_ptr = TM_FIRST_HDR_PTR_OID;
-	osdlp_tm_pack(tm_tf, tm_tf->mission.util.buffer,
-	              NULL, 0);
-	ret = osdlp_tm_tx_queue_enqueue(tm_tf->mission.util.buffer, vcid);
+	if (frame) {
+		osdlp_tm_pack(tm_tf, frame, NULL, 0);
+	}
+	ret = tx_queue_enqueue(tm_tf, frame, vcid);
 	if (ret < 0) {
 		return ret;
 	}
@@ -0,0 +1,68 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "osdlp_trace.h"
+
+__thread struct osdlp_trace_ring *osdlp_trace_current = NULL;
+
+uint64_t
+osdlp_trace_clock(void)
+{
+	return 0;
+}
+
+int
+osdlp_trace_init(struct osdlp_trace_ring *ring,
+                 struct osdlp_trace_event *events, uint32_t nevents)
+{
+	if (nevents == 0 || (nevents & (nevents - 1))) {
+		return -1;
+	}
+	ring->events = events;
+	ring->mask = nevents - 1;
+	ring->head = 0;
+	return 0;
+}
+
+void
+osdlp_trace_attach(struct osdlp_trace_ring *ring)
+{
+	osdlp_trace_current = ring;
+}
+
+uint32_t
+osdlp_trace_snapshot(const struct osdlp_trace_ring *ring,
+                     struct osdlp_trace_event *out, uint32_t max)
+{
+	uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	uint32_t n = head;
+	uint32_t first;
+	if (n > ring->mask + 1) {
+		n = ring->mask + 1;
+	}
+	if (n > max) {
+		n = max;
+	}
+	first = head - n;
+	for (uint32_t i = 0; i < n; i++) {
+		out[i] = ring->events[(first + i) & ring->mask];
+	}
+	return n;
+}
@@ -0,0 +1,107 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "osdlp_ws_deque.h"
+
+int
+osdlp_ws_deque_init(struct osdlp_ws_deque *d, void **items,
+                    uint32_t capacity)
+{
+	if (!d || !items || capacity < 2 || (capacity & (capacity - 1))) {
+		return -1;
+	}
+	d->top = 0;
+	d->bottom = 0;
+	d->items = items;
+	d->mask = capacity - 1;
+	return 0;
+}
+
+int
+osdlp_ws_deque_push(struct osdlp_ws_deque *d, void *item)
+{
+	uint32_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+	uint32_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+	if (b - t > d->mask) {
+		return -1;
+	}
+	__atomic_store_n(&d->items[b & d->mask], item, __ATOMIC_RELAXED);
+	__atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+void *
+osdlp_ws_deque_pop(struct osdlp_ws_deque *d)
+{
+	uint32_t b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+	uint32_t t;
+	void *item;
+
+	__atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+	if ((int32_t)(b - t) < 0) {
+		__atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	item = __atomic_load_n(&d->items[b & d->mask], __ATOMIC_RELAXED);
+	if (b != t) {
+		return item;
+	}
+	/* Last item, a thief may be taking it as well */
+	if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+	                                 __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		item = NULL;
+	}
+	__atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+	return item;
+}
+
+void *
+osdlp_ws_deque_steal(struct osdlp_ws_deque *d)
+{
+	uint32_t t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+	uint32_t b;
+	void *item;
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+	if ((int32_t)(b - t) <= 0) {
+		return NULL;
+	}
+	item = __atomic_load_n(&d->items[t & d->mask], __ATOMIC_RELAXED);
+	if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, false,
+	                                 __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		return NULL;
+	}
+	return item;
+}
+
+void *
+osdlp_ws_deque_take(struct osdlp_ws_deque *deques, uint32_t n,
+                    uint32_t self)
+{
+	void *item = osdlp_ws_deque_pop(&deques[self]);
+	for (uint32_t i = 1; !item && i < n; i++) {
+		item = osdlp_ws_deque_steal(&deques[(self + i) % n]);
+	}
+	return item;
+}
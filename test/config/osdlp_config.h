@@ -0,0 +1,35 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEST_CONFIG_OSDLP_CONFIG_H_
+#define TEST_CONFIG_OSDLP_CONFIG_H_
+
+/*
+ * Mission parameters of the test_osdlp_config build. The TC and TM
+ * enumerations are only referenced where the macros are expanded.
+ */
+#define OSDLP_TC_CRC            TC_CRC_PRESENT
+#define OSDLP_TC_SEG_HDR        TC_SEG_HDR_PRESENT
+#define OSDLP_TM_CRC            TM_CRC_PRESENT
+#define OSDLP_TM_OCF            TM_OCF_NOTPRESENT
+#define OSDLP_TM_STUFFING       TM_STUFFING_OFF
+#define OSDLP_TM_FRAME_LEN      256
+#define OSDLP_MAX_VCS           8
+
+#endif /* TEST_CONFIG_OSDLP_CONFIG_H_ */
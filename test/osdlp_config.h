@@ -8,6 +8,10 @@
 #ifndef TEST_OSDLP_CONFIG_H_
 #define TEST_OSDLP_CONFIG_H_
 
-
+/*
+ * Included when building with -DOSDLP_USE_CONFIG. The main test suite uses
+ * several frame formats, so nothing is fixed here. test_osdlp_config is
+ * built with the mission parameters of config/osdlp_config.h instead.
+ */
 
 #endif /* TEST_OSDLP_CONFIG_H_ */
@@ -22,6 +22,23 @@
 #include <string.h>
 #include <osdlp_tc.h>
 #include <osdlp_cop.h>
+#include <osdlp_arena.h>
+
+#define QUEUE_ARENA_SIZE    (2 * 1024 * 1024)
+
+/* All queues are carved from a single region, so tests never hit malloc */
+static uint8_t queue_region[QUEUE_ARENA_SIZE];
+static struct osdlp_arena queue_arena = {
+	.base = queue_region,
+	.size = QUEUE_ARENA_SIZE,
+	.used = 0
+};
+
+void
+reset_queue_memory()
+{
+	osdlp_arena_reset(&queue_arena);
+}
 
 int
 init(struct queue *handle,
@@ -33,7 +50,9 @@ init(struct queue *handle,
 	handle->inqueue = 0;
 	handle->tail = 0;
 	handle->item_size = item_size;
-	handle->mem_space = (uint8_t *)malloc(num_items * item_size * sizeof(uint8_t));
+	handle->mem_space = osdlp_arena_alloc(&queue_arena,
+	                                      num_items * item_size,
+	                                      sizeof(void *));
 	if (handle->mem_space == NULL) {
 		return -1;
 	}
@@ -32,6 +32,9 @@ struct queue {
 	uint16_t	item_size;
 };
 
+void
+reset_queue_memory();
+
 int
 init(struct queue *handle,
      uint16_t item_size,
@@ -184,7 +184,7 @@ osdlp_tc_rx_queue_full(uint16_t vcid)
 }
 
 bool
-osdlp_tc_tx_queue_full()
+osdlp_tc_tx_queue_full(uint16_t vcid)
 {
 	return uplink_channel.inqueue == uplink_channel.capacity ? true : false;
 }
@@ -352,6 +352,7 @@ setup_queues(uint16_t up_chann_item_size,
              uint16_t rx_item_size,
              uint16_t rx_capacity)
 {
+	reset_queue_memory();
 	int ret = init(&uplink_channel,
 	               up_chann_item_size,
 	               up_chann_capacity);
@@ -423,12 +424,34 @@ main()
 	const struct CMUnitTest tests[] = {
 		cmocka_unit_test(test_tm),
 		cmocka_unit_test(test_tc),
+		cmocka_unit_test(test_tc_rx_decode),
+		cmocka_unit_test(test_registry),
+		cmocka_unit_test(test_cltu),
+		cmocka_unit_test(test_randomizer),
+		cmocka_unit_test(test_sent_ring),
+		cmocka_unit_test(test_frame_pool),
+		cmocka_unit_test(test_wait_queue),
+		cmocka_unit_test(test_fop_engine),
+		cmocka_unit_test(test_timer_wheel),
+		cmocka_unit_test(test_clcw_batch),
+		cmocka_unit_test(test_ad_burst),
+		cmocka_unit_test(test_trace),
+		cmocka_unit_test(test_ops),
+		cmocka_unit_test(test_spsc_ring),
+		cmocka_unit_test(test_mpmc_queue),
+		cmocka_unit_test(test_arena),
+		cmocka_unit_test(test_parallel_pack),
+		cmocka_unit_test(test_rx_pipeline),
+		cmocka_unit_test(test_work_steal),
+		cmocka_unit_test(test_notify),
+		cmocka_unit_test(test_fop_nr_wrap),
 		cmocka_unit_test(test_simple_bd_frame),
 		cmocka_unit_test(test_spp_hdr_only),
 		cmocka_unit_test(test_spp_hdr_with_data),
 		cmocka_unit_test(test_spp_invalid),
 		cmocka_unit_test(test_unlock_cmd),
 		cmocka_unit_test(test_vr),
+		cmocka_unit_test(test_farm_window_wrap),
 		cmocka_unit_test(test_operation),
 		cmocka_unit_test(test_tm_no_stuffing),
 		cmocka_unit_test(test_tm_with_stuffing)
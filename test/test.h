@@ -77,6 +77,69 @@ test_tm(void **state);
 void
 test_tc(void **state);
 
+void
+test_tc_rx_decode(void **state);
+
+void
+test_registry(void **state);
+
+void
+test_cltu(void **state);
+
+void
+test_randomizer(void **state);
+
+void
+test_sent_ring(void **state);
+
+void
+test_frame_pool(void **state);
+
+void
+test_wait_queue(void **state);
+
+void
+test_fop_engine(void **state);
+
+void
+test_timer_wheel(void **state);
+
+void
+test_clcw_batch(void **state);
+
+void
+test_ad_burst(void **state);
+
+void
+test_trace(void **state);
+
+void
+test_ops(void **state);
+
+void
+test_spsc_ring(void **state);
+
+void
+test_mpmc_queue(void **state);
+
+void
+test_arena(void **state);
+
+void
+test_parallel_pack(void **state);
+
+void
+test_rx_pipeline(void **state);
+
+void
+test_work_steal(void **state);
+
+void
+test_notify(void **state);
+
+void
+test_fop_nr_wrap(void **state);
+
 void
 test_simple_bd_frame(void **state);
 
@@ -113,6 +176,9 @@ test_operation(void **state);
 void
 test_vr(void **state);
 
+void
+test_farm_window_wrap(void **state);
+
 void
 test_tm_no_stuffing(void **state);
 
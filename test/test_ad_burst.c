@@ -0,0 +1,116 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define BURST_SLOTS     8
+#define BURST_FRAMES    5
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+static uint8_t burst_storage[(BURST_SLOTS + 1) * TC_MAX_FRAME_LEN];
+
+/*
+ * Sends BURST_FRAMES frames and one more that waits for the window. Only the
+ * first frame and the third one reach the receiver, so its CLCW asks for a
+ * retransmission. The FOP-1 must resend the lost frames in order before the
+ * waiting frame is sent.
+ */
+static void
+lose_and_retransmit(void)
+{
+	static uint8_t data[20];
+	uint8_t ocf[4];
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	for (int i = 0; i < 20; i++) {
+		data[i] = rand() % 256;
+	}
+	for (int i = 0; i < BURST_FRAMES; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, data, 20);
+		assert_int_equal(ret, TC_TX_OK);
+	}
+	ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, -TC_TX_DELAY);
+	assert_int_equal(uplink_channel.inqueue, BURST_FRAMES);
+	assert_int_equal(osdlp_retransmit_ad_frames(&tc_tx), 0);
+
+	for (int i = 0; i < BURST_FRAMES; i++) {
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		if (i == 0 || i == 2) {
+			osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		}
+	}
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	assert_int_equal(tc_rx.mission.clcw.report_value, 1);
+	assert_int_equal(tc_rx.mission.clcw.rt, 1);
+	osdlp_handle_clcw(&tc_tx, ocf);
+
+	/* The waiting frame follows the retransmitted ones*/
+	assert_int_equal(uplink_channel.inqueue, BURST_FRAMES);
+	for (int i = 1; i <= BURST_FRAMES; i++) {
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		assert_int_equal(test_util[4], i);
+		ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	assert_int_equal(osdlp_retransmit_ad_frames(&tc_tx), 0);
+	assert_int_equal(tc_tx.cop_cfg.fop.rt_burst, 0);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	assert_int_equal(tc_rx.mission.clcw.report_value, BURST_FRAMES + 1);
+}
+
+void
+test_ad_burst(void **state)
+{
+	struct tc_sent_ring ring;
+	int ret;
+
+	/* Sent queue callbacks */
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, BURST_FRAMES,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	lose_and_retransmit();
+
+	/* Sent ring */
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, BURST_FRAMES,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	ret = osdlp_sent_ring_init(&ring, burst_storage, BURST_SLOTS,
+	                           TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, 0);
+	osdlp_sent_ring_attach(&tc_tx, &ring);
+	lose_and_retransmit();
+	osdlp_sent_ring_attach(&tc_tx, NULL);
+}
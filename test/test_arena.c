@@ -0,0 +1,131 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include "test.h"
+
+#define ARENA_SIZE          (64 * 1024)
+#define ARENA_OBJS          32
+#define ARENA_THREADS       2
+#define ARENA_THREAD_N      20000
+
+static uint8_t arena_region[ARENA_SIZE];
+
+static void *
+arena_worker(void *arg)
+{
+	struct osdlp_slab_cache cache;
+	void *objs[4];
+	osdlp_slab_cache_init(&cache, arg);
+	for (int i = 0; i < ARENA_THREAD_N; i++) {
+		for (int j = 0; j < 4; j++) {
+			objs[j] = osdlp_slab_cache_alloc(&cache);
+			if (!objs[j]) {
+				return (void *)1;
+			}
+			memset(objs[j], j, 8);
+		}
+		for (int j = 0; j < 4; j++) {
+			osdlp_slab_cache_free(&cache, objs[j]);
+		}
+	}
+	osdlp_slab_cache_drain(&cache);
+	return NULL;
+}
+
+void
+test_arena(void **state)
+{
+	struct osdlp_arena arena;
+	struct osdlp_slab slab;
+	struct osdlp_slab_cache cache;
+	struct osdlp_frame_slabs slabs;
+	struct tc_frame_pool pool;
+	pthread_t th[ARENA_THREADS];
+	void *objs[ARENA_OBJS];
+	uint8_t *p;
+	uint8_t *q;
+	size_t used;
+	void *ret;
+
+	assert_int_equal(osdlp_arena_init(&arena, arena_region, 0), -1);
+	assert_int_equal(osdlp_arena_init(&arena, arena_region, ARENA_SIZE), 0);
+	p = osdlp_arena_alloc(&arena, 3, 1);
+	q = osdlp_arena_alloc(&arena, 8, 64);
+	assert_true(p == arena_region);
+	assert_int_equal((uintptr_t)q % 64, 0);
+	assert_true(osdlp_arena_alloc(&arena, 8, 3) == NULL);
+	assert_true(osdlp_arena_alloc(&arena, ARENA_SIZE, 1) == NULL);
+	osdlp_arena_reset(&arena);
+	assert_int_equal(osdlp_arena_used(&arena), 0);
+
+	/* Slab */
+	assert_int_equal(osdlp_slab_init(&slab, &arena, 20, ARENA_OBJS), 0);
+	assert_int_equal(slab.obj_size % sizeof(void *), 0);
+	for (int i = 0; i < ARENA_OBJS; i++) {
+		objs[i] = osdlp_slab_alloc(&slab);
+		assert_true(objs[i] != NULL);
+		assert_true(osdlp_slab_owns(&slab, objs[i]));
+		memset(objs[i], 0xff, 20);
+	}
+	assert_true(osdlp_slab_alloc(&slab) == NULL);
+	assert_false(osdlp_slab_owns(&slab, (uint8_t *)objs[0] + 1));
+	assert_false(osdlp_slab_owns(&slab, arena_region + ARENA_SIZE - 1));
+	for (int i = 0; i < ARENA_OBJS; i++) {
+		osdlp_slab_free(&slab, objs[i]);
+	}
+	assert_int_equal(slab.available, ARENA_OBJS);
+
+	/* The cache takes the slab lock once per batch */
+	osdlp_slab_cache_init(&cache, &slab);
+	objs[0] = osdlp_slab_cache_alloc(&cache);
+	assert_true(objs[0] != NULL);
+	assert_int_equal(slab.available, ARENA_OBJS - SLAB_CACHE_SIZE / 2);
+	assert_int_equal(cache.count, SLAB_CACHE_SIZE / 2 - 1);
+	osdlp_slab_cache_free(&cache, objs[0]);
+	osdlp_slab_cache_drain(&cache);
+	assert_int_equal(slab.available, ARENA_OBJS);
+
+	/* Threads with their own caches reach a zero allocation steady state */
+	used = osdlp_arena_used(&arena);
+	for (int i = 0; i < ARENA_THREADS; i++) {
+		pthread_create(&th[i], NULL, arena_worker, &slab);
+	}
+	for (int i = 0; i < ARENA_THREADS; i++) {
+		pthread_join(th[i], &ret);
+		assert_true(ret == NULL);
+	}
+	assert_int_equal(slab.available, ARENA_OBJS);
+	assert_int_equal(osdlp_arena_used(&arena), used);
+
+	/* Frame classes and library buffers from the same arena */
+	assert_int_equal(osdlp_frame_slabs_init(&slabs, &arena,
+	                                        TC_MAX_FRAME_LEN, TM_FRAME_LEN,
+	                                        TC_MAX_SDU_SIZE, 4), 0);
+	p = osdlp_frame_slabs_alloc(&slabs, OSDLP_CLASS_SDU);
+	assert_true(osdlp_slab_owns(&slabs.cls[OSDLP_CLASS_SDU], p));
+	memset(p, 0, TC_MAX_SDU_SIZE);
+	osdlp_frame_slabs_free(&slabs, OSDLP_CLASS_SDU, p);
+	p = osdlp_arena_alloc(&arena, 8 * TC_MAX_FRAME_LEN, OSDLP_CACHE_LINE);
+	q = osdlp_arena_alloc(&arena, 8, 1);
+	assert_int_equal(osdlp_frame_pool_init(&pool, p, q, 8,
+	                                       TC_MAX_FRAME_LEN), 0);
+	assert_true(osdlp_frame_pool_alloc(&pool) != NULL);
+	assert_true(osdlp_arena_alloc(&arena, ARENA_SIZE, 1) == NULL);
+}
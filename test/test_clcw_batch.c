@@ -0,0 +1,109 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+/* Uplinks and receives a frame, returning the CLCW that acknowledges it */
+static void
+send_and_ack(uint8_t *data, uint8_t *ocf)
+{
+	int ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+}
+
+void
+test_clcw_batch(void **state)
+{
+	struct tc_registry reg;
+	struct tc_registry_slot slots[4];
+	uint8_t ocfs[6][4];
+	uint8_t data[20];
+	uint32_t n;
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	ret = osdlp_tc_registry_init(&reg, slots, 4);
+	assert_int_equal(ret, 0);
+	ret = osdlp_tc_registry_add(&reg, &tc_tx);
+	assert_int_equal(ret, 0);
+	for (int i = 0; i < 20; i++) {
+		data[i] = rand() % 256;
+	}
+
+	/* Successive acknowledgements collapse into the newest one */
+	send_and_ack(data, ocfs[0]);
+	memcpy(ocfs[1], ocfs[0], 4);
+	send_and_ack(data, ocfs[2]);
+	send_and_ack(data, ocfs[3]);
+	memcpy(ocfs[4], ocfs[3], 4);
+	n = osdlp_tc_registry_handle_clcw_batch(&reg, 101, &ocfs[0][0], 5);
+	assert_int_equal(n, 1);
+	assert_int_equal(tc_tx.cop_cfg.fop.nnr, 3);
+	assert_int_equal(tc_tx.cop_cfg.fop.state, FOP_STATE_ACTIVE);
+	assert_int_equal(tc_tx.cop_cfg.fop.signal, ACCEPT_TX);
+
+	/* Repeating the last CLCW has no effect */
+	n = osdlp_tc_registry_handle_clcw_batch(&reg, 101, &ocfs[3][0], 2);
+	assert_int_equal(n, 0);
+
+	/* CLCWs of unknown spacecraft are skipped */
+	n = osdlp_tc_registry_handle_clcw_batch(&reg, 102, &ocfs[3][0], 1);
+	assert_int_equal(n, 0);
+
+	/*
+	 * A retransmit request is never superseded and the duplicate of it that
+	 * precedes the final acknowledgement is dropped
+	 */
+	send_and_ack(data, ocfs[5]);
+	memcpy(ocfs[0], ocfs[3], 4);
+	ocfs[0][2] |= 0x08;
+	n = osdlp_tc_registry_handle_clcw_batch(&reg, 101, &ocfs[0][0], 1);
+	assert_int_equal(n, 1);
+	assert_int_equal(tc_tx.cop_cfg.fop.state, FOP_STATE_RT_NO_WAIT);
+	memcpy(ocfs[4], ocfs[0], 4);
+	n = osdlp_tc_registry_handle_clcw_batch(&reg, 101, &ocfs[4][0], 2);
+	assert_int_equal(n, 1);
+	assert_int_equal(tc_tx.cop_cfg.fop.nnr, 4);
+	assert_false(osdlp_clcw_duplicate(&tc_tx, ocfs[0]));
+
+	/* A direct call forgets the last CLCW */
+	osdlp_handle_clcw(&tc_tx, ocfs[5]);
+	assert_false(osdlp_clcw_duplicate(&tc_tx, ocfs[5]));
+}
@@ -0,0 +1,143 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define CLTU_MAX_LEN  (TC_MAX_FRAME_LEN / CLTU_INFO_LEN + 1) * CLTU_BLOCK_LEN \
+                      + CLTU_START_SEQ_LEN + CLTU_TAIL_SEQ_LEN
+
+extern struct queue               rx_queues[NUMVCS];
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+/* Bit serial reference of the BCH(63,56) encoder */
+static uint8_t
+bch_parity_ref(const uint8_t *info)
+{
+	uint8_t reg = 0;
+	for (int i = 0; i < CLTU_INFO_LEN; i++) {
+		for (int k = 7; k >= 0; k--) {
+			uint8_t fb = ((reg >> 6) ^ (info[i] >> k)) & 0x01;
+			reg = (reg << 1) & 0x7f;
+			if (fb) {
+				reg ^= 0x45;
+			}
+		}
+	}
+	return (~reg & 0x7f) << 1;
+}
+
+void
+test_cltu(void **state)
+{
+	uint8_t frame[TC_MAX_FRAME_LEN];
+	uint8_t cltu[CLTU_MAX_LEN];
+	uint8_t decoded[TC_MAX_FRAME_LEN + CLTU_INFO_LEN];
+	uint8_t data[100];
+	uint8_t rx_sdu[TC_MAX_SDU_SIZE];
+	uint32_t corrected;
+	uint32_t length = 100;
+	uint32_t nblocks = (length + CLTU_INFO_LEN - 1) / CLTU_INFO_LEN;
+	int cltu_len;
+	int ret;
+
+	for (uint32_t i = 0; i < length; i++) {
+		frame[i] = rand() % 256;
+	}
+	ret = osdlp_cltu_encode(cltu, 10, frame, length);
+	assert_int_equal(ret, -CLTU_LEN_ERR);
+	cltu_len = osdlp_cltu_encode(cltu, sizeof(cltu), frame, length);
+	assert_int_equal(cltu_len, osdlp_cltu_len(length));
+	assert_int_equal(cltu_len, 2 + nblocks * 8 + 8);
+	assert_int_equal(cltu[0], 0xeb);
+	assert_int_equal(cltu[1], 0x90);
+	assert_int_equal(cltu[cltu_len - 1], 0x79);
+	for (uint32_t b = 0; b < nblocks; b++) {
+		uint8_t *block = &cltu[CLTU_START_SEQ_LEN + b * CLTU_BLOCK_LEN];
+		assert_int_equal(block[CLTU_INFO_LEN], bch_parity_ref(block));
+	}
+	/* Fill octets of the last code block */
+	ret = CLTU_START_SEQ_LEN + (nblocks - 1) * CLTU_BLOCK_LEN
+	      + length % CLTU_INFO_LEN;
+	assert_int_equal(cltu[ret], CLTU_FILL_BYTE);
+
+	/* Clean decoding, with leading garbage before the start sequence */
+	memmove(&cltu[3], cltu, cltu_len);
+	cltu[0] = 0x00;
+	cltu[1] = 0xeb;
+	cltu[2] = 0x11;
+	ret = osdlp_cltu_decode(decoded, sizeof(decoded), cltu, cltu_len + 3,
+	                        &corrected);
+	assert_int_equal(ret, nblocks * CLTU_INFO_LEN);
+	assert_int_equal(corrected, 0);
+	assert_memory_equal(decoded, frame, length);
+
+	/* Every single bit error of a code block is corrected */
+	for (int pos = 0; pos < 63; pos++) {
+		uint8_t *block = &cltu[3 + CLTU_START_SEQ_LEN + CLTU_BLOCK_LEN];
+		block[pos / 8] ^= 0x80 >> (pos % 8);
+		ret = osdlp_cltu_decode(decoded, sizeof(decoded), cltu,
+		                        cltu_len + 3, &corrected);
+		assert_int_equal(ret, nblocks * CLTU_INFO_LEN);
+		assert_int_equal(corrected, 1);
+		assert_memory_equal(decoded, frame, length);
+		block[pos / 8] ^= 0x80 >> (pos % 8);
+	}
+
+	/* A double bit error ends the decoding at the corrupted block */
+	cltu[3 + CLTU_START_SEQ_LEN + CLTU_BLOCK_LEN] ^= 0x81;
+	ret = osdlp_cltu_decode(decoded, sizeof(decoded), cltu, cltu_len + 3,
+	                        NULL);
+	assert_int_equal(ret, CLTU_INFO_LEN);
+	cltu[3 + CLTU_START_SEQ_LEN + CLTU_BLOCK_LEN] ^= 0x81;
+
+	ret = osdlp_cltu_decode(decoded, sizeof(decoded), &cltu[3], 1, NULL);
+	assert_int_equal(ret, -CLTU_NO_START_SEQ);
+	ret = osdlp_cltu_decode(decoded, 10, cltu, cltu_len + 3, NULL);
+	assert_int_equal(ret, -CLTU_LEN_ERR);
+
+	/* Frames carried by CLTUs reach the receiving queue */
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_B, TC_DATA, 10,
+	                 FOP_STATE_INIT, 1, 0, 10, FARM_STATE_OPEN, 10);
+	for (int i = 0; i < 100; i++) {
+		data[i] = rand() % 256;
+	}
+	tc_tx.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	osdlp_tc_pack(&tc_tx, frame, data, 100);
+	length = tc_tx.mission.fixed_overhead_len + 100;
+	cltu_len = osdlp_cltu_encode(cltu, sizeof(cltu), frame, length);
+	cltu[10] ^= 0x04;
+	ret = osdlp_cltu_receive(cltu, cltu_len, decoded, sizeof(decoded));
+	assert_int_equal(ret, TC_RX_OK);
+	ret = dequeue(&rx_queues[1], rx_sdu);
+	assert_int_equal(ret, 0);
+	assert_memory_equal(rx_sdu, data, 100);
+
+	ret = osdlp_cltu_receive(cltu, 1, decoded, sizeof(decoded));
+	assert_int_equal(ret, -TC_RX_FRAME_VAL_ERR);
+}
@@ -0,0 +1,263 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Built separately with -DOSDLP_USE_CONFIG and test/config/osdlp_config.h,
+ * which fixes the frame format of the mission
+ */
+
+#include "test.h"
+
+#define CONFIG_SDU_LEN      600
+#define CONFIG_TC_FRAMES    8
+
+OSDLP_STATIC_ASSERT(OSDLP_MAX_VCS == 8, config_max_vcs);
+OSDLP_STATIC_ASSERT(TM_FRAME_SIZE((struct tm_transfer_frame *)0)
+                    == TM_FRAME_LEN, config_tm_frame_len);
+
+static struct tm_transfer_frame config_tm_tx;
+static struct tm_transfer_frame config_tm_rx;
+static struct tc_transfer_frame config_tc_tx;
+static struct tc_transfer_frame config_tc_rx;
+static uint8_t config_util_tx[TC_MAX_SDU_SIZE];
+static uint8_t config_util_rx[TC_MAX_SDU_SIZE];
+static uint8_t config_sdu[CONFIG_SDU_LEN];
+static uint8_t config_uplink[CONFIG_TC_FRAMES][TC_MAX_FRAME_LEN];
+static uint16_t config_uplink_len[CONFIG_TC_FRAMES];
+static int config_uplink_n;
+static int config_frames;
+static int config_received;
+static int config_errors;
+
+int
+osdlp_tm_get_rx_config(struct tm_transfer_frame **tm, uint8_t vcid)
+{
+	*tm = &config_tm_rx;
+	return 0;
+}
+
+int
+osdlp_tc_get_rx_config(struct tc_transfer_frame **tc_tf, uint16_t vcid)
+{
+	*tc_tf = &config_tc_rx;
+	return 0;
+}
+
+static bool
+config_tm_tx_queue_empty(void *user, uint8_t vcid)
+{
+	return true;
+}
+
+/* The downlink is a loopback, each frame is received as it is sent */
+static int
+config_tm_tx_queue_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	int ret = osdlp_tm_receive(pkt);
+	if (ret < 0 && ret != -TM_RX_PENDING) {
+		config_errors++;
+	}
+	config_frames++;
+	return 0;
+}
+
+static int
+config_tm_rx_queue_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	assert_memory_equal(pkt, config_sdu, CONFIG_SDU_LEN);
+	config_received++;
+	return 0;
+}
+
+/* The packets carry their length in a 16-bit field */
+static int
+config_tm_get_packet_len(void *user, osdlp_sdu_len_t *length, uint8_t *pkt,
+                         osdlp_sdu_len_t mem_len)
+{
+	if (mem_len < 2) {
+		return -1;
+	}
+	*length = (pkt[0] << 8) | pkt[1];
+	return *length <= TM_MAX_SDU_LEN ? 0 : -1;
+}
+
+static const struct osdlp_tm_ops config_tm_ops = {
+	.tx_queue_empty     = config_tm_tx_queue_empty,
+	.tx_queue_enqueue   = config_tm_tx_queue_enqueue,
+	.rx_queue_enqueue   = config_tm_rx_queue_enqueue,
+	.get_packet_len     = config_tm_get_packet_len
+};
+
+static bool
+config_tc_tx_queue_full(void *user, uint16_t vcid)
+{
+	return config_uplink_n == CONFIG_TC_FRAMES;
+}
+
+/* The uplink keeps every frame until the receiver reads them */
+static int
+config_tc_tx_queue_enqueue(void *user, uint8_t *buffer, uint16_t vcid)
+{
+	uint16_t len = (((buffer[2] & 0x03) << 8) | buffer[3]) + 1;
+	memcpy(config_uplink[config_uplink_n], buffer, len);
+	config_uplink_len[config_uplink_n++] = len;
+	return 0;
+}
+
+static int
+config_tc_rx_queue_enqueue_now(void *user, uint8_t *buffer, uint32_t length,
+                               uint16_t vcid)
+{
+	assert_int_equal(length, CONFIG_SDU_LEN);
+	assert_memory_equal(buffer, config_sdu, CONFIG_SDU_LEN);
+	config_received++;
+	return 0;
+}
+
+static const struct osdlp_tc_ops config_tc_ops = {
+	.tx_queue_full          = config_tc_tx_queue_full,
+	.tx_queue_enqueue       = config_tc_tx_queue_enqueue,
+	.rx_queue_enqueue_now   = config_tc_rx_queue_enqueue_now
+};
+
+static void
+config_sdu_fill(void)
+{
+	for (int i = 0; i < CONFIG_SDU_LEN; i++) {
+		config_sdu[i] = rand() % 256;
+	}
+	config_sdu[0] = CONFIG_SDU_LEN >> 8;
+	config_sdu[1] = CONFIG_SDU_LEN & 0xff;
+}
+
+static int
+config_tm_init(struct tm_transfer_frame *tm_tf, uint8_t *cnt,
+               tm_ocf_flag_t ocf, tm_crc_flag_t crc, uint16_t frame_len,
+               tm_stuff_state_t stuffing, uint8_t *util)
+{
+	return osdlp_tm_init(tm_tf, 30, cnt, 1, ocf, 0, 0, 0, 0, NULL, crc,
+	                     frame_len, TM_MAX_SDU_LEN, 2, TM_TX_CAPACITY,
+	                     stuffing, util);
+}
+
+static void
+test_config_tm(void **state)
+{
+	uint8_t cnt = 0;
+	uint8_t rx_cnt = 0;
+	int ret;
+
+	/* Parameters that differ from osdlp_config.h are rejected */
+	ret = config_tm_init(&config_tm_tx, &cnt, TM_OCF_NOTPRESENT,
+	                     TM_CRC_NOTPRESENT, TM_FRAME_LEN, TM_STUFFING_OFF,
+	                     config_util_tx);
+	assert_int_equal(ret, -1);
+	ret = config_tm_init(&config_tm_tx, &cnt, TM_OCF_PRESENT,
+	                     TM_CRC_PRESENT, TM_FRAME_LEN, TM_STUFFING_OFF,
+	                     config_util_tx);
+	assert_int_equal(ret, -1);
+	ret = config_tm_init(&config_tm_tx, &cnt, TM_OCF_NOTPRESENT,
+	                     TM_CRC_PRESENT, 2 * TM_FRAME_LEN,
+	                     TM_STUFFING_OFF, config_util_tx);
+	assert_int_equal(ret, -1);
+	ret = config_tm_init(&config_tm_tx, &cnt, TM_OCF_NOTPRESENT,
+	                     TM_CRC_PRESENT, TM_FRAME_LEN, TM_STUFFING_ON,
+	                     config_util_tx);
+	assert_int_equal(ret, -1);
+
+	ret = config_tm_init(&config_tm_tx, &cnt, TM_OCF_NOTPRESENT,
+	                     TM_CRC_PRESENT, TM_FRAME_LEN, TM_STUFFING_OFF,
+	                     config_util_tx);
+	assert_int_equal(ret, 0);
+	ret = config_tm_init(&config_tm_rx, &rx_cnt, TM_OCF_NOTPRESENT,
+	                     TM_CRC_PRESENT, TM_FRAME_LEN, TM_STUFFING_OFF,
+	                     config_util_rx);
+	assert_int_equal(ret, 0);
+	osdlp_tm_set_ops(&config_tm_tx, &config_tm_ops, NULL);
+	osdlp_tm_set_ops(&config_tm_rx, &config_tm_ops, NULL);
+
+	config_sdu_fill();
+	config_received = 0;
+	ret = osdlp_tm_transmit(&config_tm_tx, config_sdu, CONFIG_SDU_LEN);
+	assert_int_equal(ret, 0);
+	assert_int_equal(config_frames, (CONFIG_SDU_LEN - 1)
+	                 / config_tm_tx.mission.max_data_len + 1);
+	assert_int_equal(config_errors, 0);
+	assert_int_equal(config_received, 1);
+	assert_int_equal(rx_cnt, config_frames);
+}
+
+static void
+test_config_tc(void **state)
+{
+	struct cop_config cop;
+	int ret;
+
+	/* Parameters that differ from osdlp_config.h are rejected */
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+	ret = osdlp_tc_init(&config_tc_tx, 101, TC_MAX_SDU_SIZE,
+	                    TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_NOTPRESENT,
+	                    TC_SEG_HDR_PRESENT, TYPE_B, TC_DATA,
+	                    config_util_tx, cop);
+	assert_int_equal(ret, -1);
+	ret = osdlp_tc_init(&config_tc_tx, 101, TC_MAX_SDU_SIZE,
+	                    TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+	                    TC_SEG_HDR_NOTPRESENT, TYPE_B, TC_DATA,
+	                    config_util_tx, cop);
+	assert_int_equal(ret, -1);
+
+	ret = osdlp_tc_init(&config_tc_tx, 101, TC_MAX_SDU_SIZE,
+	                    TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+	                    TC_SEG_HDR_PRESENT, TYPE_B, TC_DATA,
+	                    config_util_tx, cop);
+	assert_int_equal(ret, 0);
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+	ret = osdlp_tc_init(&config_tc_rx, 101, TC_MAX_SDU_SIZE,
+	                    TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+	                    TC_SEG_HDR_PRESENT, TYPE_B, TC_DATA,
+	                    config_util_rx, cop);
+	assert_int_equal(ret, 0);
+	osdlp_tc_set_ops(&config_tc_tx, &config_tc_ops, NULL);
+	osdlp_tc_set_ops(&config_tc_rx, &config_tc_ops, NULL);
+
+	config_sdu_fill();
+	config_received = 0;
+	ret = osdlp_tc_transmit(&config_tc_tx, config_sdu, CONFIG_SDU_LEN);
+	assert_int_equal(ret, TC_TX_OK);
+	assert_int_equal(config_uplink_n, (CONFIG_SDU_LEN - 1)
+	                 / config_tc_tx.mission.max_data_len + 1);
+	for (int i = 0; i < config_uplink_n; i++) {
+		ret = osdlp_tc_receive(config_uplink[i], config_uplink_len[i]);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	assert_int_equal(config_received, 1);
+	assert_int_equal(config_tc_rx.mission.util.loop_state, TC_LOOP_CLOSED);
+}
+
+int
+main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_config_tm),
+		cmocka_unit_test(test_config_tc)
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
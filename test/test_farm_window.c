@@ -45,7 +45,7 @@ test_vr(void **state)
 	uint16_t      down_chann_capacity = 10;
 	uint16_t      sent_item_size = sizeof(struct local_queue_item);
 	uint16_t      sent_capacity = 10;
-	uint16_t      wait_item_size = sizeof(struct tc_transfer_frame);
+	uint16_t      wait_item_size = sizeof(struct tc_wait_desc);
 	uint16_t      rx_item_size = TC_MAX_SDU_SIZE;
 	uint16_t      rx_capacity = 10;
 
@@ -360,4 +360,48 @@ test_vr(void **state)
 	assert_int_equal(tc_rx.mission.clcw.report_value, 1);
 }
 
-
+void
+test_farm_window_wrap(void **state)
+{
+	struct tc_transfer_frame tf;
+	struct farm_config *f = &tf.cop_cfg.farm;
+	farm_result_t ret;
+	uint8_t d;
+
+	memset(&tf, 0, sizeof(tf));
+	tf.primary_hdr.bypass = TYPE_A;
+	/*
+	 * Every V(R) and every N(S) other than V(R) is classified against a
+	 * window of width 10, including those that wrap around 255
+	 */
+	for (int vr = 0; vr < 256; vr++) {
+		for (int ns = 0; ns < 256; ns++) {
+			if (ns == vr) {
+				continue;
+			}
+			osdlp_prepare_farm(f, FARM_STATE_OPEN, 10);
+			f->vr = vr;
+			f->lockout = CLCW_NO_LOCKOUT;
+			f->retransmit = CLCW_NO_RETRANSMIT;
+			tf.primary_hdr.frame_seq_num = ns;
+			ret = osdlp_farm_1(&tf);
+			assert_int_equal(ret, COP_DISCARD);
+
+			d = ns - vr;
+			if (d < 5) {
+				/* Positive window */
+				assert_int_equal(f->state, FARM_STATE_OPEN);
+				assert_int_equal(f->retransmit,
+				                 CLCW_RETRANSMIT);
+			} else if (d >= 256 - 5) {
+				/* Negative window */
+				assert_int_equal(f->state, FARM_STATE_OPEN);
+				assert_int_equal(f->retransmit,
+				                 CLCW_NO_RETRANSMIT);
+			} else {
+				assert_int_equal(f->state, FARM_STATE_LOCKOUT);
+				assert_int_equal(f->lockout, CLCW_LOCKOUT);
+			}
+		}
+	}
+}
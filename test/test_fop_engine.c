@@ -0,0 +1,1116 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test.h"
+
+#define DIFF_STEPS      20000
+#define RING_SLOTS      16
+#define UPLINK_FRAMES   300
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct queue               wait_queues[NUMVCS];
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern struct tc_transfer_frame   tc_tx_unseg;
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+static uint8_t ring_storage[2][(RING_SLOTS + 1) * TC_MAX_FRAME_LEN];
+
+/*
+ * Reference implementation of the FOP-1 CLCW and timer events, as it was
+ * before the table-driven engine. The changes are that E101 in the
+ * INIT_BC state returns NA instead of 0, that N(R) is checked against
+ * NN(R) and V(S) modulo 256 and that the Type-AD frames marked for
+ * retransmission are all sent at once
+ */
+
+static int
+ref_initiate_ad_retransmission(struct tc_transfer_frame *tc_tf)
+{
+	int ret = osdlp_initiate_ad_retransmission(tc_tf);
+	if (ret < 0) {
+		return ret;
+	}
+	return osdlp_retransmit_ad_frames(tc_tf);
+}
+
+static notification_t
+ref_fop_e1(struct tc_transfer_frame *tc_tf)
+{
+	notification_t ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
+			return ALERT_SYNCH;
+		case FOP_STATE_INIT_NO_BC:
+			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
+			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
+			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			return POSITIVE_DIR;
+		case FOP_STATE_INIT_BC:
+			ret = osdlp_release_copy_of_bc(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
+			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
+			tc_tf->cop_cfg.fop.signal = POSITIVE_DIR;
+			return POSITIVE_DIR;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e2(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			osdlp_timer_cancel(tc_tf->primary_hdr.vcid);
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e3(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
+			return ALERT_CLCW;
+		case FOP_STATE_INIT:
+			// Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e4(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
+			return ALERT_SYNCH;
+		case FOP_STATE_INIT_BC:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_INIT:
+			// Ignore
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e5(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_SYNCH;
+			return ALERT_SYNCH;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e6(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_NO_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			tc_tf->cop_cfg.fop.state = FOP_STATE_ACTIVE;
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e7(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_CLCW;
+			return ALERT_CLCW;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			// Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e101(struct tc_transfer_frame *tc_tf,
+         struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
+			return ALERT_LIMIT;
+		case FOP_STATE_RT_WAIT:
+			osdlp_remove_acked_frames(tc_tf, clcw->report_value);
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
+			return ALERT_LIMIT;
+		case FOP_STATE_INIT_NO_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e102(struct tc_transfer_frame *tc_tf,
+         struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_LIMIT;
+			return ALERT_LIMIT;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e8(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_NO_WAIT;
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_NO_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_NO_WAIT;
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e9(struct tc_transfer_frame *tc_tf,
+       struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+			ret = osdlp_remove_acked_frames(tc_tf,
+			                                clcw->report_value);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_RT_WAIT;
+			return IGNORE;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e10(struct tc_transfer_frame *tc_tf,
+        struct clcw_frame *clcw)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_NO_WAIT;
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_NO_WAIT:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_RT_WAIT:
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_NO_WAIT;
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e11(struct tc_transfer_frame *tc_tf,
+        struct clcw_frame *clcw)
+{
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+			// Ignore
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_WAIT;
+			return IGNORE;
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+		case FOP_STATE_INIT:
+			// Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e12(struct tc_transfer_frame *tc_tf,
+        struct clcw_frame *clcw)
+{
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			// ignore
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_NO_WAIT;
+			return IGNORE;
+		case FOP_STATE_RT_NO_WAIT:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_RT_WAIT:
+			// Ignore
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_NO_WAIT;
+			return IGNORE;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e103(struct tc_transfer_frame *tc_tf,
+         struct clcw_frame *clcw)
+{
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+			// Ignore
+			tc_tf->cop_cfg.fop.state =
+			        FOP_STATE_RT_WAIT;
+			return IGNORE;
+		case FOP_STATE_RT_WAIT:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// NA
+			return NA;
+		case FOP_STATE_INIT:
+			//Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e13(struct tc_transfer_frame *tc_tf,
+        struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_NNR;
+			return ALERT_NNR;
+		case FOP_STATE_INIT_BC:
+		case FOP_STATE_INIT:
+			// Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e14(struct tc_transfer_frame *tc_tf,
+        struct clcw_frame *clcw)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_LOCKOUT;
+			return ALERT_LOCKOUT;
+		case FOP_STATE_INIT_BC:
+		case FOP_STATE_INIT:
+			// Ignore
+			return IGNORE;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e16(struct tc_transfer_frame *tc_tf)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_WAIT:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_INIT_NO_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_T1;
+			return ALERT_T1;
+		case FOP_STATE_INIT_BC:
+			ret = osdlp_initiate_bc_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_directive(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT:
+			// NA
+			return NA;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e104(struct tc_transfer_frame *tc_tf)
+{
+	notification_t notif;
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+			ret = ref_initiate_ad_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_fdu(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_RT_WAIT:
+			// Ignore
+			return IGNORE;
+		case FOP_STATE_INIT_NO_BC:
+			// Suspend
+			tc_tf->cop_cfg.fop.ss = 4;
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return SUSPEND;
+		case FOP_STATE_INIT_BC:
+			ret = osdlp_initiate_bc_retransmission(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			notif = osdlp_look_for_directive(tc_tf);
+			if (!(notif == IGNORE)) {
+				tc_tf->cop_cfg.fop.signal = notif;
+				return notif;
+			} else {
+				return tc_tf->cop_cfg.fop.signal;
+			}
+		case FOP_STATE_INIT:
+			// NA
+			return NA;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e17(struct tc_transfer_frame *tc_tf)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+		case FOP_STATE_RT_NO_WAIT:
+		case FOP_STATE_RT_WAIT:
+		case FOP_STATE_INIT_NO_BC:
+		case FOP_STATE_INIT_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_T1;
+			return ALERT_T1;
+		case FOP_STATE_INIT:
+			// NA
+			return NA;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_fop_e18(struct tc_transfer_frame *tc_tf)
+{
+	int ret;
+	switch (tc_tf->cop_cfg.fop.state) {
+		case FOP_STATE_ACTIVE:
+			// Suspend
+			tc_tf->cop_cfg.fop.ss = 1;
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return SUSPEND;
+		case FOP_STATE_RT_NO_WAIT:
+			// Suspend
+			tc_tf->cop_cfg.fop.ss = 2;
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return SUSPEND;
+		case FOP_STATE_RT_WAIT:
+			// Suspend
+			tc_tf->cop_cfg.fop.ss = 3;
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return SUSPEND;
+		case FOP_STATE_INIT_NO_BC:
+			// Suspend
+			tc_tf->cop_cfg.fop.ss = 4;
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			return SUSPEND;
+		case FOP_STATE_INIT_BC:
+			// Alert
+			ret = osdlp_alert(tc_tf);
+			if (ret < 0) {
+				tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+				return UNDEF_ERROR;
+			}
+			tc_tf->cop_cfg.fop.state = FOP_STATE_INIT;
+			tc_tf->cop_cfg.fop.signal = ALERT_T1;
+			return ALERT_T1;
+		case FOP_STATE_INIT:
+			// NA
+			return NA;
+		default:
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+	}
+}
+
+static notification_t
+ref_handle_clcw(struct tc_transfer_frame *tc_tf, uint8_t *ocf_buffer)
+{
+	struct clcw_frame *c = &tc_tf->mission.clcw;
+	struct fop_config *f = &tc_tf->cop_cfg.fop;
+	osdlp_clcw_unpack(c, ocf_buffer);
+	if (c->lockout != CLCW_NO_LOCKOUT) {
+		return ref_fop_e14(tc_tf, c);
+	}
+	if (f->vs == c->report_value) {
+		if (c->rt != CLCW_NO_RETRANSMIT) {
+			return ref_fop_e4(tc_tf, c);
+		}
+		if (c->wait != CLCW_DO_NOT_WAIT) {
+			return ref_fop_e3(tc_tf, c);
+		}
+		if (c->report_value == f->nnr) {
+			return ref_fop_e1(tc_tf);
+		}
+		return ref_fop_e2(tc_tf, c);
+	}
+	/* NN(R) <= N(R) < V(S), modulo 256 */
+	if ((uint8_t)(c->report_value - f->nnr) >= (uint8_t)(f->vs - f->nnr)) {
+		return ref_fop_e13(tc_tf, c);
+	}
+	if (c->rt == CLCW_NO_RETRANSMIT) {
+		if (c->wait != CLCW_DO_NOT_WAIT) {
+			return ref_fop_e7(tc_tf, c);
+		}
+		if (c->report_value == f->nnr) {
+			return ref_fop_e5(tc_tf, c);
+		}
+		return ref_fop_e6(tc_tf, c);
+	}
+	if (f->tx_lim == 1) {
+		if (c->report_value != f->nnr) {
+			return ref_fop_e101(tc_tf, c);
+		}
+		return ref_fop_e102(tc_tf, c);
+	}
+	if (f->tx_lim > 1) {
+		if (c->report_value != f->nnr) {
+			if (c->wait == CLCW_DO_NOT_WAIT) {
+				return ref_fop_e8(tc_tf, c);
+			}
+			return ref_fop_e9(tc_tf, c);
+		}
+		if (f->tx_cnt < f->tx_lim) {
+			if (c->wait == CLCW_DO_NOT_WAIT) {
+				return ref_fop_e10(tc_tf, c);
+			}
+			return ref_fop_e11(tc_tf, c);
+		}
+		if (c->wait == CLCW_DO_NOT_WAIT) {
+			return ref_fop_e12(tc_tf, c);
+		}
+		return ref_fop_e103(tc_tf, c);
+	}
+	f->signal = UNDEF_ERROR;
+	return UNDEF_ERROR;
+}
+
+static notification_t
+ref_handle_timer_expired(struct tc_transfer_frame *tc_tf)
+{
+	notification_t notif;
+	if (tc_tf->cop_cfg.fop.tx_cnt < tc_tf->cop_cfg.fop.tx_lim) {
+		if (tc_tf->cop_cfg.fop.tt == 0) {
+			/*E16*/
+			notif = ref_fop_e16(tc_tf);
+			return notif;
+		} else if (tc_tf->cop_cfg.fop.tt == 1) {
+			/*E104*/
+			notif = ref_fop_e104(tc_tf);
+			return notif;
+		} else {
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+		}
+	} else { // tx_cnt >= tx_lim
+		if (tc_tf->cop_cfg.fop.tt == 0) {
+			/*E17*/
+			notif = ref_fop_e17(tc_tf);
+			return notif;
+		} else if (tc_tf->cop_cfg.fop.tt == 1) {
+			/*E18*/
+			notif = ref_fop_e18(tc_tf);
+			return notif;
+		} else {
+			tc_tf->cop_cfg.fop.signal = UNDEF_ERROR;
+			return UNDEF_ERROR;
+		}
+	}
+}
+
+
+/* Frames sent to the uplink by a step: the sequence number and the type */
+struct uplink_log {
+	uint16_t    n;
+	uint8_t     hdr[2 * UPLINK_FRAMES];
+};
+
+static void
+drain_uplink(struct uplink_log *log)
+{
+	uint8_t frame[TC_MAX_FRAME_LEN];
+	log->n = 0;
+	while (dequeue(&uplink_channel, frame) == 0) {
+		log->hdr[2 * log->n] = frame[0] & 0x30;
+		log->hdr[2 * log->n + 1] = frame[4];
+		log->n++;
+	}
+}
+
+static void
+assert_same_fop(struct tc_transfer_frame *a, struct tc_transfer_frame *b)
+{
+	struct tc_sent_ring *ra = a->sent_ring;
+	struct tc_sent_ring *rb = b->sent_ring;
+	assert_int_equal(a->cop_cfg.fop.state, b->cop_cfg.fop.state);
+	assert_int_equal(a->cop_cfg.fop.signal, b->cop_cfg.fop.signal);
+	assert_int_equal(a->cop_cfg.fop.vs, b->cop_cfg.fop.vs);
+	assert_int_equal(a->cop_cfg.fop.nnr, b->cop_cfg.fop.nnr);
+	assert_int_equal(a->cop_cfg.fop.ss, b->cop_cfg.fop.ss);
+	assert_int_equal(a->cop_cfg.fop.tx_cnt, b->cop_cfg.fop.tx_cnt);
+	assert_int_equal(wait_queues[a->primary_hdr.vcid].inqueue,
+	                 wait_queues[b->primary_hdr.vcid].inqueue);
+	assert_int_equal(ra->count, rb->count);
+	assert_int_equal(ra->head, rb->head);
+	assert_int_equal(ra->bc_held, rb->bc_held);
+	assert_int_equal(ra->bc_rt, rb->bc_rt);
+	assert_memory_equal(ra->rt, rb->rt, sizeof(ra->rt));
+}
+
+static uint8_t
+random_nr(struct tc_transfer_frame *tc_tf)
+{
+	uint8_t span = tc_tf->cop_cfg.fop.vs - tc_tf->cop_cfg.fop.nnr;
+	switch (rand() % 8) {
+		case 0:
+			return rand() % 256;
+		case 1:
+		case 2:
+			return tc_tf->cop_cfg.fop.nnr;
+		default:
+			return tc_tf->cop_cfg.fop.nnr + rand() % (span + 1);
+	}
+}
+
+/* Performs the same random step on both contexts */
+static void
+diff_step(void)
+{
+	struct tc_transfer_frame *tf[2] = {&tc_tx, &tc_tx_unseg};
+	struct uplink_log log[2];
+	struct clcw_frame clcw;
+	notification_t notif[2] = {0, 0};
+	uint8_t data[10] = {0};
+	uint8_t ocf[4];
+	int op = rand() % 100;
+	int arg = rand();
+
+	memset(&clcw, 0, sizeof(struct clcw_frame));
+	clcw.lockout = rand() % 20 == 0;
+	clcw.wait = rand() % 5 == 0;
+	clcw.rt = rand() % 3 == 0;
+	clcw.report_value = random_nr(&tc_tx);
+	osdlp_clcw_pack(&clcw, ocf);
+
+	for (int i = 0; i < 2; i++) {
+		if (op < 35) {
+			osdlp_prepare_typea_data_frame(tf[i], data, 10, 1);
+			osdlp_tc_transmit(tf[i], data, 10);
+		} else if (op < 77) {
+			notif[i] = i ? ref_handle_clcw(tf[i], ocf)
+			           : osdlp_handle_clcw(tf[i], ocf);
+		} else if (op < 85) {
+			notif[i] = i ? ref_handle_timer_expired(tf[i])
+			           : osdlp_handle_timer_expired(tf[i]);
+		} else if (op < 88) {
+			osdlp_initiate_with_unlock(tf[i]);
+		} else if (op < 94) {
+			osdlp_initiate_no_clcw(tf[i]);
+		} else if (op < 97) {
+			tf[i]->cop_cfg.fop.tx_lim = arg % 4;
+			tf[i]->cop_cfg.fop.tt = (arg >> 2) % 3;
+		} else {
+			tf[i]->cop_cfg.fop.state = arg % 7;
+		}
+		drain_uplink(&log[i]);
+	}
+	assert_int_equal(notif[0], notif[1]);
+	assert_int_equal(log[0].n, log[1].n);
+	assert_memory_equal(log[0].hdr, log[1].hdr, 2 * log[0].n);
+	assert_same_fop(&tc_tx, &tc_tx_unseg);
+}
+
+void
+test_fop_engine(void **state)
+{
+	struct tc_sent_ring ring[2];
+	struct tc_transfer_frame tc_rx_ref;
+	struct tc_transfer_frame saved_tx_unseg = tc_tx_unseg;
+	struct cop_config cop_tx_ref;
+	struct cop_config cop_rx_ref;
+	struct fop_config fop_ref;
+	struct farm_config farm_ref;
+
+	setup_queues(TC_MAX_FRAME_LEN, UPLINK_FRAMES,
+	             sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_INIT, 1, 0, 2, FARM_STATE_OPEN, 10);
+	setup_tc_configs(&tc_tx_unseg, &tc_rx_ref, &cop_tx_ref, &cop_rx_ref,
+	                 &fop_ref, &farm_ref, 101, TC_MAX_FRAME_LEN, 10, 0, 1,
+	                 TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+	                 10, FOP_STATE_INIT, 1, 0, 2, FARM_STATE_OPEN, 10);
+	for (int i = 0; i < 2; i++) {
+		osdlp_sent_ring_init(&ring[i], ring_storage[i], RING_SLOTS,
+		                     TC_MAX_FRAME_LEN);
+	}
+	osdlp_sent_ring_attach(&tc_tx, &ring[0]);
+	osdlp_sent_ring_attach(&tc_tx_unseg, &ring[1]);
+
+	srand(1);
+	for (int i = 0; i < DIFF_STEPS; i++) {
+		diff_step();
+	}
+	osdlp_sent_ring_attach(&tc_tx, NULL);
+	tc_tx_unseg = saved_tx_unseg;
+}
@@ -0,0 +1,83 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+void
+test_fop_nr_wrap(void **state)
+{
+	struct clcw_frame clcw;
+	uint8_t data[20] = {0};
+	uint8_t stale[4];
+	uint8_t ocf[4];
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	tc_tx.cop_cfg.fop.vs = 254;
+	tc_tx.cop_cfg.fop.nnr = 254;
+	tc_rx.cop_cfg.farm.vr = 254;
+	osdlp_prepare_clcw(&tc_rx, stale);
+
+	/* Take V(S) past 255 while NN(R) stays at 254 */
+	for (int i = 0; i < 3; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, data, 20);
+		assert_int_equal(ret, TC_TX_OK);
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	assert_int_equal(tc_tx.cop_cfg.fop.vs, 1);
+	assert_int_equal(tc_rx.cop_cfg.farm.vr, 1);
+
+	/* A CLCW sent before the frames arrived has N(R) == NN(R) */
+	osdlp_handle_clcw(&tc_tx, stale);
+	assert_int_equal(tc_tx.cop_cfg.fop.state, FOP_STATE_ACTIVE);
+	assert_int_equal(tc_tx.cop_cfg.fop.nnr, 254);
+
+	/* Acknowledging across the wrap-around removes the frames */
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(tc_tx.cop_cfg.fop.state, FOP_STATE_ACTIVE);
+	assert_int_equal(tc_tx.cop_cfg.fop.nnr, 1);
+
+	/* An N(R) outside NN(R)..V(S) still raises the alert */
+	osdlp_clcw_unpack(&clcw, ocf);
+	clcw.report_value = 100;
+	osdlp_clcw_pack(&clcw, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(tc_tx.cop_cfg.fop.state, FOP_STATE_INIT);
+	assert_int_equal(tc_tx.cop_cfg.fop.signal, ALERT_NNR);
+}
@@ -0,0 +1,152 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define POOL_FRAMES     8
+#define RING_SLOTS      16
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct queue               sent_queues[NUMVCS];
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+static uint8_t pool_storage[POOL_FRAMES * TC_MAX_FRAME_LEN];
+static uint8_t pool_refcnt[POOL_FRAMES];
+static uint8_t *ring_refs[RING_SLOTS + 1];
+
+void
+test_frame_pool(void **state)
+{
+	struct tc_frame_pool pool;
+	struct tc_sent_ring ring;
+	uint8_t *frames[POOL_FRAMES];
+	uint8_t buf[TC_MAX_SDU_SIZE];
+	uint8_t ocf[4];
+	notification_t notif;
+	int ret;
+
+	ret = osdlp_frame_pool_init(&pool, pool_storage, pool_refcnt, 0,
+	                            TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, -1);
+	ret = osdlp_frame_pool_init(&pool, pool_storage, pool_refcnt,
+	                            POOL_FRAMES, 2);
+	assert_int_equal(ret, -1);
+	ret = osdlp_frame_pool_init(&pool, pool_storage, pool_refcnt,
+	                            POOL_FRAMES, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, 0);
+	assert_int_equal(pool.slab.available, POOL_FRAMES);
+
+	/* Frames are distinct and returned only after the last reference */
+	for (int i = 0; i < POOL_FRAMES; i++) {
+		frames[i] = osdlp_frame_pool_alloc(&pool);
+		assert_non_null(frames[i]);
+		assert_true(osdlp_frame_pool_owns(&pool, frames[i]));
+		for (int j = 0; j < i; j++) {
+			assert_true(frames[i] != frames[j]);
+		}
+	}
+	assert_null(osdlp_frame_pool_alloc(&pool));
+	assert_false(osdlp_frame_pool_owns(&pool, buf));
+	osdlp_frame_pool_ref(&pool, frames[3]);
+	osdlp_frame_pool_unref(&pool, frames[3]);
+	assert_int_equal(pool.slab.available, 0);
+	osdlp_frame_pool_unref(&pool, frames[3]);
+	assert_int_equal(pool.slab.available, 1);
+	assert_true(osdlp_frame_pool_alloc(&pool) == frames[3]);
+	for (int i = 0; i < POOL_FRAMES; i++) {
+		osdlp_frame_pool_unref(&pool, frames[i]);
+	}
+	assert_int_equal(pool.slab.available, POOL_FRAMES);
+
+	/* COP-1 sharing the frames between the uplink and a shared sent ring */
+	ret = osdlp_sent_ring_init_shared(&ring, NULL, ring_refs, RING_SLOTS);
+	assert_int_equal(ret, -1);
+	ret = osdlp_sent_ring_init_shared(&ring, &pool, NULL, RING_SLOTS);
+	assert_int_equal(ret, -1);
+	ret = osdlp_sent_ring_init_shared(&ring, &pool, ring_refs, RING_SLOTS);
+	assert_int_equal(ret, 0);
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_INIT, 1, 0, 10, FARM_STATE_OPEN, 10);
+	osdlp_frame_pool_attach(&tc_tx, &pool);
+	osdlp_sent_ring_attach(&tc_tx, &ring);
+	for (int i = 0; i < 100; i++) {
+		buf[i] = rand() % 256;
+	}
+	notif = osdlp_initiate_no_clcw(&tc_tx);
+	assert_int_equal(notif, POSITIVE_DIR);
+	for (int i = 0; i < 3; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, buf, 100);
+		assert_int_equal(ret, TC_TX_OK);
+	}
+	assert_int_equal(ring.count, 3);
+	assert_int_equal(sent_queues[1].inqueue, 0);
+	assert_int_equal(pool.slab.available, POOL_FRAMES - 3);
+
+	/* Each frame keeps its own contents and is held by both queues */
+	for (int i = 0; i < 3; i++) {
+		frames[i] = ring.refs[i];
+		assert_int_equal(frames[i][4], i);
+		assert_int_equal(pool_refcnt[(frames[i] - pool_storage)
+		                             / TC_MAX_FRAME_LEN], 2);
+	}
+	for (int i = 0; i < 3; i++) {
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		assert_memory_equal(test_util, frames[i], TC_MAX_FRAME_LEN);
+		osdlp_tc_tx_done(&tc_tx, frames[i]);
+		if (i < 2) {
+			ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+			assert_int_equal(ret, TC_RX_OK);
+		}
+	}
+	assert_int_equal(pool.slab.available, POOL_FRAMES - 3);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	notif = osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(notif, ACCEPT_TX);
+	assert_int_equal(ring.count, 1);
+	assert_int_equal(pool.slab.available, POOL_FRAMES - 1);
+
+	/* The retransmission shares the frame of the sent ring */
+	osdlp_handle_timer_expired(&tc_tx);
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	assert_int_equal(test_util[4], 2);
+	assert_int_equal(pool.slab.available, POOL_FRAMES - 1);
+	osdlp_tc_tx_done(&tc_tx, frames[2]);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	assert_true(osdlp_sent_ring_empty(&ring));
+	assert_int_equal(pool.slab.available, POOL_FRAMES);
+	osdlp_sent_ring_attach(&tc_tx, NULL);
+	osdlp_frame_pool_attach(&tc_tx, NULL);
+}
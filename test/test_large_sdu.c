@@ -0,0 +1,238 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Built separately with -DOSDLP_LARGE_SDU, as the SDU length type and the
+ * signature of osdlp_tm_get_packet_len() depend on it
+ */
+
+#include "test.h"
+
+#define LARGE_SDU_MAX       80000
+#define LARGE_SDU_LEN       70001
+#define LARGE_FRAME_LEN     1024
+#define LARGE_TC_FRAMES     80
+
+OSDLP_STATIC_ASSERT(sizeof(osdlp_sdu_len_t) == sizeof(uint32_t),
+                    large_sdu_len);
+
+static struct tm_transfer_frame large_tx;
+static struct tm_transfer_frame large_rx;
+static uint8_t large_util_tx[LARGE_SDU_MAX];
+static uint8_t large_util_rx[LARGE_SDU_MAX];
+static uint8_t large_sdu[LARGE_SDU_LEN];
+static int large_frames;
+static int large_received;
+static int large_errors;
+
+static struct tc_transfer_frame large_tc_tx;
+static struct tc_transfer_frame large_tc_rx;
+static uint8_t large_uplink[LARGE_TC_FRAMES][LARGE_FRAME_LEN];
+static uint16_t large_uplink_len[LARGE_TC_FRAMES];
+static int large_uplink_n;
+
+bool
+osdlp_tm_tx_queue_empty(uint8_t vcid)
+{
+	return true;
+}
+
+int
+osdlp_tm_tx_queue_back(uint8_t **pkt, uint8_t vcid)
+{
+	return -1;
+}
+
+void
+osdlp_tm_tx_commit_back(uint8_t vcid)
+{
+	return;
+}
+
+/* The downlink is a loopback, each frame is received as it is sent */
+int
+osdlp_tm_tx_queue_enqueue(uint8_t *pkt, uint8_t vcid)
+{
+	int ret = osdlp_tm_receive(pkt);
+	if (ret < 0 && ret != -TM_RX_PENDING) {
+		large_errors++;
+	}
+	large_frames++;
+	return 0;
+}
+
+int
+osdlp_tm_rx_queue_enqueue(uint8_t *pkt, uint8_t vcid)
+{
+	assert_memory_equal(pkt, large_sdu, LARGE_SDU_LEN);
+	large_received++;
+	return 0;
+}
+
+int
+osdlp_tm_get_rx_config(struct tm_transfer_frame **tm, uint8_t vcid)
+{
+	*tm = &large_rx;
+	return 0;
+}
+
+/* The packets carry their length in a 32-bit field */
+int
+osdlp_tm_get_packet_len(uint32_t *length, uint8_t *pkt, uint32_t mem_len)
+{
+	if (mem_len < 4) {
+		return -1;
+	}
+	*length = ((uint32_t)pkt[0] << 24) | (pkt[1] << 16) | (pkt[2] << 8)
+	          | pkt[3];
+	return *length <= LARGE_SDU_MAX ? 0 : -1;
+}
+
+int
+osdlp_tc_get_rx_config(struct tc_transfer_frame **tc_tf, uint16_t vcid)
+{
+	*tc_tf = &large_tc_rx;
+	return 0;
+}
+
+static bool
+large_tc_tx_queue_full(void *user, uint16_t vcid)
+{
+	return large_uplink_n == LARGE_TC_FRAMES;
+}
+
+/* The uplink keeps every frame until the receiver reads them */
+static int
+large_tc_tx_queue_enqueue(void *user, uint8_t *buffer, uint16_t vcid)
+{
+	uint16_t len = (((buffer[2] & 0x03) << 8) | buffer[3]) + 1;
+	memcpy(large_uplink[large_uplink_n], buffer, len);
+	large_uplink_len[large_uplink_n++] = len;
+	return 0;
+}
+
+static int
+large_tc_rx_queue_enqueue_now(void *user, uint8_t *buffer, uint32_t length,
+                              uint16_t vcid)
+{
+	assert_int_equal(length, LARGE_SDU_LEN);
+	assert_memory_equal(buffer, large_sdu, LARGE_SDU_LEN);
+	large_received++;
+	return 0;
+}
+
+static const struct osdlp_tc_ops large_tc_ops = {
+	.tx_queue_full          = large_tc_tx_queue_full,
+	.tx_queue_enqueue       = large_tc_tx_queue_enqueue,
+	.rx_queue_enqueue_now   = large_tc_rx_queue_enqueue_now
+};
+
+static void
+large_sdu_fill(void)
+{
+	for (uint32_t i = 0; i < LARGE_SDU_LEN; i++) {
+		large_sdu[i] = (i * 7) & 0xff;
+	}
+	large_sdu[0] = (LARGE_SDU_LEN >> 24) & 0xff;
+	large_sdu[1] = (LARGE_SDU_LEN >> 16) & 0xff;
+	large_sdu[2] = (LARGE_SDU_LEN >> 8) & 0xff;
+	large_sdu[3] = LARGE_SDU_LEN & 0xff;
+}
+
+static void
+test_large_sdu(void **state)
+{
+	uint8_t cnt = 0;
+	int ret;
+
+	ret = osdlp_tm_init(&large_tx, 30, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0,
+	                    0, 0, NULL, TM_CRC_PRESENT, LARGE_FRAME_LEN,
+	                    LARGE_SDU_MAX, 2, TM_TX_CAPACITY,
+	                    TM_STUFFING_OFF, large_util_tx);
+	assert_int_equal(ret, 0);
+	ret = osdlp_tm_init(&large_rx, 30, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0,
+	                    0, 0, NULL, TM_CRC_PRESENT, LARGE_FRAME_LEN,
+	                    LARGE_SDU_MAX, 2, TM_TX_CAPACITY,
+	                    TM_STUFFING_OFF, large_util_rx);
+	assert_int_equal(ret, 0);
+	assert_int_equal(large_rx.mission.max_sdu_len, LARGE_SDU_MAX);
+
+	large_sdu_fill();
+	ret = osdlp_tm_transmit(&large_tx, large_sdu, LARGE_SDU_LEN);
+	assert_int_equal(ret, 0);
+	assert_int_equal(large_frames, (LARGE_SDU_LEN - 1)
+	                 / large_tx.mission.max_data_len + 1);
+	assert_int_equal(large_errors, 0);
+	assert_int_equal(large_received, 1);
+	assert_int_equal(large_rx.mission.util.loop_state, TM_LOOP_CLOSED);
+}
+
+/* A TC SDU is segmented into BD frames and reassembled by the receiver */
+static void
+test_large_sdu_tc(void **state)
+{
+	struct cop_config cop;
+	uint32_t seg_len;
+	int ret;
+
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+	ret = osdlp_tc_init(&large_tc_tx, 101, LARGE_SDU_MAX, LARGE_FRAME_LEN,
+	                    10, 1, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT,
+	                    TYPE_B, TC_DATA, large_util_tx, cop);
+	assert_int_equal(ret, 0);
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+	ret = osdlp_tc_init(&large_tc_rx, 101, LARGE_SDU_MAX, LARGE_FRAME_LEN,
+	                    10, 1, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT,
+	                    TYPE_B, TC_DATA, large_util_rx, cop);
+	assert_int_equal(ret, 0);
+	osdlp_tc_set_ops(&large_tc_tx, &large_tc_ops, NULL);
+	osdlp_tc_set_ops(&large_tc_rx, &large_tc_ops, NULL);
+
+	seg_len = large_tc_rx.mission.max_data_len;
+	large_sdu_fill();
+	large_received = 0;
+	ret = osdlp_tc_transmit(&large_tc_tx, large_sdu, LARGE_SDU_LEN);
+	assert_int_equal(ret, TC_TX_OK);
+	assert_int_equal(large_uplink_n, (LARGE_SDU_LEN - 1)
+	                 / large_tc_tx.mission.max_data_len + 1);
+	assert_int_equal(large_tc_tx.seg_status.flag, SEG_ENDED);
+
+	for (int i = 0; i < large_uplink_n; i++) {
+		ret = osdlp_tc_receive(large_uplink[i], large_uplink_len[i]);
+		assert_int_equal(ret, TC_RX_OK);
+		if (i > 0 && i < large_uplink_n - 1) {
+			assert_int_equal(large_tc_rx.mission.util.buffered_length,
+			                 (i + 1) * seg_len);
+		}
+	}
+	assert_int_equal(large_received, 1);
+	assert_int_equal(large_tc_rx.mission.util.loop_state, TC_LOOP_CLOSED);
+}
+
+int
+main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(test_large_sdu),
+		cmocka_unit_test(test_large_sdu_tc)
+	};
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
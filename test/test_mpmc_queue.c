@@ -0,0 +1,214 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+
+#define MPMC_CELLS          8
+#define MPMC_PRODUCERS      4
+#define MPMC_CONSUMERS      2
+#define MPMC_THREAD_N       20000
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+
+static uint8_t mpmc_storage[MPMC_CELLS * MPMC_QUEUE_STRIDE(TC_MAX_FRAME_LEN)]
+__attribute__((aligned(4)));
+static uint8_t mpmc_util[2][TC_MAX_SDU_SIZE];
+
+struct mpmc_thread {
+	struct osdlp_mpmc_queue *q;
+	uint16_t                vcid;
+	uint32_t                received;
+	uint32_t                next[MPMC_PRODUCERS];
+	int                     in_order;
+};
+
+static uint32_t mpmc_remaining;
+
+static void *
+mpmc_producer(void *arg)
+{
+	struct mpmc_thread *t = arg;
+	for (uint32_t i = 0; i < MPMC_THREAD_N; i++) {
+		while (osdlp_mpmc_queue_enqueue(t->q, (uint8_t *)&i, 4,
+		                                t->vcid) < 0) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+/* Frames of a producer reach each consumer in the order they were sent */
+static void *
+mpmc_consumer(void *arg)
+{
+	struct mpmc_thread *t = arg;
+	uint32_t seq;
+	uint32_t len;
+	uint16_t vcid;
+	while (__atomic_load_n(&mpmc_remaining, __ATOMIC_RELAXED) > 0) {
+		if (osdlp_mpmc_queue_dequeue(t->q, (uint8_t *)&seq, &len,
+		                             &vcid) < 0) {
+			sched_yield();
+			continue;
+		}
+		__atomic_fetch_sub(&mpmc_remaining, 1, __ATOMIC_RELAXED);
+		if (len != 4 || vcid >= MPMC_PRODUCERS || seq < t->next[vcid]) {
+			t->in_order = 0;
+		} else {
+			t->next[vcid] = seq + 1;
+		}
+		t->received++;
+	}
+	return NULL;
+}
+
+static void
+test_mpmc_queue_threads(void)
+{
+	struct osdlp_mpmc_queue q;
+	struct mpmc_thread prod[MPMC_PRODUCERS];
+	struct mpmc_thread cons[MPMC_CONSUMERS];
+	pthread_t prod_th[MPMC_PRODUCERS];
+	pthread_t cons_th[MPMC_CONSUMERS];
+	uint32_t received = 0;
+
+	osdlp_mpmc_queue_init(&q, mpmc_storage, MPMC_CELLS, 4, 0);
+	mpmc_remaining = MPMC_PRODUCERS * MPMC_THREAD_N;
+	memset(cons, 0, sizeof(cons));
+	for (int i = 0; i < MPMC_CONSUMERS; i++) {
+		cons[i].q = &q;
+		cons[i].in_order = 1;
+		pthread_create(&cons_th[i], NULL, mpmc_consumer, &cons[i]);
+	}
+	for (int i = 0; i < MPMC_PRODUCERS; i++) {
+		prod[i].q = &q;
+		prod[i].vcid = i;
+		pthread_create(&prod_th[i], NULL, mpmc_producer, &prod[i]);
+	}
+	for (int i = 0; i < MPMC_PRODUCERS; i++) {
+		pthread_join(prod_th[i], NULL);
+	}
+	for (int i = 0; i < MPMC_CONSUMERS; i++) {
+		pthread_join(cons_th[i], NULL);
+		assert_true(cons[i].in_order);
+		received += cons[i].received;
+	}
+	assert_int_equal(received, MPMC_PRODUCERS * MPMC_THREAD_N);
+	for (int i = 0; i < MPMC_PRODUCERS; i++) {
+		assert_int_equal(osdlp_mpmc_queue_count(&q, i), 0);
+	}
+}
+
+void
+test_mpmc_queue(void **state)
+{
+	struct osdlp_mpmc_queue q;
+	struct tc_transfer_frame tc_tf[2];
+	struct cop_config cop;
+	uint8_t frame[TC_MAX_FRAME_LEN];
+	uint8_t data[20] = {0};
+	uint32_t len;
+	uint16_t vcid;
+	int ret;
+
+	ret = osdlp_mpmc_queue_init(&q, mpmc_storage, 6, 8, 0);
+	assert_int_equal(ret, -1);
+	ret = osdlp_mpmc_queue_init(&q, mpmc_storage, MPMC_CELLS, 8, 3);
+	assert_int_equal(ret, 0);
+	assert_true((uint8_t *)&q.dequeue_pos - (uint8_t *)&q.enqueue_pos
+	            >= OSDLP_CACHE_LINE);
+
+	/* Per VC share and FIFO order over several laps */
+	assert_int_equal(osdlp_mpmc_queue_enqueue(&q, data, 9, 0), -1);
+	assert_int_equal(osdlp_mpmc_queue_enqueue(&q, data, 1, 64), -1);
+	for (int lap = 0; lap < 3; lap++) {
+		for (int i = 0; i < 3; i++) {
+			data[0] = i;
+			ret = osdlp_mpmc_queue_enqueue(&q, data, i + 1, 1);
+			assert_int_equal(ret, 0);
+			data[0] = 10 + i;
+			ret = osdlp_mpmc_queue_enqueue(&q, data, 1, 2);
+			assert_int_equal(ret, 0);
+		}
+		assert_true(osdlp_mpmc_queue_full(&q, 1));
+		assert_int_equal(osdlp_mpmc_queue_enqueue(&q, data, 1, 1), -1);
+		assert_false(osdlp_mpmc_queue_full(&q, 3));
+		assert_int_equal(osdlp_mpmc_queue_count(&q, 1), 3);
+		for (int i = 0; i < 6; i++) {
+			ret = osdlp_mpmc_queue_dequeue(&q, frame, &len, &vcid);
+			assert_int_equal(ret, 0);
+			assert_int_equal(vcid, 1 + (i & 1));
+			assert_int_equal(frame[0], (i & 1) * 10 + i / 2);
+			assert_int_equal(len, (i & 1) ? 1 : i / 2 + 1);
+		}
+		ret = osdlp_mpmc_queue_dequeue(&q, frame, &len, NULL);
+		assert_int_equal(ret, -1);
+	}
+
+	/* Without a share, the capacity of the queue is the limit */
+	osdlp_mpmc_queue_init(&q, mpmc_storage, MPMC_CELLS, 8, 0);
+	for (int i = 0; i < MPMC_CELLS; i++) {
+		assert_int_equal(osdlp_mpmc_queue_enqueue(&q, data, 1, 0), 0);
+	}
+	assert_true(osdlp_mpmc_queue_full(&q, 1));
+	assert_int_equal(osdlp_mpmc_queue_enqueue(&q, data, 1, 1), -1);
+	assert_int_equal(osdlp_mpmc_queue_count(&q, 1), 0);
+
+	test_mpmc_queue_threads();
+
+	/* Two virtual channels sharing the uplink */
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	osdlp_mpmc_queue_init(&q, mpmc_storage, MPMC_CELLS, 8, 2);
+	for (int i = 0; i < 2; i++) {
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+		osdlp_tc_init(&tc_tf[i], 101, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+		              10, 1 + i, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT,
+		              TYPE_A, TC_DATA, mpmc_util[i], cop);
+		assert_int_equal(osdlp_mpmc_queue_attach(&tc_tf[i], &q), -1);
+	}
+	osdlp_mpmc_queue_init(&q, mpmc_storage, MPMC_CELLS, TC_MAX_FRAME_LEN,
+	                      2);
+	for (int i = 0; i < 2; i++) {
+		assert_int_equal(osdlp_mpmc_queue_attach(&tc_tf[i], &q), 0);
+	}
+	assert_int_equal(osdlp_tc_transmit(&tc_tf[0], data, 20), TC_TX_OK);
+	assert_int_equal(osdlp_tc_transmit(&tc_tf[0], data, 10), TC_TX_OK);
+	ret = osdlp_tc_transmit(&tc_tf[0], data, 10);
+	assert_int_equal(ret, -TC_TX_COP_ERR);
+	assert_int_equal(osdlp_tc_transmit(&tc_tf[1], data, 20), TC_TX_OK);
+	assert_int_equal(uplink_channel.inqueue, 0);
+
+	for (int i = 0; i < 3; i++) {
+		ret = osdlp_mpmc_queue_dequeue(&q, frame, &len, &vcid);
+		assert_int_equal(ret, 0);
+		assert_int_equal(vcid, i < 2 ? 1 : 2);
+		assert_int_equal(frame[2] >> 2, vcid);
+		assert_int_equal(len,
+		                 (((frame[2] & 0x03) << 8) | frame[3]) + 1);
+	}
+	assert_int_equal(osdlp_mpmc_queue_dequeue(&q, frame, &len, NULL), -1);
+	osdlp_mpmc_queue_attach(&tc_tf[0], NULL);
+	assert_true(tc_tf[0].uplink == NULL);
+}
@@ -429,7 +429,7 @@ test_operation(void **state)
 	uint16_t      down_chann_capacity = 10;
 	uint16_t      sent_item_size = sizeof(struct local_queue_item);
 	uint16_t      sent_capacity = 10;
-	uint16_t      wait_item_size = sizeof(struct tc_transfer_frame);
+	uint16_t      wait_item_size = sizeof(struct tc_wait_desc);
 	uint16_t      rx_item_size = TC_MAX_SDU_SIZE;
 	uint16_t      rx_capacity = 10;
 
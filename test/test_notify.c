@@ -0,0 +1,115 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define NOTIFY_MAX      16
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+struct notify_log {
+	notification_t  notif[NOTIFY_MAX];
+	uint8_t         state[NOTIFY_MAX];
+	int             n;
+};
+
+static void
+notify_record(struct tc_transfer_frame *tc_tf, notification_t notif,
+              void *arg)
+{
+	struct notify_log *log = arg;
+	if (log->n < NOTIFY_MAX) {
+		log->notif[log->n] = notif;
+		log->state[log->n] = tc_tf->cop_cfg.fop.state;
+	}
+	log->n++;
+}
+
+void
+test_notify(void **state)
+{
+	struct notify_log log = {0};
+	uint8_t data[20] = {0};
+	uint8_t ocf[4];
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_INIT, 1, 0, 10, FARM_STATE_OPEN, 10);
+	assert_true(tc_tx.notify == NULL);
+	osdlp_tc_set_notify(&tc_tx, notify_record, &log);
+
+	/* Every notification is reported, not only the last one */
+	osdlp_initiate_no_clcw(&tc_tx);
+	for (int i = 0; i < 2; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, data, 20);
+		assert_int_equal(ret, TC_TX_OK);
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(log.n, 3);
+	assert_int_equal(log.notif[0], POSITIVE_DIR);
+	assert_int_equal(log.state[0], FOP_STATE_ACTIVE);
+	assert_int_equal(log.notif[1], ACCEPT_TX);
+	assert_int_equal(log.notif[2], ACCEPT_TX);
+
+	/* Polling only sees the last notification of the terminate directive */
+	osdlp_terminate_ad(&tc_tx);
+	assert_int_equal(log.n, 5);
+	assert_int_equal(log.notif[3], NEGATIVE_TX);
+	assert_int_equal(log.notif[4], POSITIVE_DIR);
+	assert_int_equal(log.state[4], FOP_STATE_INIT);
+	assert_int_equal(tc_tx.cop_cfg.fop.signal, POSITIVE_DIR);
+	assert_int_equal(tc_tx.notify_cnt, 5);
+
+	osdlp_tc_set_notify(&tc_tx, NULL, NULL);
+	osdlp_initiate_no_clcw(&tc_tx);
+	assert_int_equal(log.n, 5);
+	assert_int_equal(tc_tx.notify_cnt, 6);
+
+	/* A full uplink queue rejects the SDU through the callback too */
+	log.n = 0;
+	osdlp_tc_set_notify(&tc_tx, notify_record, &log);
+	for (int i = 0; i < 10; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, data, 20);
+		assert_int_equal(ret, TC_TX_OK);
+	}
+	assert_int_equal(log.n, 10);
+	ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, -TC_TX_COP_ERR);
+	assert_int_equal(log.n, 11);
+	assert_int_equal(log.notif[10], REJECT_TX);
+	assert_int_equal(tc_tx.cop_cfg.fop.signal, REJECT_TX);
+}
@@ -0,0 +1,218 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define OPS_STACKS      2
+#define OPS_UPLINK      4
+#define OPS_SLOTS       16
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+
+/* The queues and the timer of an independent link stack */
+struct ops_stack {
+	uint8_t                 uplink[OPS_UPLINK][TC_MAX_FRAME_LEN];
+	int                     nuplink;
+	struct tc_wait_desc     wait;
+	int                     waiting;
+	int                     timer;
+	int                     rx;
+	uint32_t                rx_len;
+};
+
+static struct ops_stack stacks[OPS_STACKS];
+static uint8_t ops_ring[OPS_STACKS][(OPS_SLOTS + 1) * TC_MAX_FRAME_LEN];
+static uint8_t ops_util[2 * OPS_STACKS][TC_MAX_SDU_SIZE];
+
+static int
+ops_wait_enqueue(void *user, void *item, uint16_t vcid)
+{
+	struct ops_stack *s = user;
+	if (s->waiting) {
+		return -1;
+	}
+	memcpy(&s->wait, item, sizeof(struct tc_wait_desc));
+	s->waiting = 1;
+	return 0;
+}
+
+static int
+ops_wait_dequeue(void *user, void *item, uint16_t vcid)
+{
+	struct ops_stack *s = user;
+	if (!s->waiting) {
+		return -1;
+	}
+	memcpy(item, &s->wait, sizeof(struct tc_wait_desc));
+	s->waiting = 0;
+	return 0;
+}
+
+static bool
+ops_wait_empty(void *user, uint16_t vcid)
+{
+	return !((struct ops_stack *)user)->waiting;
+}
+
+static int
+ops_wait_clear(void *user, uint16_t vcid)
+{
+	((struct ops_stack *)user)->waiting = 0;
+	return 0;
+}
+
+static bool
+ops_tx_full(void *user, uint16_t vcid)
+{
+	return ((struct ops_stack *)user)->nuplink == OPS_UPLINK;
+}
+
+static int
+ops_tx_enqueue(void *user, uint8_t *buffer, uint16_t vcid)
+{
+	struct ops_stack *s = user;
+	memcpy(s->uplink[s->nuplink++], buffer, TC_MAX_FRAME_LEN);
+	return 0;
+}
+
+static int
+ops_cancel_lower(void *user, uint16_t vcid)
+{
+	((struct ops_stack *)user)->nuplink = 0;
+	return 0;
+}
+
+static int
+ops_timer_start(void *user, uint16_t vcid)
+{
+	((struct ops_stack *)user)->timer = 1;
+	return 0;
+}
+
+static int
+ops_timer_cancel(void *user, uint16_t vcid)
+{
+	((struct ops_stack *)user)->timer = 0;
+	return 0;
+}
+
+static bool
+ops_rx_full(void *user, uint16_t vcid)
+{
+	return false;
+}
+
+static int
+ops_rx_enqueue(void *user, uint8_t *buffer, uint32_t length, uint16_t vcid)
+{
+	struct ops_stack *s = user;
+	s->rx++;
+	s->rx_len = length;
+	return 0;
+}
+
+/* The sent queue operations are not needed, as a sent ring is attached */
+static const struct osdlp_tc_ops test_tc_ops = {
+	.wait_queue_enqueue     = ops_wait_enqueue,
+	.wait_queue_dequeue     = ops_wait_dequeue,
+	.wait_queue_empty       = ops_wait_empty,
+	.wait_queue_clear       = ops_wait_clear,
+	.tx_queue_full          = ops_tx_full,
+	.tx_queue_enqueue       = ops_tx_enqueue,
+	.cancel_lower_ops       = ops_cancel_lower,
+	.timer_start            = ops_timer_start,
+	.timer_cancel           = ops_timer_cancel,
+	.rx_queue_full          = ops_rx_full,
+	.rx_queue_enqueue       = ops_rx_enqueue,
+	.rx_queue_enqueue_now   = ops_rx_enqueue
+};
+
+void
+test_ops(void **state)
+{
+	struct tc_transfer_frame tx[OPS_STACKS];
+	struct tc_transfer_frame rx[OPS_STACKS];
+	struct tc_transfer_frame *tc_tf;
+	struct tc_sent_ring ring[OPS_STACKS];
+	struct tc_registry_slot slots[4];
+	struct tc_registry reg;
+	struct cop_config cop;
+	uint8_t data[20] = {0};
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	memset(stacks, 0, sizeof(stacks));
+	osdlp_tc_registry_init(&reg, slots, 4);
+
+	/* Two stacks using the same VCID, one per spacecraft */
+	for (int i = 0; i < OPS_STACKS; i++) {
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+		osdlp_tc_init(&tx[i], 101 + i, TC_MAX_SDU_SIZE,
+		              TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, ops_util[i],
+		              cop);
+		assert_true(tx[i].ops == &osdlp_tc_default_ops);
+		osdlp_tc_set_ops(&tx[i], &test_tc_ops, &stacks[i]);
+		osdlp_sent_ring_init(&ring[i], ops_ring[i], OPS_SLOTS,
+		                     TC_MAX_FRAME_LEN);
+		osdlp_sent_ring_attach(&tx[i], &ring[i]);
+
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+		osdlp_tc_init(&rx[i], 101 + i, TC_MAX_SDU_SIZE,
+		              TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+		              ops_util[OPS_STACKS + i], cop);
+		osdlp_tc_set_ops(&rx[i], &test_tc_ops, &stacks[i]);
+		osdlp_tc_registry_add(&reg, &rx[i]);
+	}
+
+	ret = osdlp_tc_transmit(&tx[0], data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	ret = osdlp_tc_transmit(&tx[1], data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	ret = osdlp_tc_transmit(&tx[1], data, 10);
+	assert_int_equal(ret, TC_TX_OK);
+
+	assert_int_equal(stacks[0].nuplink, 1);
+	assert_int_equal(stacks[1].nuplink, 2);
+	assert_int_equal(stacks[0].timer, 1);
+	assert_int_equal(stacks[1].timer, 1);
+	assert_int_equal(uplink_channel.inqueue, 0);
+
+	/* Received frames reach the queues of their own stack */
+	for (int i = 0; i < 2; i++) {
+		ret = osdlp_tc_registry_receive(&reg, stacks[1].uplink[i],
+		                                TC_MAX_FRAME_LEN, &tc_tf);
+		assert_int_equal(ret, TC_RX_OK);
+		assert_true(tc_tf == &rx[1]);
+		assert_int_equal(stacks[1].rx, i + 1);
+		assert_int_equal(stacks[1].rx_len, i ? 10 : 20);
+	}
+	assert_int_equal(stacks[0].rx, 0);
+
+	/* NULL restores the global hooks */
+	osdlp_tc_set_ops(&tx[0], NULL, NULL);
+	assert_true(tx[0].ops == &osdlp_tc_default_ops);
+	assert_true(tx[0].user == NULL);
+}
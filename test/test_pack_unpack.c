@@ -115,3 +115,70 @@ test_tc(void **state)
 	assert_int_equal(tc_tx.crc, tc_rx.crc);
 }
 
+
+extern struct tc_transfer_frame   tc_rx;
+
+void
+test_tc_rx_decode(void **state)
+{
+	uint8_t tx_buf[TC_MAX_FRAME_LEN];
+	uint8_t data[100];
+	uint8_t util[100];
+	for (int i = 0; i < 100; i++)
+		data[i] = rand() % 256;
+	struct tc_transfer_frame tc_tx;
+	struct tc_transfer_frame *tc_tf;
+	struct cop_config cop;
+	uint16_t scid           = 101;
+	uint8_t vcid            = 1;
+	uint8_t mapid           = 20;
+	uint16_t frame_len;
+	int ret = osdlp_tc_init(&tc_tx, scid, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	                        10, vcid, mapid, TC_CRC_PRESENT,
+	                        TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, util, cop);
+	assert_int_equal(0, ret);
+	ret = osdlp_tc_init(&tc_rx, scid, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	                    10, vcid, 0, TC_CRC_PRESENT,
+	                    TC_SEG_HDR_PRESENT, TYPE_B, TC_COMMAND, util, cop);
+	assert_int_equal(0, ret);
+
+	tc_tx.cop_cfg.fop.vs = 42;
+	tc_tx.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	osdlp_tc_pack(&tc_tx, tx_buf, data, 100);
+	frame_len = tc_tx.mission.fixed_overhead_len + 100;
+
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, frame_len);
+	assert_int_equal(ret, 0);
+	assert_true(tc_tf == &tc_rx);
+	assert_int_equal(tc_tf->primary_hdr.bypass, TYPE_A);
+	assert_int_equal(tc_tf->primary_hdr.ctrl_cmd, TC_DATA);
+	assert_int_equal(tc_tf->primary_hdr.vcid, vcid);
+	assert_int_equal(tc_tf->primary_hdr.frame_seq_num, 42);
+	assert_int_equal(tc_tf->frame_data.seg_hdr.seq_flag, TC_UNSEG);
+	assert_int_equal(tc_tf->frame_data.seg_hdr.map_id, mapid);
+	assert_int_equal(tc_tf->frame_data.data_len, 100);
+	assert_memory_equal(data, tc_tf->frame_data.data, 100);
+
+	/* Truncated frames */
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, 4);
+	assert_int_equal(ret, -TC_RX_FRAME_LEN_ERR);
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, frame_len - 1);
+	assert_int_equal(ret, -TC_RX_FRAME_LEN_ERR);
+
+	/* Corrupted data field */
+	tx_buf[10] ^= 0x01;
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, frame_len);
+	assert_int_equal(ret, -TC_RX_FRAME_VAL_ERR);
+	tx_buf[10] ^= 0x01;
+
+	/* Foreign spacecraft */
+	tx_buf[1] ^= 0x01;
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, frame_len);
+	assert_int_equal(ret, -TC_RX_FRAME_VAL_ERR);
+	tx_buf[1] ^= 0x01;
+
+	/* Unknown virtual channel */
+	tx_buf[2] = (5 << 2) | (tx_buf[2] & 0x03);
+	ret = osdlp_tc_rx_decode(&tc_tf, tx_buf, frame_len);
+	assert_int_equal(ret, -TC_RX_CONFIG_ERR);
+}
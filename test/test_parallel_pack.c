@@ -0,0 +1,140 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include "test.h"
+
+#define PACK_THREADS        4
+#define PACK_FRAMES         64
+#define PACK_FRAME_LEN      128
+
+static uint8_t pack_util[2][TC_MAX_SDU_SIZE];
+static uint8_t pack_out[PACK_FRAMES][PACK_FRAME_LEN];
+static uint8_t pack_data[PACK_FRAMES][16];
+
+struct pack_worker {
+	struct tm_transfer_frame    *tm_tf;
+	int                         id;
+};
+
+/* The config is shared and never written, except the frame counters */
+static void *
+pack_tm_worker(void *arg)
+{
+	struct pack_worker *w = arg;
+	struct tm_frame_work work;
+	for (int i = w->id; i < PACK_FRAMES; i += PACK_THREADS) {
+		osdlp_tm_claim_frame(w->tm_tf, &work, 0);
+		osdlp_tm_pack_frame(w->tm_tf, &work, pack_out[i], pack_data[i],
+		                    16);
+	}
+	return NULL;
+}
+
+void
+test_parallel_pack(void **state)
+{
+	struct tc_transfer_frame tc_tf;
+	struct tc_transfer_frame snapshot;
+	struct tc_frame_work tc_work;
+	struct tm_frame_work tm_work;
+	struct tm_transfer_frame tm_tf;
+	struct tm_transfer_frame tm_rx;
+	struct pack_worker workers[PACK_THREADS];
+	pthread_t th[PACK_THREADS];
+	struct cop_config cop;
+	uint8_t frame[PACK_FRAME_LEN];
+	uint8_t seen[256] = {0};
+	uint8_t cnt = 0;
+	uint8_t rx_cnt = 0;
+	uint16_t crc;
+
+	for (int i = 0; i < PACK_FRAMES; i++) {
+		for (int j = 0; j < 16; j++) {
+			pack_data[i][j] = rand() % 256;
+		}
+	}
+
+	/* TC: the work state replaces the per-frame fields of the config */
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+	osdlp_tc_init(&tc_tf, 101, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN, 10, 1, 0,
+	              TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+	              pack_util[0], cop);
+	tc_tf.cop_cfg.fop.vs = 7;
+	tc_tf.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	osdlp_tc_pack(&tc_tf, frame, pack_data[0], 16);
+	memcpy(&snapshot, &tc_tf, sizeof(struct tc_transfer_frame));
+
+	tc_work.bypass = TYPE_A;
+	tc_work.ctrl_cmd = TC_DATA;
+	tc_work.seq_num = 7;
+	tc_work.seq_flag = TC_UNSEG;
+	osdlp_tc_pack_frame(&tc_tf, &tc_work, pack_out[0], pack_data[0], 16);
+	assert_memory_equal(pack_out[0], frame, tc_tf.primary_hdr.frame_len);
+	assert_int_equal(tc_work.crc, tc_tf.crc);
+	assert_memory_equal(&snapshot, &tc_tf,
+	                    sizeof(struct tc_transfer_frame));
+
+	tc_work.bypass = TYPE_B;
+	tc_work.seq_num = 9;
+	osdlp_tc_pack_frame(&tc_tf, &tc_work, pack_out[0], pack_data[0], 16);
+	assert_int_equal(pack_out[0][0] & 0x20, 0x20);
+	assert_int_equal(pack_out[0][4], 0);
+
+	/* TM: frames of one VC packed by several threads */
+	osdlp_tm_init(&tm_tf, 30, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0, NULL,
+	              TM_CRC_PRESENT, PACK_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, pack_util[0]);
+	osdlp_tm_init(&tm_rx, 0, &rx_cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0,
+	              NULL, TM_CRC_PRESENT, PACK_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, pack_util[1]);
+	for (int i = 0; i < PACK_THREADS; i++) {
+		workers[i].tm_tf = &tm_tf;
+		workers[i].id = i;
+		pthread_create(&th[i], NULL, pack_tm_worker, &workers[i]);
+	}
+	for (int i = 0; i < PACK_THREADS; i++) {
+		pthread_join(th[i], NULL);
+	}
+	assert_int_equal(cnt, PACK_FRAMES);
+	assert_int_equal(tm_tf.primary_hdr.vc_frame_cnt, PACK_FRAMES);
+	for (int i = 0; i < PACK_FRAMES; i++) {
+		osdlp_tm_unpack(&tm_rx, pack_out[i]);
+		crc = osdlp_calc_crc(pack_out[i], PACK_FRAME_LEN - 2);
+		assert_int_equal(crc, tm_rx.crc);
+		assert_memory_equal(tm_rx.data, pack_data[i], 16);
+		/* Only this VC counts on the master channel*/
+		assert_int_equal(pack_out[i][2], pack_out[i][3]);
+		assert_int_equal(seen[pack_out[i][3]], 0);
+		seen[pack_out[i][3]] = 1;
+	}
+
+	/* The serial path packs the same frame */
+	cnt = 5;
+	tm_tf.primary_hdr.vc_frame_cnt = 5;
+	tm_tf.primary_hdr.status.first_hdr_ptr = 0;
+	osdlp_tm_pack(&tm_tf, frame, pack_data[0], 16);
+	tm_work.mc_frame_cnt = 5;
+	tm_work.vc_frame_cnt = 5;
+	tm_work.first_hdr_ptr = 0;
+	osdlp_tm_pack_frame(&tm_tf, &tm_work, pack_out[0], pack_data[0], 16);
+	assert_memory_equal(pack_out[0], frame, PACK_FRAME_LEN);
+	assert_int_equal(tm_work.crc, tm_tf.crc);
+}
@@ -0,0 +1,74 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define RND_TEST_LEN       700
+
+/*
+ * Bit serial reference of the randomizers. taps holds the exponents of
+ * h(x) below x^8
+ */
+static void
+randomize_ref(uint8_t *buf, uint32_t length, uint8_t taps)
+{
+	uint8_t state = 0xff;
+	for (uint32_t i = 0; i < length; i++) {
+		uint8_t out = 0;
+		for (int k = 0; k < 8; k++) {
+			uint8_t fb = __builtin_parity(state & taps);
+			out = (out << 1) | (state & 0x01);
+			state = (state >> 1) | (fb << 7);
+		}
+		buf[i] ^= out;
+	}
+}
+
+void
+test_randomizer(void **state)
+{
+	uint8_t buf[RND_TEST_LEN + 1];
+	uint8_t ref[RND_TEST_LEN + 1];
+	uint8_t tm_start[] = {0xff, 0x48, 0x0e, 0xc0, 0x9a};
+	uint8_t tc_start[] = {0xff, 0x39, 0x9e, 0x5a, 0x68};
+
+	memset(buf, 0, sizeof(buf));
+	osdlp_tm_randomize(buf, 5);
+	assert_memory_equal(buf, tm_start, 5);
+	memset(buf, 0, sizeof(buf));
+	osdlp_tc_randomize(buf, 5);
+	assert_memory_equal(buf, tc_start, 5);
+
+	for (uint32_t len = 0; len <= RND_TEST_LEN; len += 37) {
+		for (uint32_t i = 0; i < len + 1; i++) {
+			buf[i] = rand() % 256;
+		}
+		/* Unaligned buffer */
+		memcpy(ref, buf, len + 1);
+		osdlp_tm_randomize(&buf[1], len);
+		randomize_ref(&ref[1], len, 0xa9);
+		assert_memory_equal(buf, ref, len + 1);
+		osdlp_tm_randomize(&buf[1], len);
+
+		osdlp_tc_randomize(&buf[1], len);
+		randomize_ref(&ref[1], len, 0xa9);
+		randomize_ref(&ref[1], len, 0x5f);
+		assert_memory_equal(buf, ref, len + 1);
+	}
+}
@@ -0,0 +1,148 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define REG_SCIDS          700
+#define REG_SLOTS          1024
+#define REG_RX_SCIDS       4
+
+static struct tc_transfer_frame   reg_tfs[REG_SCIDS];
+static struct tc_registry_slot    reg_slots[REG_SLOTS];
+static uint8_t                    reg_util[REG_RX_SCIDS][TC_MAX_SDU_SIZE];
+
+static void
+count_contexts(struct tc_transfer_frame *tc_tf, void *arg)
+{
+	(*(uint32_t *)arg)++;
+}
+
+void
+test_registry(void **state)
+{
+	struct tc_registry reg;
+	struct tc_transfer_frame *tc_tf;
+	struct tc_transfer_frame tc_tx_local;
+	struct cop_config cop;
+	uint8_t util[TC_MAX_SDU_SIZE];
+	uint8_t frame[TC_MAX_FRAME_LEN];
+	uint8_t data[100];
+	uint8_t ocf[4];
+	uint32_t cnt = 0;
+	int ret;
+
+	ret = osdlp_tc_registry_init(&reg, reg_slots, 1000);
+	assert_int_equal(ret, -1);
+	ret = osdlp_tc_registry_init(&reg, reg_slots, REG_SLOTS);
+	assert_int_equal(ret, 0);
+
+	/* Fill the registry up to its maximum load factor */
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_INIT, 1, 0, 10);
+	for (int i = 0; i < REG_SCIDS; i++) {
+		osdlp_tc_init(&reg_tfs[i], i, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+		              10, i % 3, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT,
+		              TYPE_A, TC_DATA, util, cop);
+		ret = osdlp_tc_registry_add(&reg, &reg_tfs[i]);
+		assert_int_equal(ret, 0);
+	}
+	assert_int_equal(reg.count, REG_SCIDS);
+	ret = osdlp_tc_registry_add(&reg, &reg_tfs[0]);
+	assert_int_equal(ret, -1);
+	for (int i = 0; i < REG_SCIDS; i++) {
+		tc_tf = osdlp_tc_registry_lookup(&reg, i, i % 3);
+		assert_true(tc_tf == &reg_tfs[i]);
+		tc_tf = osdlp_tc_registry_lookup(&reg, i, (i + 1) % 3);
+		assert_true(tc_tf == NULL);
+	}
+	osdlp_tc_registry_foreach(&reg, count_contexts, &cnt);
+	assert_int_equal(cnt, REG_SCIDS);
+
+	/* Remove every other context. The rest must remain reachable */
+	for (int i = 0; i < REG_SCIDS; i += 2) {
+		ret = osdlp_tc_registry_remove(&reg, i, i % 3);
+		assert_int_equal(ret, 0);
+	}
+	ret = osdlp_tc_registry_remove(&reg, 0, 0);
+	assert_int_equal(ret, -1);
+	assert_int_equal(reg.count, REG_SCIDS / 2);
+	for (int i = 0; i < REG_SCIDS; i++) {
+		tc_tf = osdlp_tc_registry_lookup(&reg, i, i % 3);
+		if (i % 2) {
+			assert_true(tc_tf == &reg_tfs[i]);
+		} else {
+			assert_true(tc_tf == NULL);
+		}
+	}
+
+	/* Route frames of several spacecraft sharing the same VCID */
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	osdlp_tc_registry_init(&reg, reg_slots, REG_SLOTS);
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+	for (int i = 0; i < REG_RX_SCIDS; i++) {
+		osdlp_tc_init(&reg_tfs[i], 200 + i, TC_MAX_SDU_SIZE,
+		              TC_MAX_FRAME_LEN, 10, 1, 0, TC_CRC_PRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, reg_util[i],
+		              cop);
+		ret = osdlp_tc_registry_add(&reg, &reg_tfs[i]);
+		assert_int_equal(ret, 0);
+	}
+	for (int i = 0; i < 100; i++) {
+		data[i] = rand() % 256;
+	}
+	osdlp_tc_init(&tc_tx_local, 202, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	              10, 1, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A,
+	              TC_DATA, util, cop);
+	tc_tx_local.cop_cfg.fop.vs = 0;
+	tc_tx_local.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	osdlp_tc_pack(&tc_tx_local, frame, data, 100);
+
+	ret = osdlp_tc_registry_receive(&reg, frame, TC_MAX_FRAME_LEN, &tc_tf);
+	assert_int_equal(ret, TC_RX_OK);
+	assert_true(tc_tf == &reg_tfs[2]);
+	for (int i = 0; i < REG_RX_SCIDS; i++) {
+		assert_int_equal(reg_tfs[i].cop_cfg.farm.vr, i == 2 ? 1 : 0);
+	}
+	assert_memory_equal(reg_util[2], data, 100);
+
+	/* Unknown spacecraft */
+	frame[1] ^= 0x40;
+	ret = osdlp_tc_registry_receive(&reg, frame, TC_MAX_FRAME_LEN, &tc_tf);
+	assert_int_equal(ret, -TC_RX_CONFIG_ERR);
+	assert_true(tc_tf == NULL);
+
+	/* CLCWs are dispatched to the FOP of the matching spacecraft */
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_INIT, 1, 0, 10);
+	osdlp_tc_init(&tc_tx_local, 300, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	              10, 0, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A,
+	              TC_DATA, util, cop);
+	ret = osdlp_tc_registry_add(&reg, &tc_tx_local);
+	assert_int_equal(ret, 0);
+	assert_int_equal(osdlp_initiate_with_clcw(&tc_tx_local), ACCEPT_DIR);
+	reg_tfs[0].mission.vcid = 0;
+	osdlp_prepare_clcw(&reg_tfs[0], ocf);
+	assert_int_equal(osdlp_tc_registry_handle_clcw(&reg, 301, ocf),
+	                 UNDEF_ERROR);
+	assert_int_equal(tc_tx_local.cop_cfg.fop.state, FOP_STATE_INIT_NO_BC);
+	assert_int_equal(osdlp_tc_registry_handle_clcw(&reg, 300, ocf),
+	                 POSITIVE_DIR);
+	assert_int_equal(tc_tx_local.cop_cfg.fop.state, FOP_STATE_ACTIVE);
+}
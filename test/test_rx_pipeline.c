@@ -0,0 +1,271 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+
+#define PIPE_VCS            3
+#define PIPE_LANES          2
+#define PIPE_SLOTS          8
+#define PIPE_FRAMES         600
+#define PIPE_SDU_LEN        16
+#define PIPE_OUT_SLOTS      1024
+#define PIPE_TM_FRAME_LEN   64
+#define PIPE_TM_FRAMES      400
+
+static uint8_t pipe_storage[PIPE_LANES][PIPE_SLOTS *
+                                        SPSC_RING_STRIDE(TC_MAX_FRAME_LEN)]
+__attribute__((aligned(4)));
+static uint8_t pipe_out_storage[PIPE_VCS][PIPE_OUT_SLOTS *
+                                          SPSC_RING_STRIDE(TC_MAX_SDU_SIZE)]
+__attribute__((aligned(4)));
+static uint8_t pipe_util[2 * PIPE_VCS][TC_MAX_SDU_SIZE];
+
+struct pipe_tm_sink {
+	uint8_t     seen[PIPE_TM_FRAMES];
+	int         n;
+};
+
+static int
+pipe_tm_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	struct pipe_tm_sink *sink = user;
+	sink->seen[sink->n++] = pkt[0];
+	return 0;
+}
+
+static int
+pipe_tm_packet_len(void *user, osdlp_sdu_len_t *length, uint8_t *pkt,
+                   osdlp_sdu_len_t mem_len)
+{
+	*length = mem_len;
+	return 0;
+}
+
+static const struct osdlp_tm_ops pipe_tm_ops = {
+	.rx_queue_enqueue   = pipe_tm_enqueue,
+	.get_packet_len     = pipe_tm_packet_len
+};
+
+struct pipe_worker {
+	struct osdlp_rx_pipeline    *p;
+	uint8_t                     lane;
+};
+
+static int pipe_stop;
+
+static void *
+pipe_work(void *arg)
+{
+	struct pipe_worker *w = arg;
+	while (1) {
+		if (osdlp_rx_pipeline_work(w->p, w->lane, 16) > 0) {
+			continue;
+		}
+		if (__atomic_load_n(&pipe_stop, __ATOMIC_ACQUIRE)
+		    && osdlp_spsc_ring_empty(&w->p->lanes[w->lane].ring)) {
+			break;
+		}
+		sched_yield();
+	}
+	return NULL;
+}
+
+/*
+ * Two TM VCs of the same master channel on different lanes. The shared
+ * master channel frame count is left alone on receive
+ */
+static void
+rx_pipeline_tm(void)
+{
+	struct osdlp_rx_pipeline p;
+	struct osdlp_rx_lane lanes[PIPE_LANES];
+	struct pipe_worker workers[PIPE_LANES];
+	pthread_t th[PIPE_LANES];
+	struct tm_transfer_frame tx[PIPE_LANES];
+	struct tm_transfer_frame rx[PIPE_LANES];
+	struct pipe_tm_sink sink[PIPE_LANES];
+	uint8_t data[PIPE_TM_FRAME_LEN];
+	uint8_t frame[PIPE_TM_FRAME_LEN];
+	uint8_t cnt = 0;
+	uint8_t rx_cnt = 0;
+	int ret;
+
+	osdlp_rx_pipeline_init(&p, OSDLP_RX_PIPELINE_TM, lanes, PIPE_LANES);
+	for (int i = 0; i < PIPE_LANES; i++) {
+		osdlp_rx_pipeline_lane_init(&p, i, pipe_storage[i], PIPE_SLOTS,
+		                            PIPE_TM_FRAME_LEN);
+		osdlp_tm_init(&tx[i], 30, &cnt, i + 1, TM_OCF_NOTPRESENT, 0, 0,
+		              0, 0, NULL, TM_CRC_PRESENT, PIPE_TM_FRAME_LEN,
+		              TM_MAX_SDU_LEN, 2, TM_TX_CAPACITY,
+		              TM_STUFFING_OFF, pipe_util[i]);
+		osdlp_tm_init(&rx[i], 30, &rx_cnt, i + 1, TM_OCF_NOTPRESENT, 0,
+		              0, 0, 0, NULL, TM_CRC_PRESENT, PIPE_TM_FRAME_LEN,
+		              TM_MAX_SDU_LEN, 2, TM_TX_CAPACITY,
+		              TM_STUFFING_OFF, pipe_util[PIPE_LANES + i]);
+		sink[i].n = 0;
+		osdlp_tm_set_ops(&rx[i], &pipe_tm_ops, &sink[i]);
+		assert_int_equal(osdlp_rx_pipeline_add_tm(&p, i, &rx[i]), 0);
+	}
+	assert_int_equal(osdlp_rx_pipeline_add_tc(&p, 0, NULL), -1);
+
+	pipe_stop = 0;
+	for (int i = 0; i < PIPE_LANES; i++) {
+		workers[i].p = &p;
+		workers[i].lane = i;
+		pthread_create(&th[i], NULL, pipe_work, &workers[i]);
+	}
+	for (int n = 0; n < PIPE_TM_FRAMES; n++) {
+		int vc = n % PIPE_LANES;
+		memset(data, n / PIPE_LANES, sizeof(data));
+		cnt = n + 1;
+		tx[vc].primary_hdr.status.first_hdr_ptr = 0;
+		osdlp_tm_pack(&tx[vc], frame, data,
+		              tx[vc].mission.max_data_len);
+		while (osdlp_rx_pipeline_dispatch(&p, frame,
+		                                  PIPE_TM_FRAME_LEN) < 0) {
+			sched_yield();
+		}
+	}
+	__atomic_store_n(&pipe_stop, 1, __ATOMIC_RELEASE);
+	for (int i = 0; i < PIPE_LANES; i++) {
+		pthread_join(th[i], NULL);
+		assert_int_equal(lanes[i].errors, 0);
+	}
+	for (int vc = 0; vc < PIPE_LANES; vc++) {
+		assert_int_equal(sink[vc].n, PIPE_TM_FRAMES / PIPE_LANES);
+		for (int n = 0; n < sink[vc].n; n++) {
+			assert_int_equal(sink[vc].seen[n], n & 0xff);
+		}
+	}
+	assert_int_equal(rx_cnt, 0);
+
+	/* A short frame is rejected instead of reusing the slot contents */
+	ret = osdlp_rx_pipeline_dispatch(&p, frame, PIPE_TM_FRAME_LEN - 8);
+	assert_int_equal(ret, 0);
+	assert_int_equal(osdlp_rx_pipeline_work(&p, 1, 1), 1);
+	assert_int_equal(lanes[1].errors, 1);
+	assert_int_equal(sink[1].n, PIPE_TM_FRAMES / PIPE_LANES);
+}
+
+void
+test_rx_pipeline(void **state)
+{
+	struct osdlp_rx_pipeline p;
+	struct osdlp_rx_lane lanes[PIPE_LANES];
+	struct pipe_worker workers[PIPE_LANES];
+	pthread_t th[PIPE_LANES];
+	struct tc_transfer_frame tx[PIPE_VCS];
+	struct tc_transfer_frame rx[PIPE_VCS];
+	struct osdlp_spsc_ring out[PIPE_VCS];
+	struct cop_config cop;
+	uint8_t frame[TC_MAX_FRAME_LEN];
+	uint8_t sdu[TC_MAX_SDU_SIZE];
+	uint32_t len;
+	int ret;
+
+	assert_int_equal(osdlp_rx_pipeline_init(&p, OSDLP_RX_PIPELINE_TC,
+	                                        lanes, 0), -1);
+	assert_int_equal(osdlp_rx_pipeline_init(&p, OSDLP_RX_PIPELINE_TC,
+	                                        lanes, PIPE_LANES), 0);
+	for (int i = 0; i < PIPE_LANES; i++) {
+		ret = osdlp_rx_pipeline_lane_init(&p, i, pipe_storage[i],
+		                                  PIPE_SLOTS, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, 0);
+	}
+
+	/* VCs 0 and 1 share the first lane, VC 2 has the second one */
+	for (int i = 0; i < PIPE_VCS; i++) {
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+		osdlp_tc_init(&tx[i], 101, TC_MAX_SDU_SIZE,
+		              TC_MAX_FRAME_LEN, 10, i, 0, TC_CRC_PRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+		              pipe_util[i], cop);
+		tx[i].frame_data.seg_hdr.seq_flag = TC_UNSEG;
+
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+		osdlp_tc_init(&rx[i], 101, TC_MAX_SDU_SIZE,
+		              TC_MAX_FRAME_LEN, 10, i, 0, TC_CRC_PRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+		              pipe_util[PIPE_VCS + i], cop);
+		osdlp_spsc_ring_init(&out[i], pipe_out_storage[i],
+		                     PIPE_OUT_SLOTS, TC_MAX_SDU_SIZE);
+		osdlp_spsc_ring_attach_tc_rx(&rx[i], &out[i]);
+		ret = osdlp_rx_pipeline_add_tc(&p, i < 2 ? 0 : 1, &rx[i]);
+		assert_int_equal(ret, 0);
+	}
+
+	pipe_stop = 0;
+	for (int i = 0; i < PIPE_LANES; i++) {
+		workers[i].p = &p;
+		workers[i].lane = i;
+		pthread_create(&th[i], NULL, pipe_work, &workers[i]);
+	}
+
+	/*
+	 * Frames of all VCs are interleaved. The FARM-1 only accepts them in
+	 * sequence, so every SDU arriving proves the order was kept
+	 */
+	for (int n = 0; n < PIPE_FRAMES; n++) {
+		int vc = n % PIPE_VCS;
+		memset(sdu, n / PIPE_VCS, PIPE_SDU_LEN);
+		tx[vc].cop_cfg.fop.vs = n / PIPE_VCS;
+		osdlp_tc_pack(&tx[vc], frame, sdu, PIPE_SDU_LEN);
+		len = tx[vc].mission.fixed_overhead_len + PIPE_SDU_LEN;
+		while (osdlp_rx_pipeline_dispatch(&p, frame, len) < 0) {
+			sched_yield();
+		}
+	}
+	__atomic_store_n(&pipe_stop, 1, __ATOMIC_RELEASE);
+	for (int i = 0; i < PIPE_LANES; i++) {
+		pthread_join(th[i], NULL);
+		assert_int_equal(lanes[i].errors, 0);
+	}
+
+	for (int vc = 0; vc < PIPE_VCS; vc++) {
+		for (int n = 0; n < PIPE_FRAMES / PIPE_VCS; n++) {
+			ret = osdlp_spsc_ring_pop(&out[vc], sdu, &len);
+			assert_int_equal(ret, 0);
+			assert_int_equal(len, PIPE_SDU_LEN);
+			assert_int_equal(sdu[0], n & 0xff);
+		}
+		assert_true(osdlp_spsc_ring_empty(&out[vc]));
+		assert_int_equal(rx[vc].cop_cfg.farm.vr,
+		                 (PIPE_FRAMES / PIPE_VCS) & 0xff);
+	}
+
+	/* Unknown VCs and full lanes are counted */
+	frame[2] = (5 << 2) | (frame[2] & 0x03);
+	assert_int_equal(osdlp_rx_pipeline_dispatch(&p, frame, len), -1);
+	assert_int_equal(p.unknown, 1);
+	tx[2].cop_cfg.fop.vs = 0;
+	osdlp_tc_pack(&tx[2], frame, sdu, PIPE_SDU_LEN);
+	for (int i = 0; i < PIPE_SLOTS; i++) {
+		assert_int_equal(osdlp_rx_pipeline_dispatch(&p, frame, len), 0);
+	}
+	assert_int_equal(osdlp_rx_pipeline_dispatch(&p, frame, len), -1);
+	assert_int_equal(lanes[1].dropped, 1);
+	assert_int_equal(osdlp_rx_pipeline_work(&p, 1, 3), 3);
+	assert_int_equal(osdlp_rx_pipeline_add_tm(&p, 0, NULL), -1);
+
+	rx_pipeline_tm();
+}
@@ -0,0 +1,159 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define RING_SLOTS      16
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct queue               sent_queues[NUMVCS];
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+static uint8_t ring_storage[(RING_SLOTS + 1) * TC_MAX_FRAME_LEN];
+
+static void
+ring_push(struct tc_sent_ring *ring, uint8_t seq_num, tc_bypass_t type)
+{
+	uint8_t fdu[8] = {0, 0, 0, 7, seq_num, 0, 0, 0};
+	struct queue_item item;
+	item.fdu = fdu;
+	item.rt_flag = RT_FLAG_OFF;
+	item.seq_num = seq_num;
+	item.type = type;
+	assert_int_equal(osdlp_sent_ring_enqueue(ring, &item), 0);
+}
+
+void
+test_sent_ring(void **state)
+{
+	struct tc_sent_ring ring;
+	struct queue_item item;
+	uint8_t buf[TC_MAX_SDU_SIZE];
+	uint8_t ocf[4];
+	notification_t notif;
+	int ret;
+
+	ret = osdlp_sent_ring_init(&ring, ring_storage, 12, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, -1);
+	ret = osdlp_sent_ring_init(&ring, ring_storage, RING_SLOTS,
+	                           TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, 0);
+	assert_true(osdlp_sent_ring_empty(&ring));
+
+	/* Sequence numbers wrapping around 255 */
+	for (int i = 0; i < RING_SLOTS; i++) {
+		ring_push(&ring, (250 + i) % 256, TYPE_A);
+	}
+	item.fdu = ring_storage;
+	item.seq_num = 10;
+	item.type = TYPE_A;
+	assert_int_equal(osdlp_sent_ring_enqueue(&ring, &item), -1);
+	ret = osdlp_sent_ring_head(&ring, &item);
+	assert_int_equal(ret, 0);
+	assert_int_equal(item.seq_num, 250);
+	assert_int_equal(item.fdu[4], 250);
+	assert_int_equal(osdlp_sent_ring_first_ad_rt(&ring, &item), -1);
+
+	/* Range release up to N(R) */
+	assert_int_equal(osdlp_sent_ring_release(&ring, 2, 256), 8);
+	assert_int_equal(ring.count, RING_SLOTS - 8);
+	osdlp_sent_ring_head(&ring, &item);
+	assert_int_equal(item.seq_num, 2);
+	assert_int_equal(osdlp_sent_ring_release(&ring, 100, 3), 3);
+	assert_int_equal(ring.head, 5);
+
+	/* Retransmissions are found in sequence order */
+	osdlp_sent_ring_mark_ad_as_rt(&ring);
+	for (int i = 5; i < 10; i++) {
+		ret = osdlp_sent_ring_first_ad_rt(&ring, &item);
+		assert_int_equal(ret, 0);
+		assert_int_equal(item.seq_num, i);
+		assert_int_equal(item.fdu[4], i);
+		osdlp_sent_ring_reset_rt(&ring, &item);
+	}
+	assert_int_equal(osdlp_sent_ring_first_ad_rt(&ring, &item), -1);
+	osdlp_sent_ring_mark_ad_as_rt(&ring);
+	assert_int_equal(osdlp_sent_ring_release(&ring, 10, 256), 5);
+	assert_true(osdlp_sent_ring_empty(&ring));
+	assert_int_equal(osdlp_sent_ring_first_ad_rt(&ring, &item), -1);
+
+	/* Type-B frames have their own slot */
+	assert_int_equal(osdlp_sent_ring_mark_bc_as_rt(&ring), -1);
+	ring_push(&ring, 10, TYPE_B);
+	assert_int_equal(osdlp_sent_ring_mark_bc_as_rt(&ring), 0);
+	osdlp_sent_ring_head(&ring, &item);
+	assert_int_equal(item.type, TYPE_B);
+	assert_int_equal(item.rt_flag, RT_FLAG_ON);
+	assert_int_equal(osdlp_sent_ring_dequeue(&ring), 0);
+	assert_true(osdlp_sent_ring_empty(&ring));
+
+	/* COP-1 with the sent ring attached */
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_INIT, 1, 0, 10, FARM_STATE_OPEN, 10);
+	osdlp_sent_ring_attach(&tc_tx, &ring);
+	for (int i = 0; i < 100; i++) {
+		buf[i] = rand() % 256;
+	}
+	notif = osdlp_initiate_no_clcw(&tc_tx);
+	assert_int_equal(notif, POSITIVE_DIR);
+	for (int i = 0; i < 3; i++) {
+		ret = osdlp_tc_transmit(&tc_tx, buf, 100);
+		assert_int_equal(ret, TC_TX_OK);
+	}
+	assert_int_equal(ring.count, 3);
+	assert_int_equal(sent_queues[1].inqueue, 0);
+
+	for (int i = 0; i < 2; i++) {
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	notif = osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(notif, ACCEPT_TX);
+	assert_int_equal(ring.count, 1);
+	assert_int_equal(ring.head, 2);
+	assert_int_equal(tc_tx.cop_cfg.fop.nnr, 2);
+
+	/* The unacknowledged frame is retransmitted on timer expiration */
+	osdlp_handle_timer_expired(&tc_tx);
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	assert_int_equal(test_util[4], 2);
+	assert_int_equal(uplink_channel.inqueue, 0);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	assert_true(osdlp_sent_ring_empty(&ring));
+	osdlp_sent_ring_attach(&tc_tx, NULL);
+}
@@ -0,0 +1,187 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+
+#define SPSC_SLOTS      4
+#define SPSC_THREAD_N   100000
+
+extern struct queue               tx_queues[NUMVCS];
+
+static uint8_t spsc_storage[SPSC_SLOTS * SPSC_RING_STRIDE(TC_MAX_SDU_SIZE)]
+__attribute__((aligned(4)));
+static uint8_t spsc_util[2][TC_MAX_SDU_SIZE];
+
+static void *
+spsc_producer(void *arg)
+{
+	struct osdlp_spsc_ring *ring = arg;
+	for (uint32_t i = 0; i < SPSC_THREAD_N; i++) {
+		while (osdlp_spsc_ring_push(ring, (uint8_t *)&i, 4) < 0) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void
+test_spsc_ring_threads(void)
+{
+	struct osdlp_spsc_ring ring;
+	pthread_t producer;
+	uint32_t len;
+	uint32_t seq;
+
+	osdlp_spsc_ring_init(&ring, spsc_storage, SPSC_SLOTS, sizeof(seq));
+	assert_int_equal(pthread_create(&producer, NULL, spsc_producer, &ring),
+	                 0);
+	for (uint32_t i = 0; i < SPSC_THREAD_N; i++) {
+		while (osdlp_spsc_ring_pop(&ring, (uint8_t *)&seq, &len) < 0) {
+			sched_yield();
+		}
+		assert_int_equal(len, sizeof(seq));
+		assert_int_equal(seq, i);
+	}
+	pthread_join(producer, NULL);
+	assert_true(osdlp_spsc_ring_empty(&ring));
+}
+
+void
+test_spsc_ring(void **state)
+{
+	struct osdlp_spsc_ring ring;
+	struct tc_transfer_frame tc_tf_tx;
+	struct tc_transfer_frame tc_tf_rx;
+	struct tc_transfer_frame *tc_tf;
+	struct tm_transfer_frame tm_tf_tx;
+	struct tm_transfer_frame tm_tf_rx;
+	struct tc_registry_slot slots[2];
+	struct tc_registry reg;
+	struct cop_config cop;
+	uint8_t frame[TC_MAX_SDU_SIZE];
+	uint8_t data[100];
+	uint8_t *s;
+	uint8_t cnt = 0;
+	uint32_t len;
+	int ret;
+
+	ret = osdlp_spsc_ring_init(&ring, spsc_storage, 3, 8);
+	assert_int_equal(ret, -1);
+	ret = osdlp_spsc_ring_init(&ring, spsc_storage, SPSC_SLOTS, 8);
+	assert_int_equal(ret, 0);
+	assert_int_equal((uintptr_t)&ring.head % OSDLP_CACHE_LINE, 0);
+	assert_true((uint8_t *)&ring.head - (uint8_t *)&ring.tail
+	            >= OSDLP_CACHE_LINE);
+
+	/* FIFO order, in place access and capacity */
+	assert_true(osdlp_spsc_ring_empty(&ring));
+	assert_true(osdlp_spsc_ring_peek(&ring, &len) == NULL);
+	assert_int_equal(osdlp_spsc_ring_push(&ring, data, 9), -1);
+	for (int i = 0; i < SPSC_SLOTS; i++) {
+		s = osdlp_spsc_ring_reserve(&ring);
+		assert_true(s != NULL);
+		s[0] = i;
+		osdlp_spsc_ring_commit(&ring, i + 1);
+	}
+	assert_true(osdlp_spsc_ring_full(&ring));
+	assert_true(osdlp_spsc_ring_reserve(&ring) == NULL);
+	assert_int_equal(osdlp_spsc_ring_push(&ring, data, 1), -1);
+	for (int i = 0; i < SPSC_SLOTS; i++) {
+		s = osdlp_spsc_ring_peek(&ring, &len);
+		assert_true(s != NULL);
+		assert_int_equal(s[0], i);
+		assert_int_equal(len, i + 1);
+		osdlp_spsc_ring_release(&ring);
+		assert_false(osdlp_spsc_ring_full(&ring));
+	}
+	assert_true(osdlp_spsc_ring_empty(&ring));
+	assert_int_equal(osdlp_spsc_ring_pop(&ring, frame, &len), -1);
+
+	test_spsc_ring_threads();
+
+	/* Received TC SDUs are passed to the ring */
+	for (int i = 0; i < 100; i++) {
+		data[i] = rand() % 256;
+	}
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 10);
+	osdlp_tc_init(&tc_tf_rx, 101, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	              10, 1, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A,
+	              TC_DATA, spsc_util[0], cop);
+	osdlp_spsc_ring_init(&ring, spsc_storage, SPSC_SLOTS, 8);
+	assert_int_equal(osdlp_spsc_ring_attach_tc_rx(&tc_tf_rx, &ring), -1);
+	osdlp_spsc_ring_init(&ring, spsc_storage, SPSC_SLOTS, TC_MAX_SDU_SIZE);
+	assert_int_equal(osdlp_spsc_ring_attach_tc_rx(&tc_tf_rx, &ring), 0);
+	osdlp_tc_registry_init(&reg, slots, 2);
+	osdlp_tc_registry_add(&reg, &tc_tf_rx);
+
+	memset(&cop, 0, sizeof(struct cop_config));
+	osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+	osdlp_tc_init(&tc_tf_tx, 101, TC_MAX_SDU_SIZE, TC_MAX_FRAME_LEN,
+	              10, 1, 0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A,
+	              TC_DATA, spsc_util[1], cop);
+	tc_tf_tx.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	for (int i = 0; i < SPSC_SLOTS + 1; i++) {
+		tc_tf_tx.cop_cfg.fop.vs = i;
+		osdlp_tc_pack(&tc_tf_tx, frame, data, 100 - i);
+		ret = osdlp_tc_registry_receive(&reg, frame, TC_MAX_FRAME_LEN,
+		                                &tc_tf);
+		assert_int_equal(ret,
+		                 i < SPSC_SLOTS ? TC_RX_OK : -TC_RX_COP_ERR);
+	}
+	for (int i = 0; i < SPSC_SLOTS; i++) {
+		assert_int_equal(osdlp_spsc_ring_pop(&ring, frame, &len), 0);
+		assert_int_equal(len, 100 - i);
+		assert_memory_equal(frame, data, len);
+	}
+
+	/* TM frames are packed into the ring */
+	osdlp_tm_init(&tm_tf_tx, 30, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0,
+	              NULL, TM_CRC_PRESENT, TM_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, spsc_util[0]);
+	osdlp_tm_init(&tm_tf_rx, 0, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0,
+	              NULL, TM_CRC_PRESENT, TM_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, spsc_util[1]);
+	osdlp_spsc_ring_init(&ring, spsc_storage, SPSC_SLOTS, TM_FRAME_LEN);
+	assert_int_equal(osdlp_spsc_ring_attach_tm_tx(&tm_tf_tx, &ring), 0);
+	ret = tx_queues[1].inqueue;
+	assert_int_equal(osdlp_tm_transmit(&tm_tf_tx, data, 100), 0);
+	assert_int_equal(osdlp_tm_transmit(&tm_tf_tx, data, 50), 0);
+	assert_int_equal(tx_queues[1].inqueue, ret);
+	for (int i = 0; i < 2; i++) {
+		s = osdlp_spsc_ring_peek(&ring, &len);
+		assert_true(s != NULL);
+		assert_int_equal(len, TM_FRAME_LEN);
+		osdlp_tm_unpack(&tm_tf_rx, s);
+		assert_int_equal(tm_tf_rx.primary_hdr.vcid, 1);
+		assert_int_equal(tm_tf_rx.primary_hdr.vc_frame_cnt, i + 1);
+		assert_memory_equal(tm_tf_rx.data, data, i ? 50 : 100);
+		osdlp_spsc_ring_release(&ring);
+	}
+	assert_true(osdlp_spsc_ring_empty(&ring));
+
+	/* A full ring makes the transmission wait */
+	for (int i = 0; i < SPSC_SLOTS; i++) {
+		assert_int_equal(osdlp_tm_transmit_idle_fdu(&tm_tf_tx, 1), 0);
+	}
+	assert_true(osdlp_tm_transmit(&tm_tf_tx, data, 100) < 0);
+	assert_int_equal(tm_tf_tx.mission.util.loop_state, TM_LOOP_OPEN);
+}
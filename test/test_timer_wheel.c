@@ -0,0 +1,102 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+void
+test_timer_wheel(void **state)
+{
+	struct tc_timer_wheel wheel;
+	struct tc_timer *slots[8];
+	struct tc_timer timer;
+	uint8_t data[20];
+	uint8_t ocf[4];
+	notification_t notif;
+	int ret;
+
+	ret = osdlp_timer_wheel_init(&wheel, slots, 6);
+	assert_int_equal(ret, -1);
+	ret = osdlp_timer_wheel_init(&wheel, slots, 8);
+	assert_int_equal(ret, 0);
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	/* T1 of 3 ticks */
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_ACTIVE, 3, 0, 10, FARM_STATE_OPEN, 10);
+	osdlp_timer_wheel_attach(&tc_tx, &wheel, &timer);
+	for (int i = 0; i < 20; i++) {
+		data[i] = rand() % 256;
+	}
+
+	/* Each AD frame restarts T1 */
+	ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	assert_true(osdlp_timer_wheel_running(&timer));
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 2), 0);
+	ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 2), 0);
+	assert_int_equal(uplink_channel.inqueue, 2);
+
+	/*
+	 * Expiry purges the uplink, retransmits both frames and restarts T1
+	 */
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 1), 1);
+	assert_int_equal(tc_tx.cop_cfg.fop.tx_cnt, 2);
+	assert_int_equal(uplink_channel.inqueue, 2);
+	assert_true(osdlp_timer_wheel_running(&timer));
+
+	/* Acknowledging all frames cancels T1 */
+	for (int i = 0; i < 2; i++) {
+		ret = dequeue(&uplink_channel, test_util);
+		assert_int_equal(ret, 0);
+		ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+		assert_int_equal(ret, TC_RX_OK);
+	}
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	notif = osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(notif, ACCEPT_TX);
+	assert_false(osdlp_timer_wheel_running(&timer));
+	assert_int_equal(wheel.running, 0);
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 100), 0);
+
+	/* Timeouts longer than the wheel take several revolutions */
+	osdlp_timer_wheel_start(&wheel, &timer, 20);
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 8), 0);
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 11), 0);
+	osdlp_timer_wheel_cancel(&wheel, &timer);
+	assert_int_equal(osdlp_timer_wheel_advance(&wheel, 1), 0);
+
+	osdlp_timer_wheel_attach(&tc_tx, NULL, NULL);
+	assert_true(tc_tx.timer_wheel == NULL);
+}
@@ -82,7 +82,8 @@ osdlp_tm_get_rx_config(struct tm_transfer_frame **tm, uint8_t vcid)
  */
 
 int
-osdlp_tm_get_packet_len(uint16_t *length, uint8_t *pkt, uint16_t mem_len)
+osdlp_tm_get_packet_len(osdlp_sdu_len_t *length, uint8_t *pkt,
+                        osdlp_sdu_len_t mem_len)
 {
 	if (mem_len >= 5) {
 		if (((pkt[3] << 8) | pkt[4]) <= TM_MAX_SDU_LEN) {
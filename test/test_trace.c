@@ -0,0 +1,99 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+#define TRACE_EVENTS    8
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+void
+test_trace(void **state)
+{
+	struct osdlp_trace_event events[TRACE_EVENTS];
+	struct osdlp_trace_event out[TRACE_EVENTS];
+	struct osdlp_trace_ring ring;
+	uint32_t n;
+	int ret;
+
+	ret = osdlp_trace_init(&ring, events, 6);
+	assert_int_equal(ret, -1);
+	ret = osdlp_trace_init(&ring, events, TRACE_EVENTS);
+	assert_int_equal(ret, 0);
+	assert_int_equal(osdlp_trace_snapshot(&ring, out, TRACE_EVENTS), 0);
+
+	/* The ring keeps the newest events */
+	for (int i = 0; i < TRACE_EVENTS + 3; i++) {
+		events[ring.head & ring.mask].vs = i;
+		ring.head++;
+	}
+	n = osdlp_trace_snapshot(&ring, out, TRACE_EVENTS);
+	assert_int_equal(n, TRACE_EVENTS);
+	for (uint32_t i = 0; i < n; i++) {
+		assert_int_equal(out[i].vs, i + 3);
+	}
+	n = osdlp_trace_snapshot(&ring, out, 2);
+	assert_int_equal(n, 2);
+	assert_int_equal(out[0].vs, TRACE_EVENTS + 1);
+
+#ifdef OSDLP_TRACE
+	uint8_t data[20] = {0};
+	uint8_t ocf[4];
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, TC_MAX_FRAME_LEN, 10, 1, 1, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 10,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	osdlp_trace_init(&ring, events, TRACE_EVENTS);
+	osdlp_trace_attach(&ring);
+	ret = osdlp_tc_transmit(&tc_tx, data, 20);
+	assert_int_equal(ret, TC_TX_OK);
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	osdlp_handle_clcw(&tc_tx, ocf);
+	osdlp_trace_attach(NULL);
+
+	n = osdlp_trace_snapshot(&ring, out, TRACE_EVENTS);
+	assert_int_equal(n, 3);
+	assert_int_equal(out[0].id, OSDLP_TRACE_TC_TX);
+	assert_int_equal(out[0].arg, ACCEPT_TX);
+	assert_int_equal(out[0].vs, 1);
+	assert_int_equal(out[1].id, OSDLP_TRACE_FARM);
+	assert_int_equal(out[1].arg, COP_ENQ);
+	assert_int_equal(out[1].vs, 1);
+	assert_int_equal(out[2].id, OSDLP_TRACE_FOP);
+	assert_int_equal(out[2].vcid, 1);
+	assert_int_equal(out[2].before, FOP_STATE_ACTIVE);
+	assert_int_equal(out[2].nr, 1);
+#endif
+}
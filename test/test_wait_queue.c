@@ -0,0 +1,90 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test.h"
+
+extern struct queue
+	uplink_channel;          /* Queue simulating uplink channel */
+extern struct queue               wait_queues[NUMVCS];
+extern struct queue               rx_queues[NUMVCS];
+extern struct tc_transfer_frame   tc_tx;
+extern struct tc_transfer_frame   tc_rx;
+extern uint8_t                    test_util[TC_MAX_FRAME_LEN];
+extern struct cop_config          cop_tx;
+extern struct cop_config          cop_rx;
+extern struct fop_config          fop;
+extern struct farm_config         farm;
+
+void
+test_wait_queue(void **state)
+{
+	uint8_t data[100];
+	uint8_t rx_sdu[TC_MAX_SDU_SIZE];
+	uint8_t ocf[4];
+	notification_t notif;
+	int ret;
+
+	setup_queues(TC_MAX_FRAME_LEN, 10, sizeof(struct clcw_frame), 10,
+	             sizeof(struct local_queue_item), 10,
+	             sizeof(struct tc_wait_desc), TC_MAX_SDU_SIZE, 10);
+	/* A window of a single frame and 56 octets of data per frame */
+	setup_tc_configs(&tc_tx, &tc_rx, &cop_tx, &cop_rx, &fop, &farm,
+	                 101, 64, 10, 1, 5, TC_CRC_PRESENT,
+	                 TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, 1,
+	                 FOP_STATE_ACTIVE, 1, 0, 10, FARM_STATE_OPEN, 10);
+	for (int i = 0; i < 100; i++) {
+		data[i] = rand() % 256;
+	}
+
+	/* The second segment does not fit in the window and has to wait */
+	ret = osdlp_tc_transmit(&tc_tx, data, 100);
+	assert_int_equal(ret, -TC_TX_DELAY);
+	assert_int_equal(uplink_channel.inqueue, 1);
+	assert_int_equal(wait_queues[1].inqueue, 1);
+	assert_true(wait_queues[1].item_size <= 16);
+
+	/*
+	 * The segment header of the context changes before the waiting frame
+	 * is sent, so the queued one must be used
+	 */
+	tc_tx.frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	tc_tx.frame_data.seg_hdr.map_id = 0;
+
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	assert_int_equal(test_util[5] >> 6, TC_FIRST_SEG);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	osdlp_prepare_clcw(&tc_rx, ocf);
+	notif = osdlp_handle_clcw(&tc_tx, ocf);
+	assert_int_equal(notif, ACCEPT_TX);
+	assert_int_equal(wait_queues[1].inqueue, 0);
+
+	ret = dequeue(&uplink_channel, test_util);
+	assert_int_equal(ret, 0);
+	assert_int_equal(test_util[4], 1);
+	assert_int_equal(test_util[5] >> 6, TC_LAST_SEG);
+	assert_int_equal(test_util[5] & 0x3f, 5);
+	assert_int_equal(tc_tx.frame_data.seg_hdr.seq_flag, TC_UNSEG);
+	ret = osdlp_tc_receive(test_util, TC_MAX_FRAME_LEN);
+	assert_int_equal(ret, TC_RX_OK);
+	ret = dequeue(&rx_queues[1], rx_sdu);
+	assert_int_equal(ret, 0);
+	assert_memory_equal(rx_sdu, data, 100);
+}
@@ -0,0 +1,174 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+
+#define WS_THREADS          3
+#define WS_SLOTS            16
+#define WS_FRAMES           500
+#define WS_FRAME_LEN        64
+
+static struct osdlp_ws_deque ws_deques[WS_THREADS + 1];
+static void *ws_items[WS_THREADS + 1][WS_SLOTS];
+static uint8_t ws_storage[WS_SLOTS * WS_FRAME_LEN];
+static uint8_t ws_util[2][TC_MAX_SDU_SIZE];
+static uint8_t ws_seen[WS_FRAMES];
+static int ws_nseen;
+static int ws_stop;
+
+struct ws_worker {
+	uint32_t    self;
+	uint32_t    ran;
+};
+
+static int
+ws_rx_enqueue(void *user, uint8_t *pkt, uint8_t vcid)
+{
+	ws_seen[ws_nseen++] = pkt[0];
+	return 0;
+}
+
+static int
+ws_get_packet_len(void *user, osdlp_sdu_len_t *length, uint8_t *pkt,
+                  osdlp_sdu_len_t mem_len)
+{
+	*length = mem_len;
+	return 0;
+}
+
+static const struct osdlp_tm_ops ws_ops = {
+	.rx_queue_enqueue   = ws_rx_enqueue,
+	.get_packet_len     = ws_get_packet_len
+};
+
+static void *
+ws_work(void *arg)
+{
+	struct ws_worker *w = arg;
+	struct osdlp_rx_job *job;
+	while (!__atomic_load_n(&ws_stop, __ATOMIC_ACQUIRE)) {
+		job = osdlp_ws_deque_take(ws_deques, WS_THREADS + 1, w->self);
+		if (job) {
+			osdlp_rx_job_run(job);
+			w->ran++;
+		} else {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+void
+test_work_steal(void **state)
+{
+	struct ws_worker workers[WS_THREADS];
+	pthread_t th[WS_THREADS];
+	struct osdlp_rx_job jobs[WS_SLOTS];
+	struct osdlp_rx_job *job;
+	struct osdlp_reorder r;
+	struct tm_transfer_frame tm_tx;
+	struct tm_transfer_frame tm_rx;
+	uint8_t data[WS_FRAME_LEN];
+	uint8_t frame[WS_FRAME_LEN];
+	uint8_t cnt = 0;
+	uint8_t rx_cnt = 0;
+	int v[3] = {1, 2, 3};
+	uint32_t ran = 0;
+	uint32_t n = 0;
+	int ret;
+
+	/* Owner pops the newest item, thieves take the oldest one */
+	ret = osdlp_ws_deque_init(&ws_deques[0], ws_items[0], 3);
+	assert_int_equal(ret, -1);
+	osdlp_ws_deque_init(&ws_deques[0], ws_items[0], 2);
+	assert_true(osdlp_ws_deque_pop(&ws_deques[0]) == NULL);
+	assert_true(osdlp_ws_deque_steal(&ws_deques[0]) == NULL);
+	assert_int_equal(osdlp_ws_deque_push(&ws_deques[0], &v[0]), 0);
+	assert_int_equal(osdlp_ws_deque_push(&ws_deques[0], &v[1]), 0);
+	assert_int_equal(osdlp_ws_deque_push(&ws_deques[0], &v[2]), -1);
+	assert_true(osdlp_ws_deque_pop(&ws_deques[0]) == &v[1]);
+	assert_true(osdlp_ws_deque_push(&ws_deques[0], &v[2]) == 0);
+	assert_true(osdlp_ws_deque_steal(&ws_deques[0]) == &v[0]);
+	assert_true(osdlp_ws_deque_pop(&ws_deques[0]) == &v[2]);
+	assert_true(osdlp_ws_deque_pop(&ws_deques[0]) == NULL);
+
+	osdlp_tm_init(&tm_tx, 30, &cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0, NULL,
+	              TM_CRC_PRESENT, WS_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, ws_util[0]);
+	osdlp_tm_init(&tm_rx, 30, &rx_cnt, 1, TM_OCF_NOTPRESENT, 0, 0, 0, 0,
+	              NULL, TM_CRC_PRESENT, WS_FRAME_LEN, TM_MAX_SDU_LEN, 2,
+	              TM_TX_CAPACITY, TM_STUFFING_OFF, ws_util[1]);
+	osdlp_tm_set_ops(&tm_rx, &ws_ops, NULL);
+	assert_int_equal(osdlp_reorder_init(&r, &tm_rx, jobs, ws_storage,
+	                                    WS_SLOTS, true), 0);
+
+	/*
+	 * The test thread receives frames into the deque it owns and drains
+	 * the reorder buffer, while the pool verifies the frames
+	 */
+	for (uint32_t i = 0; i <= WS_THREADS; i++) {
+		osdlp_ws_deque_init(&ws_deques[i], ws_items[i], WS_SLOTS);
+	}
+	ws_nseen = 0;
+	ws_stop = 0;
+	for (int i = 0; i < WS_THREADS; i++) {
+		workers[i].self = i + 1;
+		workers[i].ran = 0;
+		pthread_create(&th[i], NULL, ws_work, &workers[i]);
+	}
+	for (int i = 0; i < WS_FRAMES; i++) {
+		memset(data, i, sizeof(data));
+		tm_tx.primary_hdr.status.first_hdr_ptr = 0;
+		osdlp_tm_pack(&tm_tx, frame, data, tm_tx.mission.max_data_len);
+		if (i == 100) {
+			frame[20] ^= 0x01;
+		}
+		osdlp_tm_randomize(frame, WS_FRAME_LEN);
+		while (!(job = osdlp_reorder_reserve(&r))) {
+			if (!osdlp_reorder_drain(&r, WS_SLOTS)) {
+				sched_yield();
+			}
+		}
+		memcpy(job->frame, frame, WS_FRAME_LEN);
+		assert_int_equal(osdlp_ws_deque_push(&ws_deques[0], job), 0);
+	}
+	while (ws_nseen + r.errors < WS_FRAMES) {
+		if (!osdlp_reorder_drain(&r, WS_SLOTS)) {
+			sched_yield();
+		}
+	}
+	__atomic_store_n(&ws_stop, 1, __ATOMIC_RELEASE);
+	for (int i = 0; i < WS_THREADS; i++) {
+		pthread_join(th[i], NULL);
+		ran += workers[i].ran;
+	}
+
+	/* Every frame was verified once and delivered in arrival order */
+	while ((job = osdlp_ws_deque_pop(&ws_deques[0]))) {
+		n++;
+	}
+	assert_int_equal(ran + n, WS_FRAMES);
+	assert_int_equal(r.errors, 1);
+	assert_int_equal(ws_nseen, WS_FRAMES - 1);
+	for (int i = 0; i < ws_nseen; i++) {
+		assert_int_equal(ws_seen[i], (i < 100 ? i : i + 1) & 0xff);
+	}
+}
@@ -0,0 +1,696 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Discrete event simulator of a single TC virtual channel. The sender runs
+ * the FOP-1 and the receiver the FARM-1 of the library, connected by an
+ * uplink with finite bandwidth, delay and bit error rate and a downlink
+ * that carries a CLCW periodically. Time is virtual, so runs are
+ * deterministic for a given seed and much faster than real time.
+ *
+ * The sender always has data to send. Each SDU fills one frame and carries
+ * its submission time, so that the receiver can measure the latency.
+ * An alert purges the frames that were not acknowledged; they are counted as
+ * dropped and the sender resumes after resynchronizing with Set V(R).
+ * One line with the results is printed per run; parameter sweeps are done
+ * by running the simulator in a loop, e.g.
+ *
+ *   for w in 4 8 16 32; do osdlp_linksim -q -w $w -b 1e-6; done
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "osdlp.h"
+
+#define SIM_VCID            1
+#define SIM_SCID            101
+#define SIM_RING_SLOTS      256
+#define SIM_SDU_HDR         12      /* SDU id and submission time*/
+
+#define NS_PER_SEC          1000000000ULL
+#define NS_PER_MS           1000000ULL
+
+typedef enum {
+	EV_TX_DONE,         /* The uplink finished sending a frame*/
+	EV_FRAME_RX,        /* A frame reaches the receiver*/
+	EV_CLCW_EMIT,       /* The receiver reports a CLCW*/
+	EV_CLCW_RX,         /* A CLCW reaches the sender*/
+	EV_T1               /* T1 expires*/
+} sim_event_type_t;
+
+struct sim_event {
+	uint64_t    t;
+	uint64_t    seq;    /* Keeps events of the same time in FIFO order*/
+	uint32_t    arg;    /* Frame slot or timer generation*/
+	uint8_t     type;
+	uint8_t     ocf[4];
+};
+
+struct sim_params {
+	uint32_t    window;
+	uint32_t    t1_ms;
+	uint32_t    tx_lim;
+	uint32_t    frame_len;
+	double      ber;
+	double      clcw_loss;
+	double      delay_ms;       /* One way*/
+	double      rate_bps;
+	double      clcw_ms;        /* CLCW period*/
+	uint64_t    sdus;
+	uint64_t    seed;
+	int         quiet;
+};
+
+struct sim_stats {
+	uint64_t    submitted;
+	uint64_t    delivered;
+	uint64_t    frames_tx;      /* Type-AD frames put on the uplink*/
+	uint64_t    retx;           /* Of them, retransmissions*/
+	uint64_t    frames_lost;    /* Corrupted on the uplink*/
+	uint64_t    t1_expiries;
+	uint64_t    alerts;
+	uint64_t    *latency;       /* ns, per delivered SDU*/
+};
+
+static struct sim_params prm = {
+	.window = 10,
+	.t1_ms = 1000,
+	.tx_lim = 10,
+	.frame_len = 256,
+	.ber = 0,
+	.clcw_loss = 0,
+	.delay_ms = 250,
+	.rate_bps = 64000,
+	.clcw_ms = 100,
+	.sdus = 10000,
+	.seed = 1,
+	.quiet = 0
+};
+
+static struct sim_stats stats;
+
+static uint64_t now;
+static uint64_t delay;          /* One way delay in ns*/
+static uint64_t rng;
+static double frame_loss;       /* Probability that a frame is corrupted*/
+
+static struct sim_event *heap;
+static size_t heap_len;
+static size_t heap_cap;
+static uint64_t heap_seq;
+
+/* Frames on their way, addressed by slot index */
+static uint8_t *frames;
+static uint32_t *frame_free;
+static uint32_t frame_nfree;
+static uint32_t frame_cap;
+
+/* Frames waiting for the uplink, a power of 2 sized FIFO of slots */
+static uint32_t *fifo;
+static uint32_t fifo_head;
+static uint32_t fifo_tail;
+static uint32_t fifo_cap;
+static int link_busy;
+
+/*
+ * The uplink accepts every frame at once. The FOP-1 is told so after the
+ * enqueue callback returns, as it may send the next frame from within the
+ * accept.
+ */
+#define ACCEPT_AD           0x01
+#define ACCEPT_BC           0x02
+#define ACCEPT_BD           0x04
+static uint8_t accept_pending;
+static uint8_t next_ns;         /* N(S) of the next new Type-AD frame*/
+
+static struct tc_transfer_frame tx;
+static struct tc_transfer_frame rx;
+static uint8_t *tx_util;
+static uint8_t *rx_util;
+static uint8_t *sdu;
+static struct tc_sent_ring ring;
+static uint8_t *ring_storage;
+static struct tc_wait_desc wait_item;
+static int wait_full;
+static uint32_t t1_gen;
+
+static void *
+xrealloc(void *p, size_t len)
+{
+	p = realloc(p, len);
+	if (!p) {
+		fprintf(stderr, "Out of memory\n");
+		exit(1);
+	}
+	return p;
+}
+
+/* xorshift64*, deterministic and cheap */
+static double
+rand_uniform(void)
+{
+	rng ^= rng >> 12;
+	rng ^= rng << 25;
+	rng ^= rng >> 27;
+	return ((rng * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+static inline int
+event_before(const struct sim_event *a, const struct sim_event *b)
+{
+	return a->t < b->t || (a->t == b->t && a->seq < b->seq);
+}
+
+static void
+event_push(uint64_t t, uint8_t type, uint32_t arg, const uint8_t *ocf)
+{
+	struct sim_event e = {t, heap_seq++, arg, type, {0}};
+	size_t i;
+	if (ocf) {
+		memcpy(e.ocf, ocf, 4);
+	}
+	if (heap_len == heap_cap) {
+		heap_cap = heap_cap ? 2 * heap_cap : 1024;
+		heap = xrealloc(heap, heap_cap * sizeof(*heap));
+	}
+	i = heap_len++;
+	while (i > 0) {
+		size_t p = (i - 1) / 2;
+		if (event_before(&heap[p], &e)) {
+			break;
+		}
+		heap[i] = heap[p];
+		i = p;
+	}
+	heap[i] = e;
+}
+
+static struct sim_event
+event_pop(void)
+{
+	struct sim_event top = heap[0];
+	struct sim_event last = heap[--heap_len];
+	size_t i = 0;
+	size_t c;
+	while ((c = 2 * i + 1) < heap_len) {
+		if (c + 1 < heap_len && event_before(&heap[c + 1], &heap[c])) {
+			c++;
+		}
+		if (event_before(&last, &heap[c])) {
+			break;
+		}
+		heap[i] = heap[c];
+		i = c;
+	}
+	heap[i] = last;
+	return top;
+}
+
+static uint32_t
+frame_get(void)
+{
+	if (frame_nfree == 0) {
+		uint32_t old = frame_cap;
+		frame_cap = frame_cap ? 2 * frame_cap : 1024;
+		frames = xrealloc(frames, (size_t)frame_cap * prm.frame_len);
+		frame_free = xrealloc(frame_free, frame_cap * sizeof(uint32_t));
+		for (uint32_t i = frame_cap; i > old; i--) {
+			frame_free[frame_nfree++] = i - 1;
+		}
+	}
+	return frame_free[--frame_nfree];
+}
+
+static inline uint8_t *
+frame_at(uint32_t slot)
+{
+	return frames + (size_t)slot * prm.frame_len;
+}
+
+static inline void
+frame_release(uint32_t slot)
+{
+	frame_free[frame_nfree++] = slot;
+}
+
+static void
+fifo_push(uint32_t slot)
+{
+	if (fifo_tail - fifo_head == fifo_cap) {
+		uint32_t *n;
+		uint32_t cap = fifo_cap ? 2 * fifo_cap : 1024;
+		n = xrealloc(NULL, cap * sizeof(uint32_t));
+		for (uint32_t i = 0; i < fifo_cap; i++) {
+			n[i] = fifo[(fifo_head + i) & (fifo_cap - 1)];
+		}
+		free(fifo);
+		fifo = n;
+		fifo_tail -= fifo_head;
+		fifo_head = 0;
+		fifo_cap = cap;
+	}
+	fifo[fifo_tail++ & (fifo_cap - 1)] = slot;
+}
+
+static void
+link_start(void)
+{
+	uint32_t slot;
+	double secs;
+	if (link_busy || fifo_head == fifo_tail) {
+		return;
+	}
+	slot = fifo[fifo_head++ & (fifo_cap - 1)];
+	secs = prm.frame_len * 8.0 / prm.rate_bps;
+	link_busy = 1;
+	event_push(now + (uint64_t)(secs * NS_PER_SEC), EV_TX_DONE, slot, NULL);
+}
+
+/* Library hooks */
+
+int
+osdlp_tc_tx_queue_enqueue(uint8_t *buffer, uint16_t vcid)
+{
+	uint32_t slot = frame_get();
+	uint16_t len = (((buffer[2] & 0x03) << 8) | buffer[3]) + 1;
+	memcpy(frame_at(slot), buffer, len);
+	fifo_push(slot);
+	if ((buffer[0] >> 5) & 0x01) {
+		accept_pending |= ((buffer[0] >> 4) & 0x01) ? ACCEPT_BC
+		                  : ACCEPT_BD;
+	} else {
+		accept_pending |= ACCEPT_AD;
+		stats.frames_tx++;
+		if (buffer[4] == next_ns) {
+			next_ns++;
+		} else {
+			stats.retx++;
+		}
+	}
+	link_start();
+	return 0;
+}
+
+bool
+osdlp_tc_tx_queue_full(uint16_t vcid)
+{
+	return false;
+}
+
+int
+osdlp_cancel_lower_ops()
+{
+	while (fifo_head != fifo_tail) {
+		frame_release(fifo[fifo_head++ & (fifo_cap - 1)]);
+	}
+	return 0;
+}
+
+int
+osdlp_tc_wait_queue_enqueue(void *item, uint16_t vcid)
+{
+	if (wait_full) {
+		return -1;
+	}
+	memcpy(&wait_item, item, sizeof(wait_item));
+	wait_full = 1;
+	return 0;
+}
+
+int
+osdlp_tc_wait_queue_dequeue(void *item, uint16_t vcid)
+{
+	if (!wait_full) {
+		return -1;
+	}
+	memcpy(item, &wait_item, sizeof(wait_item));
+	wait_full = 0;
+	return 0;
+}
+
+bool
+osdlp_tc_wait_queue_empty(uint16_t vcid)
+{
+	return !wait_full;
+}
+
+int
+osdlp_tc_wait_queue_clear(uint16_t vcid)
+{
+	wait_full = 0;
+	return 0;
+}
+
+int
+osdlp_timer_start(uint16_t vcid)
+{
+	event_push(now + prm.t1_ms * NS_PER_MS, EV_T1, ++t1_gen, NULL);
+	return 0;
+}
+
+int
+osdlp_timer_cancel(uint16_t vcid)
+{
+	t1_gen++;
+	return 0;
+}
+
+int
+osdlp_tc_get_rx_config(struct tc_transfer_frame **tc_tf, uint16_t vcid)
+{
+	if (vcid != SIM_VCID) {
+		return -1;
+	}
+	*tc_tf = &rx;
+	return 0;
+}
+
+bool
+osdlp_tc_rx_queue_full(uint16_t vcid)
+{
+	return false;
+}
+
+int
+osdlp_tc_rx_queue_enqueue(uint8_t *buffer, uint32_t length, uint16_t vcid)
+{
+	uint64_t submitted;
+	if (length >= SIM_SDU_HDR && stats.delivered < prm.sdus) {
+		memcpy(&submitted, buffer + 4, sizeof(submitted));
+		stats.latency[stats.delivered] = now - submitted;
+	}
+	stats.delivered++;
+	return 0;
+}
+
+int
+osdlp_tc_rx_queue_enqueue_now(uint8_t *buffer, uint32_t length, uint8_t vcid)
+{
+	return osdlp_tc_rx_queue_enqueue(buffer, length, vcid);
+}
+
+/* Simulation */
+
+static void
+setup(void)
+{
+	struct cop_config cop;
+	uint16_t sdu_len;
+	double ok = 1.0;
+
+	for (uint32_t i = 0; i < prm.frame_len * 8; i++) {
+		ok *= 1.0 - prm.ber;
+	}
+	frame_loss = 1.0 - ok;
+	delay = prm.delay_ms * NS_PER_MS;
+	tx_util = xrealloc(NULL, prm.frame_len);
+	rx_util = xrealloc(NULL, prm.frame_len);
+	sdu = xrealloc(NULL, prm.frame_len);
+	ring_storage = xrealloc(NULL, (SIM_RING_SLOTS + 1) * prm.frame_len);
+	stats.latency = xrealloc(NULL, prm.sdus * sizeof(uint64_t));
+
+	memset(&cop, 0, sizeof(cop));
+	osdlp_prepare_fop(&cop.fop, prm.window, FOP_STATE_ACTIVE, prm.t1_ms, 0,
+	                  prm.tx_lim);
+	osdlp_tc_init(&tx, SIM_SCID, prm.frame_len, prm.frame_len, 1, SIM_VCID,
+	              0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+	              tx_util, cop);
+	/* The FOP-1 and FARM-1 configurations share the same storage */
+	memset(&cop, 0, sizeof(cop));
+	osdlp_prepare_farm(&cop.farm, FARM_STATE_OPEN, 2 * prm.window);
+	osdlp_tc_init(&rx, SIM_SCID, prm.frame_len, prm.frame_len, 1, SIM_VCID,
+	              0, TC_CRC_PRESENT, TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA,
+	              rx_util, cop);
+	osdlp_sent_ring_init(&ring, ring_storage, SIM_RING_SLOTS,
+	                     prm.frame_len);
+	osdlp_sent_ring_attach(&tx, &ring);
+
+	/* Each SDU fills exactly one frame */
+	sdu_len = tx.mission.max_data_len;
+	memset(sdu, 0xa5, sdu_len);
+	tx.mission.max_sdu_len = sdu_len;
+	event_push(prm.clcw_ms * NS_PER_MS, EV_CLCW_EMIT, 0, NULL);
+}
+
+static void
+accept(void)
+{
+	uint8_t pending;
+	while (accept_pending) {
+		pending = accept_pending;
+		accept_pending = 0;
+		if (pending & ACCEPT_BC) {
+			osdlp_bc_accept(&tx);
+		}
+		if (pending & ACCEPT_BD) {
+			osdlp_bd_accept(&tx);
+		}
+		if (pending & ACCEPT_AD) {
+			osdlp_ad_accept(&tx);
+		}
+	}
+}
+
+/* Keeps the FOP-1 busy with new SDUs */
+static void
+source(void)
+{
+	uint16_t len = tx.mission.max_data_len;
+	uint32_t id;
+	int ret;
+	while (!wait_full && stats.submitted < prm.sdus
+	       && tx.cop_cfg.fop.state <= FOP_STATE_RT_WAIT) {
+		id = stats.submitted;
+		memcpy(sdu, &id, sizeof(id));
+		memcpy(sdu + 4, &now, sizeof(now));
+		osdlp_prepare_typea_data_frame(&tx, sdu, len, 0);
+		ret = osdlp_tc_transmit(&tx, sdu, len);
+		accept();
+		if (ret != TC_TX_OK && ret != -TC_TX_DELAY) {
+			return;
+		}
+		stats.submitted++;
+	}
+}
+
+/* After an alert the sender resynchronizes the receiver with Set V(R) */
+static void
+recover(void)
+{
+	if (tx.cop_cfg.fop.state != FOP_STATE_INIT) {
+		return;
+	}
+	stats.alerts++;
+	osdlp_initiate_with_setvr(&tx, tx.cop_cfg.fop.vs);
+}
+
+static void
+handle(const struct sim_event *e)
+{
+	uint8_t ocf[4];
+
+	switch (e->type) {
+		case EV_TX_DONE:
+			link_busy = 0;
+			if (frame_loss > 0 && rand_uniform() < frame_loss) {
+				stats.frames_lost++;
+				frame_release(e->arg);
+			} else {
+				event_push(now + delay, EV_FRAME_RX, e->arg,
+				           NULL);
+			}
+			link_start();
+			break;
+		case EV_FRAME_RX:
+			osdlp_tc_receive(frame_at(e->arg), prm.frame_len);
+			frame_release(e->arg);
+			break;
+		case EV_CLCW_EMIT:
+			osdlp_prepare_clcw(&rx, ocf);
+			if (rand_uniform() >= prm.clcw_loss) {
+				event_push(now + delay, EV_CLCW_RX, 0, ocf);
+			}
+			event_push(now + (uint64_t)(prm.clcw_ms * NS_PER_MS),
+			           EV_CLCW_EMIT, 0, NULL);
+			break;
+		case EV_CLCW_RX:
+			osdlp_handle_clcw(&tx, (uint8_t *)e->ocf);
+			break;
+		case EV_T1:
+			if (e->arg != t1_gen) {
+				break;
+			}
+			stats.t1_expiries++;
+			osdlp_handle_timer_expired(&tx);
+			break;
+	}
+	accept();
+	recover();
+	accept();
+	source();
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+static double
+percentile_ms(double q)
+{
+	uint64_t i;
+	if (stats.delivered == 0) {
+		return 0;
+	}
+	i = (uint64_t)(q * (stats.delivered - 1));
+	return stats.latency[i] / (double)NS_PER_MS;
+}
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+	        "Usage: %s [options]\n"
+	        "  -w N    FOP sliding window (%u)\n"
+	        "  -t MS   T1 in ms (%u)\n"
+	        "  -l N    transmission limit (%u)\n"
+	        "  -f N    frame length in octets (%u)\n"
+	        "  -b P    uplink bit error rate (%g)\n"
+	        "  -c P    CLCW loss probability (%g)\n"
+	        "  -d MS   one way delay in ms (%g)\n"
+	        "  -r BPS  uplink rate in bit/s (%g)\n"
+	        "  -p MS   CLCW period in ms (%g)\n"
+	        "  -n N    number of SDUs (%" PRIu64 ")\n"
+	        "  -s N    random seed (%" PRIu64 ")\n"
+	        "  -q      do not print the column names\n",
+	        name, prm.window, prm.t1_ms, prm.tx_lim, prm.frame_len, prm.ber,
+	        prm.clcw_loss, prm.delay_ms, prm.rate_bps, prm.clcw_ms,
+	        prm.sdus, prm.seed);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct sim_event e;
+	struct timespec t0, t1;
+	uint64_t events = 0;
+	double wall;
+	double secs;
+	double goodput = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "w:t:l:f:b:c:d:r:p:n:s:qh")) != -1) {
+		switch (opt) {
+			case 'w':
+				prm.window = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				prm.t1_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'l':
+				prm.tx_lim = strtoul(optarg, NULL, 0);
+				break;
+			case 'f':
+				prm.frame_len = strtoul(optarg, NULL, 0);
+				break;
+			case 'b':
+				prm.ber = strtod(optarg, NULL);
+				break;
+			case 'c':
+				prm.clcw_loss = strtod(optarg, NULL);
+				break;
+			case 'd':
+				prm.delay_ms = strtod(optarg, NULL);
+				break;
+			case 'r':
+				prm.rate_bps = strtod(optarg, NULL);
+				break;
+			case 'p':
+				prm.clcw_ms = strtod(optarg, NULL);
+				break;
+			case 'n':
+				prm.sdus = strtoull(optarg, NULL, 0);
+				break;
+			case 's':
+				prm.seed = strtoull(optarg, NULL, 0);
+				break;
+			case 'q':
+				prm.quiet = 1;
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (prm.window < 1 || prm.window > 127 || prm.tx_lim < 1
+	    || prm.tx_lim > 255 || prm.frame_len < 16
+	    || prm.frame_len > 1024 || prm.rate_bps <= 0
+	    || prm.clcw_ms <= 0 || prm.sdus == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	rng = prm.seed ? prm.seed : 1;
+
+	setup();
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	source();
+	while (heap_len > 0) {
+		e = event_pop();
+		now = e.t;
+		handle(&e);
+		events++;
+		if (stats.submitted == prm.sdus && wait_full == 0
+		    && osdlp_sent_ring_empty(&ring)) {
+			break;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	wall = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+	qsort(stats.latency, stats.delivered, sizeof(uint64_t), cmp_u64);
+	secs = now / (double)NS_PER_SEC;
+	if (secs > 0) {
+		goodput = stats.delivered * tx.mission.max_data_len * 8 / secs;
+	}
+	if (!prm.quiet) {
+		printf("window,t1_ms,tx_lim,frame_len,ber,clcw_loss,delay_ms,"
+		       "rate_bps,clcw_ms,sim_s,goodput_bps,delivered,dropped,"
+		       "frames_tx,retx,lost,t1_expiries,alerts,lat_p50_ms,"
+		       "lat_p90_ms,lat_p99_ms,lat_max_ms\n");
+	}
+	printf("%u,%u,%u,%u,%g,%g,%g,%g,%g,%.3f,%.1f,%" PRIu64 ",%" PRIu64
+	       ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64
+	       ",%.1f,%.1f,%.1f,%.1f\n",
+	       prm.window, prm.t1_ms, prm.tx_lim, prm.frame_len, prm.ber,
+	       prm.clcw_loss, prm.delay_ms, prm.rate_bps, prm.clcw_ms, secs,
+	       goodput, stats.delivered, stats.submitted - stats.delivered,
+	       stats.frames_tx, stats.retx, stats.frames_lost,
+	       stats.t1_expiries, stats.alerts, percentile_ms(0.5),
+	       percentile_ms(0.9), percentile_ms(0.99), percentile_ms(1.0));
+	fprintf(stderr, "%" PRIu64 " events, %.0f frames/s of wall clock\n",
+	        events, wall > 0 ? stats.frames_tx / wall : 0);
+	return 0;
+}
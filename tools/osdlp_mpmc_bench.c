@@ -0,0 +1,190 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the throughput of the shared uplink queue with a growing number
+ * of producer threads, each standing for the FOP-1 of a virtual channel,
+ * and a single consumer thread standing for the radio. Each producer runs
+ * with its own VCID. One line is printed per number of producers, doubling
+ * from 1 up to the given maximum, e.g.
+ *
+ *   osdlp_mpmc_bench -p 16 -n 200000
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "osdlp.h"
+
+#define BENCH_MAX_PRODUCERS     MPMC_QUEUE_MAX_VCS
+
+static struct {
+	uint32_t    producers;      /* Maximum number of producers*/
+	uint32_t    frames;         /* Frames per producer*/
+	uint32_t    cells;
+	uint32_t    frame_len;
+	int         quiet;
+} prm = {
+	.producers = 16,
+	.frames = 100000,
+	.cells = 256,
+	.frame_len = 64,
+	.quiet = 0
+};
+
+static struct osdlp_mpmc_queue q;
+static volatile int start;
+
+static void *
+producer(void *arg)
+{
+	uint16_t vcid = (uintptr_t)arg;
+	uint8_t frame[1024];
+	memset(frame, vcid, prm.frame_len);
+	while (!start) {
+		sched_yield();
+	}
+	for (uint32_t i = 0; i < prm.frames; i++) {
+		while (osdlp_mpmc_queue_enqueue(&q, frame, prm.frame_len,
+		                                vcid) < 0) {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void *
+consumer(void *arg)
+{
+	uint64_t total = *(uint64_t *)arg;
+	uint8_t frame[1024];
+	uint32_t len;
+	while (!start) {
+		sched_yield();
+	}
+	while (total > 0) {
+		if (osdlp_mpmc_queue_dequeue(&q, frame, &len, NULL) < 0) {
+			sched_yield();
+			continue;
+		}
+		total--;
+	}
+	return NULL;
+}
+
+static double
+run(uint32_t producers, uint8_t *storage)
+{
+	pthread_t th[BENCH_MAX_PRODUCERS + 1];
+	struct timespec t0, t1;
+	uint64_t total = (uint64_t)producers * prm.frames;
+
+	osdlp_mpmc_queue_init(&q, storage, prm.cells, prm.frame_len, 0);
+	start = 0;
+	pthread_create(&th[producers], NULL, consumer, &total);
+	for (uint32_t i = 0; i < producers; i++) {
+		pthread_create(&th[i], NULL, producer, (void *)(uintptr_t)i);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	start = 1;
+	for (uint32_t i = 0; i <= producers; i++) {
+		pthread_join(th[i], NULL);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+	        "Usage: %s [options]\n"
+	        "  -p N    maximum number of producers (%u)\n"
+	        "  -n N    frames per producer (%u)\n"
+	        "  -c N    queue cells, a power of 2 (%u)\n"
+	        "  -f N    frame length in octets (%u)\n"
+	        "  -q      do not print the column names\n",
+	        name, prm.producers, prm.frames, prm.cells, prm.frame_len);
+}
+
+int
+main(int argc, char **argv)
+{
+	uint8_t *storage;
+	double secs;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "p:n:c:f:qh")) != -1) {
+		switch (opt) {
+			case 'p':
+				prm.producers = strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				prm.frames = strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				prm.cells = strtoul(optarg, NULL, 0);
+				break;
+			case 'f':
+				prm.frame_len = strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				prm.quiet = 1;
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (prm.producers < 1 || prm.producers > BENCH_MAX_PRODUCERS
+	    || prm.frames == 0 || prm.cells < 2
+	    || (prm.cells & (prm.cells - 1)) || prm.frame_len < 1
+	    || prm.frame_len > 1024) {
+		usage(argv[0]);
+		return 1;
+	}
+	storage = aligned_alloc(OSDLP_CACHE_LINE,
+	                        prm.cells * MPMC_QUEUE_STRIDE(prm.frame_len));
+	if (!storage) {
+		perror("aligned_alloc");
+		return 1;
+	}
+
+	if (!prm.quiet) {
+		printf("producers,frames,seconds,frames_per_s\n");
+	}
+	/* Doubling, the last run uses the maximum number of producers*/
+	for (uint32_t p = 1;; p *= 2) {
+		if (p > prm.producers) {
+			p = prm.producers;
+		}
+		secs = run(p, storage);
+		printf("%u,%u,%.3f,%.0f\n", p, p * prm.frames, secs,
+		       p * prm.frames / secs);
+		if (p == prm.producers) {
+			break;
+		}
+	}
+	free(storage);
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Prints the events of a trace in text form. The input is an array of
+ * struct osdlp_trace_event, as copied by osdlp_trace_snapshot(), read from
+ * the given file or the standard input.
+ *
+ * Usage: osdlp_trace_dump [file]
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "osdlp_trace.h"
+
+static const char *fop_states[] = {
+	"ACTIVE", "RT_NO_WAIT", "RT_WAIT", "INIT_NO_BC", "INIT_BC", "INIT"
+};
+
+static const char *farm_states[] = {
+	"OPEN", "WAIT", "LOCKOUT"
+};
+
+static const char *fop_events[] = {
+	"E1", "E2", "E3", "E4", "E5", "E6", "E7", "E8", "E9", "E10", "E11",
+	"E12", "E13", "E14", "E101", "E102", "E103", "E16", "E104", "E17", "E18"
+};
+
+static const char *
+name(const char **names, size_t n, uint8_t i)
+{
+	return i < n ? names[i] : "?";
+}
+
+#define NAME(names, i)  name(names, sizeof(names) / sizeof(names[0]), i)
+
+static void
+dump_event(const struct osdlp_trace_event *e, uint64_t t0)
+{
+	printf("%12" PRIu64 " vc %2u ", e->ts - t0, e->vcid);
+	switch (e->id) {
+		case OSDLP_TRACE_FOP:
+			printf("FOP   %-5s %s -> %s V(S) %u N(R) %u sent %u\n",
+			       NAME(fop_events, e->arg),
+			       NAME(fop_states, e->before),
+			       NAME(fop_states, e->after),
+			       e->vs, e->nr, e->depth);
+			break;
+		case OSDLP_TRACE_FARM:
+			printf("FARM  res %u %s -> %s V(R) %u N(S) %u\n",
+			       e->arg,
+			       NAME(farm_states, e->before),
+			       NAME(farm_states, e->after),
+			       e->vs, e->nr);
+			break;
+		case OSDLP_TRACE_TC_TX:
+			printf("TC TX notif %u %s -> %s V(S) %u NN(R) %u\n",
+			       e->arg,
+			       NAME(fop_states, e->before),
+			       NAME(fop_states, e->after),
+			       e->vs, e->nr);
+			break;
+		case OSDLP_TRACE_TC_RX:
+			printf("TC RX error %u\n", e->arg);
+			break;
+		default:
+			printf("unknown event %u\n", e->id);
+			break;
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	struct osdlp_trace_event e;
+	FILE *in = stdin;
+	uint64_t t0 = 0;
+	int first = 1;
+
+	if (argc > 1) {
+		in = fopen(argv[1], "rb");
+		if (!in) {
+			perror(argv[1]);
+			return 1;
+		}
+	}
+	while (fread(&e, sizeof(e), 1, in) == 1) {
+		if (first) {
+			t0 = e.ts;
+			first = 0;
+		}
+		dump_event(&e, t0);
+	}
+	if (in != stdin) {
+		fclose(in);
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ *  Open Space Data Link Protocol
+ *
+ *  Copyright (C) 2020 Libre Space Foundation (https://libre.space)
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures the cost of packing TC frames round-robin over a growing number
+ * of active virtual channel contexts. Once the contexts no longer fit in
+ * the caches, every frame pays for the cache lines of its context that it
+ * touches, so the time per frame follows the layout of
+ * struct tc_transfer_frame. The FECF is left out, so that its
+ * computation does not hide the memory accesses. One line is printed per
+ * number of contexts, doubling from 1 up to the given maximum. Run it
+ * under perf stat -e cache-misses to count the misses, e.g.
+ *
+ *   perf stat -e cache-misses osdlp_vc_bench -v 65536 -n 4000000
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "osdlp.h"
+
+#define BENCH_FRAME_LEN     256
+#define BENCH_SDU_LEN       16
+
+static struct {
+	uint32_t    vcs;            /* Maximum number of contexts*/
+	uint32_t    frames;         /* Frames per run*/
+	int         quiet;
+} prm = {
+	.vcs = 16384,
+	.frames = 2000000,
+	.quiet = 0
+};
+
+static uint8_t util[BENCH_FRAME_LEN];
+
+static void
+init_contexts(struct tc_transfer_frame *tf, uint32_t n)
+{
+	struct cop_config cop;
+	for (uint32_t i = 0; i < n; i++) {
+		memset(&cop, 0, sizeof(struct cop_config));
+		osdlp_prepare_fop(&cop.fop, 10, FOP_STATE_ACTIVE, 1, 0, 10);
+		osdlp_tc_init(&tf[i], i >> 6, BENCH_FRAME_LEN, BENCH_FRAME_LEN,
+		              10, i & 0x3f, 0, TC_CRC_NOTPRESENT,
+		              TC_SEG_HDR_PRESENT, TYPE_A, TC_DATA, util, cop);
+		tf[i].frame_data.seg_hdr.seq_flag = TC_UNSEG;
+	}
+}
+
+static double
+run(struct tc_transfer_frame *tf, uint32_t vcs)
+{
+	struct timespec t0, t1;
+	uint8_t frame[BENCH_FRAME_LEN];
+	uint8_t data[BENCH_SDU_LEN] = {0};
+	uint32_t sum = 0;
+	uint32_t vc = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (uint32_t i = 0; i < prm.frames; i++) {
+		tf[vc].cop_cfg.fop.vs++;
+		osdlp_tc_pack(&tf[vc], frame, data, BENCH_SDU_LEN);
+		sum += frame[4];
+		if (++vc == vcs) {
+			vc = 0;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	/* Keeps the packing from being optimized out*/
+	if (sum == 1) {
+		fprintf(stderr, "\n");
+	}
+	return (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+}
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+	        "Usage: %s [options]\n"
+	        "  -v N    maximum number of contexts (%u)\n"
+	        "  -n N    frames per run (%u)\n"
+	        "  -q      do not print the column names\n",
+	        name, prm.vcs, prm.frames);
+}
+
+int
+main(int argc, char **argv)
+{
+	struct tc_transfer_frame *tf;
+	double secs;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "v:n:q")) != -1) {
+		switch (opt) {
+			case 'v':
+				prm.vcs = strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				prm.frames = strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				prm.quiet = 1;
+				break;
+			default:
+				usage(argv[0]);
+				return 1;
+		}
+	}
+	if (prm.vcs < 1 || prm.frames == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	tf = aligned_alloc(OSDLP_CACHE_LINE,
+	                   ((prm.vcs * sizeof(struct tc_transfer_frame))
+	                    + OSDLP_CACHE_LINE - 1) & ~(OSDLP_CACHE_LINE - 1));
+	if (!tf) {
+		perror("aligned_alloc");
+		return 1;
+	}
+	init_contexts(tf, prm.vcs);
+
+	if (!prm.quiet) {
+		printf("vcs,frames,seconds,ns_per_frame\n");
+	}
+	/* Doubling, the last run uses the maximum number of contexts*/
+	for (uint32_t v = 1;; v *= 2) {
+		if (v > prm.vcs) {
+			v = prm.vcs;
+		}
+		secs = run(tf, v);
+		printf("%u,%u,%.3f,%.1f\n", v, prm.frames, secs,
+		       secs * 1e9 / prm.frames);
+		if (v == prm.vcs) {
+			break;
+		}
+	}
+	free(tf);
+	return 0;
+}